@@ -54,3 +54,36 @@ function(yarp_add_unit_test)
 
     catch_discover_tests(${ARG_NAME})
 endfunction(yarp_add_unit_test)
+
+# Benchmarks are built like unit tests, but are not registered with CTest
+# because they take too long to run on every test run
+function(yarp_add_benchmark)
+    cmake_parse_arguments(ARG "" "NAME" "SOURCES;COPY_FILES;LIBRARIES" ${ARGN})
+
+    if (NOT ARG_NAME)
+        message(FATAL_ERROR "Could not find NAME for benchmark")
+    endif ()
+
+    if (NOT ARG_SOURCES)
+        message(FATAL_ERROR "Could not find SOURCES for benchmark")
+    endif ()
+
+    add_executable(${ARG_NAME} ${ARG_SOURCES})
+
+    target_include_directories(${ARG_NAME} PRIVATE
+            ${CMAKE_SOURCE_DIR}/src
+            ${CMAKE_BINARY_DIR}/src
+    )
+
+    target_link_libraries(${ARG_NAME} PRIVATE project_settings Catch2::Catch2WithMain ${ARG_LIBRARIES})
+
+    if (ARG_COPY_FILES)
+        foreach (file ${ARG_COPY_FILES})
+            add_custom_command(TARGET ${ARG_NAME} POST_BUILD
+                    COMMAND ${CMAKE_COMMAND} -E copy
+                    ${CMAKE_CURRENT_SOURCE_DIR}/${file}
+                    ${CMAKE_CURRENT_BINARY_DIR}/${file}
+            )
+        endforeach ()
+    endif ()
+endfunction(yarp_add_benchmark)
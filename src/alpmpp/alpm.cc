@@ -9,8 +9,10 @@
 
 #include <algorithm>
 #include <format>
+#include <ranges>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 namespace alpmpp {
 
@@ -35,9 +37,8 @@ alpm_db_t *Alpm::GetLocalDb() const {
   return db;
 }
 
-std::vector<AlpmPackage> Alpm::DbGetPkgCache(alpm_db_t *db) {
-  return util::AlpmListToVector<alpm_pkg_t *, AlpmPackage>(
-      alpm_db_get_pkgcache(db));
+AlpmListView<AlpmPackage, alpm_pkg_t *> Alpm::DbGetPkgCache(alpm_db_t *db) {
+  return AlpmListView<AlpmPackage, alpm_pkg_t *>{alpm_db_get_pkgcache(db)};
 }
 
 std::optional<AlpmPackage> Alpm::DbGetPkg(alpm_db_t *db,
@@ -48,27 +49,26 @@ std::optional<AlpmPackage> Alpm::DbGetPkg(alpm_db_t *db,
 
 std::vector<AlpmPackage> Alpm::DbSearch(
     alpm_db_t *db, const std::vector<std::string> &needles) {
+  alpm_list_t *needle_list = util::StringVectorToAlpmList(needles);
   alpm_list_t *search_list = nullptr;
 
-  alpm_db_search(db, util::StringVectorToAlpmList(needles), &search_list);
+  alpm_db_search(db, needle_list, &search_list);
 
-  return util::AlpmListToVector<alpm_pkg_t *, AlpmPackage>(search_list);
+  // Both lists are ours, but not the packages and strings they point to
+  std::vector<AlpmPackage> result =
+      AlpmListView<AlpmPackage, alpm_pkg_t *>{search_list} |
+      std::ranges::to<std::vector>();
+  alpm_list_free(search_list);
+  alpm_list_free(needle_list);
+  return result;
 }
 
 std::string_view Alpm::OptionGetRoot() const {
   return alpm_option_get_root(handle_);
 }
 
-std::vector<alpm_db_t *> Alpm::GetSyncDbs() const {
-  const alpm_list_t *list = alpm_get_syncdbs(handle_);
-  std::vector<alpm_db_t *> result;
-  result.reserve(alpm_list_count(list));
-
-  for (const alpm_list_t *elem = list; elem != nullptr;
-       elem = alpm_list_next(elem)) {
-    result.emplace_back(static_cast<alpm_db_t *>(elem->data));
-  }
-  return result;
+AlpmListView<alpm_db_t *> Alpm::GetSyncDbs() const {
+  return AlpmListView<alpm_db_t *>{alpm_get_syncdbs(handle_)};
 }
 
 alpm_db_t *Alpm::RegisterSyncDb(std::string_view name, int siglevel) const {
@@ -100,7 +100,7 @@ bool Alpm::PkgShouldIgnore(const AlpmPackage &pkg) const {
   return alpm_pkg_should_ignore(handle_, pkg.GetHandle());
 }
 
-bool Alpm::FileListContains(const std::vector<AlpmFile> &files,
+bool Alpm::FileListContains(const AlpmFileListView &files,
                             const std::string_view path) {
   return std::ranges::any_of(
       files, [&path](const AlpmFile &file) { return file.name() == path; });
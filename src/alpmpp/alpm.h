@@ -5,11 +5,14 @@
 
 #include <alpm.h>
 
+#include <alpmpp/list.h>
 #include <alpmpp/package.h>
 
 #include <filesystem>
 #include <optional>
-
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace alpmpp {
 
@@ -20,7 +23,8 @@ class Alpm {
 
   [[nodiscard]] alpm_db_t *GetLocalDb() const;
 
-  static std::vector<AlpmPackage> DbGetPkgCache(alpm_db_t *db);
+  // A view of the packages of db, valid until the database changes
+  static AlpmListView<AlpmPackage, alpm_pkg_t *> DbGetPkgCache(alpm_db_t *db);
 
   static std::optional<AlpmPackage> DbGetPkg(alpm_db_t *db,
                                              std::string_view name);
@@ -34,7 +38,7 @@ class Alpm {
 
   [[nodiscard]] std::string_view OptionGetRoot() const;
 
-  [[nodiscard]] std::vector<alpm_db_t *> GetSyncDbs() const;
+  [[nodiscard]] AlpmListView<alpm_db_t *> GetSyncDbs() const;
 
   [[nodiscard]] alpm_db_t *RegisterSyncDb(std::string_view name,
                                           int siglevel) const;
@@ -46,7 +50,7 @@ class Alpm {
 
   [[nodiscard]] bool PkgShouldIgnore(const AlpmPackage &pkg) const;
 
-  [[nodiscard]] static bool FileListContains(const std::vector<AlpmFile> &files,
+  [[nodiscard]] static bool FileListContains(const AlpmFileListView &files,
                                              std::string_view path);
 
  private:
@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef ALPMPP_LIST_H_
+#define ALPMPP_LIST_H_
+
+#include <alpm.h>
+#include <alpm_list.h>
+
+#include <alpmpp/file.h>
+
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <span>
+
+namespace alpmpp {
+
+// A view of the elements of an alpm_list_t, which libalpm stores as void
+// pointers to Data. Each element is converted to T when it is read, so
+// walking a list allocates nothing. The view doesn't own the list, which
+// has to outlive it.
+template <typename T, typename Data = T>
+class AlpmListView : public std::ranges::view_interface<AlpmListView<T, Data>> {
+ public:
+  class Iterator {
+   public:
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr Iterator() = default;
+    constexpr explicit Iterator(const alpm_list_t *elem) : elem_(elem) {}
+
+    [[nodiscard]] T operator*() const {
+      return T(static_cast<Data>(elem_->data));
+    }
+
+    Iterator &operator++() {
+      elem_ = elem_->next;
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    [[nodiscard]] constexpr bool operator==(const Iterator &) const = default;
+
+    [[nodiscard]] constexpr bool operator==(std::default_sentinel_t) const {
+      return elem_ == nullptr;
+    }
+
+   private:
+    const alpm_list_t *elem_ = nullptr;
+  };
+
+  constexpr AlpmListView() = default;
+  constexpr explicit AlpmListView(const alpm_list_t *list) : list_(list) {}
+
+  [[nodiscard]] constexpr Iterator begin() const { return Iterator{list_}; }
+  [[nodiscard]] constexpr std::default_sentinel_t end() const { return {}; }
+
+  // Unlike size(), which a list can only provide by walking it
+  [[nodiscard]] constexpr bool empty() const noexcept {
+    return list_ == nullptr;
+  }
+
+ private:
+  const alpm_list_t *list_ = nullptr;
+};
+
+namespace detail {
+
+struct ToAlpmFile {
+  [[nodiscard]] constexpr AlpmFile operator()(alpm_file_t &file) const {
+    return AlpmFile{&file};
+  }
+};
+
+}  // namespace detail
+
+// A view of the files of an alpm_filelist_t, sorted by name like libalpm
+// keeps them
+using AlpmFileListView =
+    std::ranges::transform_view<std::span<alpm_file_t>, detail::ToAlpmFile>;
+
+[[nodiscard]] inline AlpmFileListView MakeFileListView(
+    const alpm_filelist_t *file_list) {
+  if (file_list == nullptr) return {};
+  return AlpmFileListView{std::span{file_list->files, file_list->count},
+                          detail::ToAlpmFile{}};
+}
+
+}  // namespace alpmpp
+
+#endif  // ALPMPP_LIST_H_
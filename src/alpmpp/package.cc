@@ -21,18 +21,18 @@ namespace {
 
 template <typename OutputIter>
 void PrintDependsList(OutputIter output_iter, const std::string_view prefix,
-                      std::vector<alpmpp::AlpmDepend> depends) {
+                      const alpmpp::AlpmDependList depends) {
   auto names =
-      depends | std::views::transform([](auto &dep) { return dep.name(); });
+      depends | std::views::transform([](auto dep) { return dep.name(); });
   alpmpp::util::PrintJoinedLine(output_iter, prefix, names);
 }
 
 template <typename OutputIter>
 void PrintOptDependsList(OutputIter output_iter,
-                         std::vector<alpmpp::AlpmDepend> opt_depends) {
+                         const alpmpp::AlpmDependList opt_depends) {
   constexpr std::string_view kPrefix{"Optional Deps   : "};
 
-  auto dep_strings = opt_depends | std::views::transform([](auto &dep) {
+  auto dep_strings = opt_depends | std::views::transform([](auto dep) {
                        return dep.ComputeString();
                      });
 
@@ -164,7 +164,6 @@ std::string AlpmPackage::GetInfo() const {
                    "Provides        : ", provides());
   PrintDependsList(std::back_inserter(result), "Depends On      : ", depends());
   PrintOptDependsList(std::back_inserter(result), opt_depends());
-  // alpm_pkg_compute_* don't free the list, so we set free_list to true
   util::PrintJoinedLine(std::back_inserter(result),
                         "Required By     : ", ComputeRequiredBy());
   util::PrintJoinedLine(std::back_inserter(result),
@@ -212,58 +211,48 @@ std::string_view AlpmPackage::packager() const noexcept {
   return alpm_pkg_get_packager(pkg_);
 }
 
-std::vector<AlpmDepend> AlpmPackage::opt_depends() const noexcept {
-  return util::AlpmListToVector<alpm_depend_t *, AlpmDepend>(
-      alpm_pkg_get_optdepends(pkg_));
+AlpmDependList AlpmPackage::opt_depends() const noexcept {
+  return AlpmDependList{alpm_pkg_get_optdepends(pkg_)};
 }
 
-std::vector<AlpmDepend> AlpmPackage::depends() const noexcept {
-  return util::AlpmListToVector<alpm_depend_t *, AlpmDepend>(
-      alpm_pkg_get_depends(pkg_));
+AlpmDependList AlpmPackage::depends() const noexcept {
+  return AlpmDependList{alpm_pkg_get_depends(pkg_)};
 }
 
-std::vector<AlpmDepend> AlpmPackage::provides() const noexcept {
-  return util::AlpmListToVector<alpm_depend_t *, AlpmDepend>(
-      alpm_pkg_get_provides(pkg_));
+AlpmDependList AlpmPackage::provides() const noexcept {
+  return AlpmDependList{alpm_pkg_get_provides(pkg_)};
 }
 
-std::vector<std::string_view> AlpmPackage::groups() const noexcept {
-  return util::AlpmListToVector<const char *, std::string_view>(
-      alpm_pkg_get_groups(pkg_));
+AlpmStringList AlpmPackage::groups() const noexcept {
+  return AlpmStringList{alpm_pkg_get_groups(pkg_)};
 }
 
-std::vector<std::string_view> AlpmPackage::licenses() const noexcept {
-  return util::AlpmListToVector<const char *, std::string_view>(
-      alpm_pkg_get_licenses(pkg_));
+AlpmStringList AlpmPackage::licenses() const noexcept {
+  return AlpmStringList{alpm_pkg_get_licenses(pkg_)};
 }
 
-std::vector<AlpmDepend> AlpmPackage::conflicts() const noexcept {
-  return util::AlpmListToVector<alpm_depend_t *, AlpmDepend>(
-      alpm_pkg_get_conflicts(pkg_));
+AlpmDependList AlpmPackage::conflicts() const noexcept {
+  return AlpmDependList{alpm_pkg_get_conflicts(pkg_)};
 }
 
-std::vector<AlpmDepend> AlpmPackage::replaces() const noexcept {
-  return util::AlpmListToVector<alpm_depend_t *, AlpmDepend>(
-      alpm_pkg_get_replaces(pkg_));
+AlpmDependList AlpmPackage::replaces() const noexcept {
+  return AlpmDependList{alpm_pkg_get_replaces(pkg_)};
 }
 
-std::vector<AlpmFile> AlpmPackage::files() const noexcept {
-  const alpm_filelist_t *file_list = alpm_pkg_get_files(pkg_);
-  std::span files_span{file_list->files, file_list->count};
+AlpmFileListView AlpmPackage::files() const noexcept {
+  return MakeFileListView(alpm_pkg_get_files(pkg_));
+}
 
-  return files_span |
-         std::views::transform([](auto &file) { return AlpmFile{&file}; }) |
-         std::ranges::to<std::vector>();
+AlpmListView<alpm_backup_t *> AlpmPackage::backup() const noexcept {
+  return AlpmListView<alpm_backup_t *>{alpm_pkg_get_backup(pkg_)};
 }
 
 std::vector<std::string> AlpmPackage::ComputeOptionalFor() const noexcept {
-  return util::AlpmListToVector<const char *, std::string>(
-      alpm_pkg_compute_optionalfor(pkg_));
+  return util::TakeAlpmStringList(alpm_pkg_compute_optionalfor(pkg_));
 }
 
 std::vector<std::string> AlpmPackage::ComputeRequiredBy() const noexcept {
-  return util::AlpmListToVector<const char *, std::string>(
-      alpm_pkg_compute_requiredby(pkg_));
+  return util::TakeAlpmStringList(alpm_pkg_compute_requiredby(pkg_));
 }
 
 alpm_time_t AlpmPackage::build_date() const noexcept {
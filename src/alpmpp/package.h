@@ -7,13 +7,18 @@
 
 #include <alpmpp/depend.h>
 #include <alpmpp/file.h>
+#include <alpmpp/list.h>
 #include <alpmpp/types.h>
 
+#include <string>
 #include <string_view>
 #include <vector>
 
 namespace alpmpp {
 
+using AlpmDependList = AlpmListView<AlpmDepend, alpm_depend_t *>;
+using AlpmStringList = AlpmListView<std::string_view, const char *>;
+
 class AlpmPackage {
  public:
   constexpr explicit AlpmPackage(alpm_pkg_t *pkg, bool owned = false)
@@ -50,14 +55,16 @@ class AlpmPackage {
   [[nodiscard]] std::string_view url() const noexcept;
   [[nodiscard]] std::string_view packager() const noexcept;
 
-  [[nodiscard]] std::vector<AlpmDepend> opt_depends() const noexcept;
-  [[nodiscard]] std::vector<AlpmDepend> depends() const noexcept;
-  [[nodiscard]] std::vector<AlpmDepend> provides() const noexcept;
-  [[nodiscard]] std::vector<std::string_view> groups() const noexcept;
-  [[nodiscard]] std::vector<std::string_view> licenses() const noexcept;
-  [[nodiscard]] std::vector<AlpmDepend> conflicts() const noexcept;
-  [[nodiscard]] std::vector<AlpmDepend> replaces() const noexcept;
-  [[nodiscard]] std::vector<AlpmFile> files() const noexcept;
+  // The lists are views into the package, valid as long as it is
+  [[nodiscard]] AlpmDependList opt_depends() const noexcept;
+  [[nodiscard]] AlpmDependList depends() const noexcept;
+  [[nodiscard]] AlpmDependList provides() const noexcept;
+  [[nodiscard]] AlpmStringList groups() const noexcept;
+  [[nodiscard]] AlpmStringList licenses() const noexcept;
+  [[nodiscard]] AlpmDependList conflicts() const noexcept;
+  [[nodiscard]] AlpmDependList replaces() const noexcept;
+  [[nodiscard]] AlpmFileListView files() const noexcept;
+  [[nodiscard]] AlpmListView<alpm_backup_t *> backup() const noexcept;
   [[nodiscard]] alpm_time_t build_date() const noexcept;
   [[nodiscard]] alpm_time_t install_date() const noexcept;
   [[nodiscard]] off_t i_size() const noexcept;
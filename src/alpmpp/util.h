@@ -5,7 +5,11 @@
 
 #include <alpm_list.h>
 
+#include <alpmpp/list.h>
+
+#include <cstdlib>
 #include <sstream>
+#include <string>
 #include <vector>
 
 namespace alpmpp {
@@ -39,16 +43,14 @@ constexpr void PrintJoinedLine(OutputIter output_iter, std::string_view prefix,
   std::format_to(output_iter, "{}", '\n');
 }
 
-template <typename Input, typename Output>
-constexpr std::vector<Output> AlpmListToVector(const alpm_list_t *list) {
-  std::vector<Output> result;
-  result.reserve(alpm_list_count(list));
-
-  for (const alpm_list_t *elem = list; elem != nullptr;
-       elem = alpm_list_next(elem)) {
-    result.emplace_back(static_cast<Input>(elem->data));
-  }
-
+// Copies the strings of a list that libalpm allocated for the caller, such
+// as the result of alpm_pkg_compute_requiredby, and frees it
+inline std::vector<std::string> TakeAlpmStringList(alpm_list_t *list) {
+  std::vector<std::string> result =
+      AlpmListView<std::string, const char *>{list} |
+      std::ranges::to<std::vector>();
+  alpm_list_free_inner(list, std::free);
+  alpm_list_free(list);
   return result;
 }
 
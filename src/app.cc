@@ -6,7 +6,9 @@
 #include <alpmpp/util.h>
 #include <sys/types.h>
 
+#include <chrono>
 #include <cstdlib>
+#include <memory>
 #include <print>
 #include <span>
 #include <variant>
@@ -17,6 +19,7 @@
 #include "operation.h"
 #include "query_handler.h"
 #include "sync_handler.h"
+#include "utils.h"
 #include "version_handler.h"
 
 namespace yarp {
@@ -41,6 +44,30 @@ App::App(std::span<char *> args) {
           std::format("Could not register db, name : {}", repo.name));
     }
   }
+
+  // Retries transient failures and keeps within the AUR's rate limit
+  aur_client_.set_scheduler(std::make_shared<aurpp::RequestScheduler>());
+
+  if (config_.verbose() || config_.stats_format() != StatsFormat::kNone) {
+    aur_client_.set_transfer_observer([this](const aurpp::TransferInfo &info) {
+      transfer_stats_.Record(info);
+      if (!config_.verbose()) {
+        return;
+      }
+      std::println(
+          stderr, "AUR Request: {} {} {:.1f} ms {} bytes{}", info.url,
+          info.http_version,
+          std::chrono::duration<double, std::milli>{info.total_time}.count(),
+          info.downloaded_bytes,
+          info.reused_connection ? " (reused connection)" : "");
+    });
+  }
+
+  // Without a cache directory every AUR request simply goes to the network
+  if (const auto cache_dir = utils::UserCacheDir(); cache_dir.has_value()) {
+    aur_client_.EnableCache(cache_dir.value() / "aur");
+    aur_client_.EnableConnectionState(cache_dir.value() / "connection");
+  }
 }
 
 int App::Run() {
@@ -72,7 +99,20 @@ int App::Run() {
       return EXIT_SUCCESS;
   }
 
-  return std::visit([](auto &h) { return h.Execute(); }, handler);
+  const int result = std::visit([](auto &h) { return h.Execute(); }, handler);
+
+  // Printed to stderr, so the statistics don't mix with the results
+  switch (config_.stats_format()) {
+    case StatsFormat::kText:
+      std::print(stderr, "{}", transfer_stats_.FormatText());
+      break;
+    case StatsFormat::kJson:
+      std::println(stderr, "{}", transfer_stats_.FormatJson());
+      break;
+    default:
+      break;
+  }
+  return result;
 }
 
 void App::PrintVerbose() const {
@@ -5,6 +5,7 @@
 
 #include <alpmpp/alpm.h>
 #include <aurpp/client.h>
+#include <aurpp/transfer_stats.h>
 
 #include <memory>
 #include <string>
@@ -24,6 +25,8 @@ class App {
  private:
   void PrintVerbose() const;
 
+  // Declared before the client, whose transfer observer records into it
+  aurpp::TransferStats transfer_stats_;
   aurpp::Client aur_client_;
   // use unique_ptr for lazy initialization
   std::unique_ptr<alpmpp::Alpm> alpm_;
@@ -5,12 +5,17 @@
 #include <getopt.h>
 
 #include <array>
+#include <charconv>
+#include <format>
+#include <ranges>
+#include <stdexcept>
+#include <string_view>
 
 namespace {
 
 constexpr std::string_view kOptString = "acdehkmnopstuQSVgilv";
 
-constexpr std::array<option, 24> kOpts = {{
+constexpr std::array<option, 29> kOpts = {{
     {"help", no_argument, nullptr, 'h'},
     {"query", optional_argument, nullptr, 'Q'},
     {"sync", optional_argument, nullptr, 'S'},
@@ -34,9 +39,62 @@ constexpr std::array<option, 24> kOpts = {{
     {"dbpath", required_argument, nullptr, 'b'},
     {"verbose", no_argument, nullptr, 'v'},
     {"config", required_argument, nullptr, 0},
+    {"aur-mirror", required_argument, nullptr, 0},
+    {"searchby", required_argument, nullptr, 0},
+    {"sortby", required_argument, nullptr, 0},
+    {"limit", required_argument, nullptr, 0},
+    {"stats", optional_argument, nullptr, 0},
     {nullptr, 0, nullptr, 0},
 }};
 
+// Parses a comma separated list of fields like "provides,depends"
+std::vector<aurpp::SearchRequest::SearchBy> ParseSearchByList(
+    const std::string_view list) {
+  std::vector<aurpp::SearchRequest::SearchBy> fields;
+  for (const auto field : std::views::split(list, ',')) {
+    const std::string_view name{field.begin(), field.end()};
+    const aurpp::SearchRequest::SearchBy search_by =
+        aurpp::SearchRequest::ParseSearchBy(name);
+    if (search_by == aurpp::SearchRequest::SearchBy::kInvalid) {
+      throw std::runtime_error(
+          std::format("invalid field for --searchby: '{}'", name));
+    }
+    fields.push_back(search_by);
+  }
+  return fields;
+}
+
+aurpp::SortBy ParseSortByOption(const std::string_view name) {
+  const aurpp::SortBy sort_by = aurpp::ParseSortBy(name);
+  if (sort_by == aurpp::SortBy::kInvalid) {
+    throw std::runtime_error(
+        std::format("invalid field for --sortby: '{}'", name));
+  }
+  return sort_by;
+}
+
+std::size_t ParseLimit(const std::string_view limit) {
+  std::size_t value = 0;
+  const auto [end, error] =
+      std::from_chars(limit.data(), limit.data() + limit.size(), value);
+  if (error != std::errc{} || end != limit.data() + limit.size()) {
+    throw std::runtime_error(
+        std::format("invalid number for --limit: '{}'", limit));
+  }
+  return value;
+}
+
+// Parses the optional argument of --stats, which defaults to text
+yarp::StatsFormat ParseStatsFormat(const char *format) {
+  if (format == nullptr || std::string_view{format} == "text") {
+    return yarp::StatsFormat::kText;
+  } else if (std::string_view{format} == "json") {
+    return yarp::StatsFormat::kJson;
+  }
+  throw std::runtime_error(
+      std::format("invalid format for --stats: '{}'", format));
+}
+
 }  // namespace
 
 namespace yarp {
@@ -87,6 +145,9 @@ void ArgumentParser::ParseArgs(Operation &operation,
         query_options |= QueryOptions::kInfo;
         break;
       case 'k':
+        if ((query_options & QueryOptions::kCheck) == QueryOptions::kCheck) {
+          query_options |= QueryOptions::kCheckFull;
+        }
         query_options |= QueryOptions::kCheck;
         break;
       case 'l':
@@ -142,6 +203,26 @@ void ArgumentParser::ParseArgs(Operation &operation,
                    std::string_view{"config"}) {
           config.set_conf_file(optarg);
           break;
+        } else if (std::string_view{kOpts[option_index].name} ==
+                   std::string_view{"aur-mirror"}) {
+          config.set_aur_mirror(optarg);
+          break;
+        } else if (std::string_view{kOpts[option_index].name} ==
+                   std::string_view{"searchby"}) {
+          config.set_aur_search_by(ParseSearchByList(optarg));
+          break;
+        } else if (std::string_view{kOpts[option_index].name} ==
+                   std::string_view{"sortby"}) {
+          config.set_aur_sort_by(ParseSortByOption(optarg));
+          break;
+        } else if (std::string_view{kOpts[option_index].name} ==
+                   std::string_view{"limit"}) {
+          config.set_aur_limit(ParseLimit(optarg));
+          break;
+        } else if (std::string_view{kOpts[option_index].name} ==
+                   std::string_view{"stats"}) {
+          config.set_stats_format(ParseStatsFormat(optarg));
+          break;
         }
     }
   }
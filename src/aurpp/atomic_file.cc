@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: MIT
+
+#include <aurpp/atomic_file.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <format>
+#include <system_error>
+
+namespace aurpp {
+
+std::expected<void, std::string> WriteFileAtomically(
+    const std::filesystem::path &path, std::string_view bytes,
+    const mode_t mode) {
+  static std::atomic<unsigned> counter{0};
+
+  // The temporary file name is unique per process and per call, so
+  // concurrent writers never share a file
+  std::filesystem::path temp_path = path;
+  temp_path += std::format(".{}.{}.tmp", getpid(), counter++);
+
+  // O_EXCL keeps a file someone else placed there from being written to
+  const int fd =
+      open(temp_path.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, mode);
+  if (fd < 0) {
+    return std::unexpected{
+        std::format("Could not create {}: {}", temp_path.string(),
+                    std::system_category().message(errno))};
+  }
+
+  int error = 0;
+  while (!bytes.empty() && error == 0) {
+    const ssize_t written = write(fd, bytes.data(), bytes.size());
+    if (written >= 0) {
+      bytes.remove_prefix(static_cast<std::size_t>(written));
+    } else if (errno != EINTR) {
+      error = errno;
+    }
+  }
+  if (close(fd) != 0 && error == 0) {
+    error = errno;
+  }
+  if (error != 0) {
+    unlink(temp_path.c_str());
+    return std::unexpected{
+        std::format("Could not write {}: {}", temp_path.string(),
+                    std::system_category().message(error))};
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec) {
+    std::filesystem::remove(temp_path, ec);
+    return std::unexpected{
+        std::format("Could not replace {}: {}", path.string(), ec.message())};
+  }
+  return {};
+}
+
+}  // namespace aurpp
@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef AURPP_ATOMIC_FILE_H_
+#define AURPP_ATOMIC_FILE_H_
+
+#include <sys/types.h>
+
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace aurpp {
+
+// Replaces the file at path with bytes. They are written to a temporary file
+// next to it first, which is created with mode and renamed into place, so
+// readers only ever see a complete file and the last writer wins. On failure,
+// any previous file at path is left intact.
+std::expected<void, std::string> WriteFileAtomically(
+    const std::filesystem::path &path, std::string_view bytes,
+    mode_t mode = 0644);
+
+}  // namespace aurpp
+
+#endif  // AURPP_ATOMIC_FILE_H_
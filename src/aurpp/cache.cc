@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: MIT
+
+#include <aurpp/atomic_file.h>
+#include <aurpp/cache.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <system_error>
+
+namespace {
+
+constexpr std::string_view kMagic = "yarp-cache-v1\n";
+
+// Touched whenever the directory is pruned. Its name can't clash with an
+// entry's, which are hexadecimal.
+constexpr std::string_view kPruneMarker = ".pruned";
+
+// The sizes of the fields of an entry, which follow its header
+struct Header {
+  std::size_t key_size = 0;
+  std::size_t etag_size = 0;
+  std::size_t last_modified_size = 0;
+  std::size_t body_size = 0;
+  aurpp::ResponseCache::Clock::time_point expires_at;
+};
+
+std::optional<Header> ReadHeader(std::istream &file) {
+  std::string magic(kMagic.size(), '\0');
+  if (!file.read(magic.data(), static_cast<std::streamsize>(magic.size())) ||
+      magic != kMagic) {
+    return std::nullopt;
+  }
+
+  Header header;
+  aurpp::ResponseCache::Clock::rep expires_at = 0;
+  if (!(file >> header.key_size >> header.etag_size >>
+        header.last_modified_size >> header.body_size >> expires_at) ||
+      file.get() != '\n') {
+    return std::nullopt;
+  }
+  header.expires_at = aurpp::ResponseCache::Clock::time_point{
+      aurpp::ResponseCache::Clock::duration{expires_at}};
+  return header;
+}
+
+// FNV-1a is stable across builds and platforms, unlike std::hash, which
+// matters because the file names are shared between processes
+constexpr std::uint64_t Fnv1a(const std::string_view data) {
+  std::uint64_t hash = 0xcbf29ce484222325;
+  for (const char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+}  // namespace
+
+namespace aurpp {
+
+ResponseCache::ResponseCache(std::filesystem::path directory)
+    : directory_(std::move(directory)) {
+  std::error_code ec;
+  std::filesystem::create_directories(directory_, ec);
+
+  // Source files change far less often than search and info results
+  set_ttl("/cgit/aur.git/plain/", std::chrono::hours{1});
+}
+
+std::string ResponseCache::Key(const HttpRequest &request,
+                               const std::string_view base_url) {
+  return std::format("{}\n{}", request.Url(base_url), request.Payload());
+}
+
+std::optional<ResponseCache::Entry> ResponseCache::Lookup(
+    const std::string_view key) const {
+  std::ifstream file{PathFor(key), std::ios::binary};
+  if (!file) {
+    return std::nullopt;
+  }
+
+  const std::optional<Header> header = ReadHeader(file);
+  if (!header.has_value()) {
+    return std::nullopt;
+  }
+
+  const auto read_field = [&file](const std::size_t size) {
+    std::string field(size, '\0');
+    file.read(field.data(), static_cast<std::streamsize>(size));
+    return field;
+  };
+
+  // A different key means two requests hashed to the same file name
+  if (read_field(header->key_size) != key) {
+    return std::nullopt;
+  }
+
+  Entry entry;
+  entry.etag = read_field(header->etag_size);
+  entry.last_modified = read_field(header->last_modified_size);
+  entry.body = read_field(header->body_size);
+  entry.expires_at = header->expires_at;
+
+  // A short read means the file was truncated
+  if (!file) {
+    return std::nullopt;
+  }
+  return entry;
+}
+
+bool ResponseCache::Store(const std::string_view key,
+                          const Entry &entry) const {
+  PruneIfDue();
+
+  std::string bytes{kMagic};
+  std::format_to(std::back_inserter(bytes), "{} {} {} {} {}\n", key.size(),
+                 entry.etag.size(), entry.last_modified.size(),
+                 entry.body.size(),
+                 entry.expires_at.time_since_epoch().count());
+  bytes.append(key);
+  bytes.append(entry.etag);
+  bytes.append(entry.last_modified);
+  bytes.append(entry.body);
+  return WriteFileAtomically(PathFor(key), bytes).has_value();
+}
+
+std::size_t ResponseCache::Prune(const Clock::time_point now) const {
+  std::size_t removed = 0;
+  std::error_code ec;
+  for (std::filesystem::directory_iterator it{directory_, ec}, end;
+       !ec && it != end; it.increment(ec)) {
+    const std::filesystem::path &path = it->path();
+    const std::string name = path.filename().string();
+    if (name.starts_with('.')) {
+      continue;
+    }
+
+    bool remove = false;
+    if (name.ends_with(".tmp")) {
+      // No writer takes this long, so the one that made it is gone
+      std::error_code time_ec;
+      const auto modified = std::filesystem::last_write_time(path, time_ec);
+      remove = !time_ec && modified + kPruneInterval <
+                               std::filesystem::file_time_type::clock::now();
+    } else {
+      std::ifstream file{path, std::ios::binary};
+      const std::optional<Header> header = ReadHeader(file);
+      const bool can_revalidate =
+          header.has_value() &&
+          header->etag_size + header->last_modified_size > 0;
+      // Files that aren't entries are left alone
+      remove = header.has_value() &&
+               now >= header->expires_at +
+                          (can_revalidate ? kStaleLifetime : Clock::duration{});
+    }
+
+    std::error_code remove_ec;
+    if (remove && std::filesystem::remove(path, remove_ec)) {
+      ++removed;
+    }
+  }
+  return removed;
+}
+
+void ResponseCache::PruneIfDue() const {
+  const std::filesystem::path marker = directory_ / kPruneMarker;
+  const auto now = std::filesystem::file_time_type::clock::now();
+
+  std::error_code ec;
+  const auto pruned_at = std::filesystem::last_write_time(marker, ec);
+  if (!ec && now < pruned_at + kPruneInterval) {
+    return;
+  }
+
+  // Touching the marker first keeps other processes from sweeping too
+  if (ec) {
+    std::ofstream{marker};
+  }
+  std::filesystem::last_write_time(marker, now, ec);
+  Prune(Clock::now());
+}
+
+std::chrono::seconds ResponseCache::TtlFor(
+    const std::string_view url_path) const {
+  std::chrono::seconds ttl = kDefaultTtl;
+  std::size_t matched_length = 0;
+
+  for (const auto &[prefix, prefix_ttl] : ttls_) {
+    if (url_path.starts_with(prefix) && prefix.size() >= matched_length) {
+      ttl = prefix_ttl;
+      matched_length = prefix.size();
+    }
+  }
+  return ttl;
+}
+
+void ResponseCache::set_ttl(const std::string_view endpoint_prefix,
+                            const std::chrono::seconds ttl) {
+  const auto it =
+      std::ranges::find_if(ttls_, [endpoint_prefix](const auto &pair) {
+        return pair.first == endpoint_prefix;
+      });
+  if (it != ttls_.end()) {
+    it->second = ttl;
+  } else {
+    ttls_.emplace_back(endpoint_prefix, ttl);
+  }
+}
+
+std::filesystem::path ResponseCache::PathFor(const std::string_view key) const {
+  return directory_ / std::format("{:016x}", Fnv1a(key));
+}
+
+}  // namespace aurpp
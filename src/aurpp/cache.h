@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef AURPP_CACHE_H_
+#define AURPP_CACHE_H_
+
+#include <aurpp/request.h>
+
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace aurpp {
+
+// A persistent cache of HTTP response bodies, stored as one file per request
+// under a directory. Entries are written to a temporary file and renamed into
+// place, so several processes can share the same directory safely: readers
+// only ever see complete entries, and the last writer wins.
+class ResponseCache {
+ public:
+  using Clock = std::chrono::system_clock;
+
+  struct Entry {
+    [[nodiscard]] bool IsFresh(const Clock::time_point now) const noexcept {
+      return now < expires_at;
+    }
+
+    [[nodiscard]] bool CanRevalidate() const noexcept {
+      return !etag.empty() || !last_modified.empty();
+    }
+
+    std::string body;
+    std::string etag;
+    std::string last_modified;
+    Clock::time_point expires_at;
+  };
+
+  static constexpr std::chrono::seconds kDefaultTtl{300};
+
+  // How long an expired entry that can be revalidated is kept. Others are
+  // pruned as soon as they expire.
+  static constexpr std::chrono::days kStaleLifetime{7};
+
+  // Store sweeps the directory at most this often, however many processes
+  // share it
+  static constexpr std::chrono::hours kPruneInterval{1};
+
+  explicit ResponseCache(std::filesystem::path directory);
+
+  ResponseCache(const ResponseCache &) = delete;
+  ResponseCache &operator=(const ResponseCache &) = delete;
+
+  ResponseCache(ResponseCache &&) = default;
+  ResponseCache &operator=(ResponseCache &&) = default;
+
+  // The key identifies a request by its URL and payload
+  [[nodiscard]] static std::string Key(const HttpRequest &request,
+                                       std::string_view base_url);
+
+  [[nodiscard]] std::optional<Entry> Lookup(std::string_view key) const;
+
+  // Returns false if the entry could not be written. A failed write leaves
+  // any previous entry for the key intact. Expired entries are pruned first
+  // when kPruneInterval has passed since the last sweep.
+  bool Store(std::string_view key, const Entry &entry) const;
+
+  // Removes the entries that are past use at now, as well as temporary files
+  // left behind by writers that died. Returns the number of files removed.
+  std::size_t Prune(Clock::time_point now) const;
+
+  // Returns the time-to-live for responses from the endpoint at url_path,
+  // using the longest matching prefix registered with set_ttl.
+  [[nodiscard]] std::chrono::seconds TtlFor(std::string_view url_path) const;
+
+  void set_ttl(std::string_view endpoint_prefix, std::chrono::seconds ttl);
+
+  [[nodiscard]] const std::filesystem::path &directory() const noexcept {
+    return directory_;
+  }
+
+ private:
+  [[nodiscard]] std::filesystem::path PathFor(std::string_view key) const;
+
+  // Prunes the directory if no process has for kPruneInterval
+  void PruneIfDue() const;
+
+  std::filesystem::path directory_;
+  std::vector<std::pair<std::string, std::chrono::seconds>> ttls_;
+};
+
+}  // namespace aurpp
+
+#endif  // AURPP_CACHE_H_
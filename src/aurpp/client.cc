@@ -0,0 +1,983 @@
+// SPDX-License-Identifier: MIT
+
+#include <aurpp/client.h>
+#include <aurpp/decoder.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <deque>
+#include <format>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+using CurlHandle = std::unique_ptr<CURL, decltype(&curl_easy_cleanup)>;
+using CurlHeaders =
+    std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)>;
+
+// Per-request state that lives for the duration of a transfer
+struct TransferState {
+  std::string response_data;
+  long status = 0;
+  std::string etag;
+  std::string last_modified;
+  std::string retry_after;
+  CurlHeaders headers{nullptr, curl_slist_free_all};
+  std::string cache_key;
+  std::optional<aurpp::ResponseCache::Entry> cached;
+  // When set, the body is parsed as it arrives instead of being kept in
+  // response_data, so memory stays bounded however large the response is
+  aurpp::RpcResponseStream *stream = nullptr;
+};
+
+// State for a single transfer driven by the multi handle. The easy handle is
+// reused for the next pending request once its transfer completes.
+struct Transfer {
+  CurlHandle handle{nullptr, curl_easy_cleanup};
+  std::size_t index{};
+  bool active = false;
+  TransferState state;
+};
+
+std::optional<std::string_view> HeaderValue(const std::string_view line,
+                                            const std::string_view name) {
+  const std::size_t colon = line.find(':');
+  if (colon != name.size() ||
+      !std::ranges::equal(line.substr(0, colon), name, [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) ==
+               std::tolower(static_cast<unsigned char>(b));
+      })) {
+    return std::nullopt;
+  }
+
+  const std::string_view value = line.substr(colon + 1);
+  const std::size_t first = value.find_first_not_of(" \t");
+  const std::size_t last = value.find_last_not_of(" \t\r\n");
+  if (first == std::string_view::npos) {
+    return std::string_view{};
+  }
+  return value.substr(first, last - first + 1);
+}
+
+std::size_t HeaderCallback(char *buffer, const std::size_t size,
+                           const std::size_t nitems, void *userdata) {
+  const std::size_t total_size = size * nitems;
+  auto *state = static_cast<TransferState *>(userdata);
+  const std::string_view line{buffer, total_size};
+
+  // Redirects produce several responses, only the last one counts
+  if (line.starts_with("HTTP/")) {
+    state->status = 0;
+    state->etag.clear();
+    state->last_modified.clear();
+    state->retry_after.clear();
+
+    const std::size_t space = line.find(' ');
+    if (space != std::string_view::npos) {
+      std::from_chars(line.data() + space + 1, line.data() + line.size(),
+                      state->status);
+    }
+  } else if (const auto etag = HeaderValue(line, "ETag")) {
+    state->etag = *etag;
+  } else if (const auto last_modified = HeaderValue(line, "Last-Modified")) {
+    state->last_modified = *last_modified;
+  } else if (const auto retry_after = HeaderValue(line, "Retry-After")) {
+    state->retry_after = *retry_after;
+  }
+  return total_size;
+}
+
+std::size_t StreamWriteCallback(char *contents, const std::size_t size,
+                               const std::size_t nmemb, void *userp) {
+  const std::size_t total_size = size * nmemb;
+  auto *state = static_cast<TransferState *>(userp);
+  const std::string_view bytes{contents, total_size};
+
+  // Error pages are not JSON, FinishTransfer reports them by status instead
+  if (state->status == 200 && !state->stream->Feed(bytes)) {
+    return CURL_WRITEFUNC_ERROR;
+  }
+  return total_size;
+}
+
+void PrepareHandle(CURL *handle, const aurpp::HttpRequest &request,
+                   const std::string_view base_url, TransferState *state) {
+  const std::string url = request.Url(base_url);
+
+  curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+  if (state->stream != nullptr) {
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, StreamWriteCallback);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, state);
+  } else {
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION,
+                     aurpp::detail::WriteCallback);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, &state->response_data);
+  }
+  curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, HeaderCallback);
+  curl_easy_setopt(handle, CURLOPT_HEADERDATA, state);
+
+  // Ask the server to only send the body if it changed since it was cached
+  if (state->cached.has_value()) {
+    curl_slist *headers = nullptr;
+    if (!state->cached->etag.empty()) {
+      const std::string header =
+          std::format("If-None-Match: {}", state->cached->etag);
+      headers = curl_slist_append(headers, header.c_str());
+    }
+    if (!state->cached->last_modified.empty()) {
+      const std::string header =
+          std::format("If-Modified-Since: {}", state->cached->last_modified);
+      headers = curl_slist_append(headers, header.c_str());
+    }
+    state->headers.reset(headers);
+  }
+  curl_easy_setopt(handle, CURLOPT_HTTPHEADER, state->headers.get());
+
+  switch (request.command()) {
+    case aurpp::HttpRequest::Command::kGet: {
+      curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+      break;
+    }
+    case aurpp::HttpRequest::Command::kPost: {
+      // The payload is a temporary, so let curl keep its own copy for the
+      // lifetime of the transfer
+      const std::string payload = request.Payload();
+      curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE,
+                       static_cast<long>(payload.size()));
+      curl_easy_setopt(handle, CURLOPT_COPYPOSTFIELDS, payload.c_str());
+      break;
+    }
+    default:
+      std::unreachable();
+  }
+}
+
+// Resets state for request and looks it up in the cache. Returns the cached
+// body if it is still fresh, in which case no transfer is needed.
+std::optional<std::string> BeginTransfer(const aurpp::ResponseCache *cache,
+                                         const aurpp::HttpRequest &request,
+                                         const std::string_view base_url,
+                                         TransferState *state) {
+  state->response_data.clear();
+  state->status = 0;
+  state->etag.clear();
+  state->last_modified.clear();
+  state->retry_after.clear();
+  state->headers.reset();
+  state->cached.reset();
+
+  if (cache == nullptr) {
+    return std::nullopt;
+  }
+
+  state->cache_key = aurpp::ResponseCache::Key(request, base_url);
+  std::optional<aurpp::ResponseCache::Entry> entry =
+      cache->Lookup(state->cache_key);
+  if (!entry.has_value()) {
+    return std::nullopt;
+  }
+
+  if (entry->IsFresh(aurpp::ResponseCache::Clock::now())) {
+    return std::move(entry->body);
+  }
+  if (entry->CanRevalidate()) {
+    state->cached = std::move(entry);
+  }
+  return std::nullopt;
+}
+
+std::expected<std::string, std::string> FinishTransfer(
+    const aurpp::ResponseCache *cache, const aurpp::HttpRequest &request,
+    CURL *handle, const CURLcode result, TransferState *state) {
+  if (result != CURLE_OK) {
+    return std::unexpected{
+        std::format("CURL error: {}", curl_easy_strerror(result))};
+  }
+
+  long http_code = 0;
+  curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &http_code);
+
+  const bool not_modified = http_code == 304 && state->cached.has_value();
+  if (http_code != 200 && !not_modified) {
+    return std::unexpected{std::format("HTTP error: {}", http_code)};
+  }
+
+  // A streamed body wasn't kept, so only a revalidated entry can be stored
+  if (cache == nullptr || (state->stream != nullptr && !not_modified)) {
+    return std::move(state->response_data);
+  }
+
+  aurpp::ResponseCache::Entry entry;
+  if (not_modified) {
+    entry = std::move(*state->cached);
+    if (state->stream != nullptr) {
+      state->stream->Feed(entry.body);
+    }
+  } else {
+    entry.body = std::move(state->response_data);
+  }
+  if (!state->etag.empty()) {
+    entry.etag = std::move(state->etag);
+  }
+  if (!state->last_modified.empty()) {
+    entry.last_modified = std::move(state->last_modified);
+  }
+
+  // An RPC error, like one for too many results, would otherwise be replayed
+  // from the cache for as long as the entry lives
+  if (!aurpp::detail::IsErrorResponse(entry.body)) {
+    // Without a base URL, Url() yields just the endpoint path
+    entry.expires_at =
+        aurpp::ResponseCache::Clock::now() + cache->TtlFor(request.Url(""));
+    cache->Store(state->cache_key, entry);
+  }
+
+  return std::move(entry.body);
+}
+
+}  // namespace
+
+namespace aurpp {
+
+namespace detail {
+
+std::vector<FieldSearchMatch> MergeFieldSearches(
+    const std::span<const SearchRequest::SearchBy> fields,
+    const std::span<const RpcResponse> responses) {
+  if (fields.empty() || responses.empty()) {
+    return {};
+  }
+  const std::size_t term_count = responses.size() / fields.size();
+
+  struct Found {
+    const AurPackage *package = nullptr;
+    // Bit i is set when fields[i] matched some term
+    std::uint32_t field_mask = 0;
+    std::size_t terms_matched = 0;
+  };
+  std::unordered_map<int, Found> found;
+  std::vector<int> order;
+
+  for (std::size_t term = 0; term < term_count; ++term) {
+    for (std::size_t field = 0; field < fields.size(); ++field) {
+      for (const AurPackage &package :
+           responses[(term * fields.size()) + field].packages) {
+        const auto [it, inserted] = found.try_emplace(package.id());
+        Found &entry = it->second;
+        if (inserted) {
+          if (term != 0) {
+            // Missed the first term, so it can never match every term
+            continue;
+          }
+          entry.package = &package;
+          order.push_back(package.id());
+        } else if (entry.package == nullptr) {
+          continue;
+        }
+        entry.field_mask |= std::uint32_t{1} << field;
+        // Only counts the term once however many fields it matched, and
+        // stops counting after a term that did not match
+        if (entry.terms_matched == term) {
+          ++entry.terms_matched;
+        }
+      }
+    }
+  }
+
+  std::vector<FieldSearchMatch> matches;
+  for (const int id : order) {
+    const Found &entry = found.at(id);
+    if (entry.terms_matched != term_count) {
+      continue;
+    }
+    FieldSearchMatch &match = matches.emplace_back();
+    match.package = *entry.package;
+    for (std::size_t field = 0; field < fields.size(); ++field) {
+      if ((entry.field_mask & (std::uint32_t{1} << field)) != 0) {
+        match.fields.push_back(fields[field]);
+      }
+    }
+  }
+  return matches;
+}
+
+std::vector<SearchRequest::SearchBy> UniqueFields(
+    const std::span<const SearchRequest::SearchBy> fields) {
+  std::vector<SearchRequest::SearchBy> unique;
+  for (const SearchRequest::SearchBy field : fields) {
+    if (std::ranges::find(unique, field) == unique.end()) {
+      unique.push_back(field);
+    }
+  }
+  return unique;
+}
+
+}  // namespace detail
+
+Client::Client(std::string base_url)
+    : Client(std::move(base_url), nullptr) {}
+
+Client::Client(std::string base_url, CURLSH *share)
+    : share_handle_{nullptr, curl_share_cleanup},
+      share_(share),
+      curl_handle_{curl_easy_init(), curl_easy_cleanup},
+      multi_handle_{curl_multi_init(), curl_multi_cleanup},
+      base_url_(std::move(base_url)) {
+  if (share_ == nullptr) {
+    share_handle_.reset(curl_share_init());
+    share_ = share_handle_.get();
+  }
+  if (share_handle_) {
+    curl_share_setopt(share_handle_.get(), CURLSHOPT_SHARE,
+                      CURL_LOCK_DATA_CONNECT);
+    curl_share_setopt(share_handle_.get(), CURLSHOPT_SHARE,
+                      CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_handle_.get(), CURLSHOPT_SHARE,
+                      CURL_LOCK_DATA_SSL_SESSION);
+  }
+
+  if (curl_handle_) {
+    // Options set here are carried over to the handles of concurrent
+    // transfers, which are duplicated from this one
+    const int features = curl_version_info(CURLVERSION_NOW)->features;
+    curl_easy_setopt(curl_handle_.get(), CURLOPT_HTTP_VERSION,
+                     detail::PreferredHttpVersion(features));
+    // Wait for a connection that can multiplex rather than opening another
+    // one to the same host
+    curl_easy_setopt(curl_handle_.get(), CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(curl_handle_.get(), CURLOPT_TCP_KEEPALIVE, 1L);
+    // Offer every encoding curl was built with. curl decompresses each chunk
+    // as it arrives, so write callbacks, and with them the streaming parser,
+    // see the decoded bytes without a separate pass over the body.
+    curl_easy_setopt(curl_handle_.get(), CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(curl_handle_.get(), CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl_handle_.get(), CURLOPT_USERAGENT, "yarp/1.0");
+    if (share_ != nullptr) {
+      curl_easy_setopt(curl_handle_.get(), CURLOPT_SHARE, share_);
+    }
+  }
+
+  if (multi_handle_) {
+    curl_multi_setopt(multi_handle_.get(), CURLMOPT_PIPELINING,
+                      CURLPIPE_MULTIPLEX);
+  }
+}
+
+Client::~Client() { SaveConnectionState(); }
+
+void Client::EnableConnectionState(std::filesystem::path directory) {
+  // The directory holds the user's TLS sessions, so only they may enter it,
+  // even if it was made without these permissions before
+  std::error_code ec;
+  std::filesystem::create_directories(directory, ec);
+  std::filesystem::permissions(directory, std::filesystem::perms::owner_all,
+                               ec);
+  connection_state_dir_ = std::move(directory);
+  if (!curl_handle_) {
+    return;
+  }
+
+  // curl reads these files when the option is set and rewrites them when a
+  // handle using them is cleaned up
+  const std::string alt_svc = (connection_state_dir_ / "alt-svc").string();
+  curl_easy_setopt(curl_handle_.get(), CURLOPT_ALTSVC_CTRL,
+                   static_cast<long>(CURLALTSVC_H1 | CURLALTSVC_H2 |
+                                     CURLALTSVC_H3));
+  curl_easy_setopt(curl_handle_.get(), CURLOPT_ALTSVC, alt_svc.c_str());
+  const std::string hsts = (connection_state_dir_ / "hsts").string();
+  curl_easy_setopt(curl_handle_.get(), CURLOPT_HSTS_CTRL,
+                   static_cast<long>(CURLHSTS_ENABLE));
+  curl_easy_setopt(curl_handle_.get(), CURLOPT_HSTS, hsts.c_str());
+
+  const ConnectionState::Clock::time_point now =
+      ConnectionState::Clock::now();
+  connection_state_ =
+      ConnectionState::Load(connection_state_dir_ / "connections", now);
+
+  curl_slist *resolve = nullptr;
+  for (const std::string &entry : connection_state_.ResolveEntries(now)) {
+    resolve = curl_slist_append(resolve, entry.c_str());
+  }
+  resolve_list_.reset(resolve);
+  curl_easy_setopt(curl_handle_.get(), CURLOPT_RESOLVE, resolve_list_.get());
+
+#if LIBCURL_VERSION_NUM >= 0x080c00
+  for (const ConnectionState::TlsSession &session :
+       connection_state_.tls_sessions()) {
+    const auto *shmac =
+        reinterpret_cast<const unsigned char *>(session.shmac.data());
+    const auto *data =
+        reinterpret_cast<const unsigned char *>(session.data.data());
+    curl_easy_ssls_import(curl_handle_.get(), session.key.c_str(), shmac,
+                          session.shmac.size(), data, session.data.size());
+  }
+#endif
+}
+
+void Client::SaveConnectionState() {
+  if (connection_state_dir_.empty()) {
+    return;
+  }
+
+#if LIBCURL_VERSION_NUM >= 0x080c00
+  if (curl_handle_) {
+    const auto export_session =
+        [](CURL *, void *userptr, const char *session_key,
+           const unsigned char *shmac, const std::size_t shmac_len,
+           const unsigned char *sdata, const std::size_t sdata_len,
+           const curl_off_t valid_until, int, const char *,
+           std::size_t) -> CURLcode {
+      ConnectionState::TlsSession session;
+      session.key = session_key;
+      session.shmac.assign(reinterpret_cast<const char *>(shmac), shmac_len);
+      session.data.assign(reinterpret_cast<const char *>(sdata), sdata_len);
+      session.valid_until = ConnectionState::Clock::time_point{
+          std::chrono::seconds{valid_until}};
+      static_cast<ConnectionState *>(userptr)->RecordTlsSession(
+          std::move(session));
+      return CURLE_OK;
+    };
+    curl_easy_ssls_export(curl_handle_.get(), export_session,
+                          &connection_state_);
+  }
+#endif
+
+  connection_state_.Save(connection_state_dir_ / "connections");
+}
+
+void Client::RecordTransfer(CURL *handle) {
+  if (!transfer_observer_ && connection_state_dir_.empty()) {
+    return;
+  }
+
+  TransferInfo info;
+  const char *url = nullptr;
+  curl_easy_getinfo(handle, CURLINFO_EFFECTIVE_URL, &url);
+  if (url != nullptr) {
+    info.url = url;
+  }
+  long new_connections = 0;
+  curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &new_connections);
+  info.reused_connection = new_connections == 0;
+
+  // Only a new connection tells where the host resolved to
+  if (!connection_state_dir_.empty() && !info.reused_connection) {
+    const char *ip = nullptr;
+    long port = 0;
+    curl_easy_getinfo(handle, CURLINFO_PRIMARY_IP, &ip);
+    curl_easy_getinfo(handle, CURLINFO_PRIMARY_PORT, &port);
+    if (ip != nullptr) {
+      connection_state_.RecordAddress(detail::UrlHost(info.url),
+                                      static_cast<int>(port), ip,
+                                      ConnectionState::Clock::now());
+    }
+  }
+
+  if (!transfer_observer_) {
+    return;
+  }
+
+  long http_version = 0;
+  curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &http_version);
+  info.http_version = detail::HttpVersionName(http_version);
+
+  const auto time_of = [handle](const CURLINFO what) {
+    curl_off_t time = 0;
+    curl_easy_getinfo(handle, what, &time);
+    return std::chrono::microseconds{time};
+  };
+  info.name_lookup_time = time_of(CURLINFO_NAMELOOKUP_TIME_T);
+  info.connect_time = time_of(CURLINFO_CONNECT_TIME_T);
+  info.tls_time = time_of(CURLINFO_APPCONNECT_TIME_T);
+  info.start_transfer_time = time_of(CURLINFO_STARTTRANSFER_TIME_T);
+  info.total_time = time_of(CURLINFO_TOTAL_TIME_T);
+
+  curl_off_t downloaded_bytes = 0;
+  curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &downloaded_bytes);
+  info.downloaded_bytes = static_cast<std::size_t>(downloaded_bytes);
+
+  transfer_observer_(info);
+}
+
+void Client::EnableCache(std::filesystem::path directory) {
+  cache_ = std::make_unique<ResponseCache>(std::move(directory));
+}
+
+std::expected<RpcResponse, std::string> Client::ExecuteInfo(
+    const std::span<const std::string> names) {
+  const std::vector<InfoRequest> requests =
+      InfoRequest::Chunked(names, info_chunk_size_);
+
+  std::vector<AurPackage> packages;
+  for (std::expected<RpcResponse, std::string> &result :
+       ExecuteMany<InfoRequest, RpcResponse>(requests)) {
+    if (!result.has_value()) {
+      return std::unexpected{std::move(result.error())};
+    }
+    std::ranges::move(result.value().packages, std::back_inserter(packages));
+  }
+
+  // Chunks may complete in any order and the server does not promise to
+  // preserve argument order, so restore the order the names were given in
+  std::unordered_map<std::string_view, std::size_t> positions;
+  positions.reserve(names.size());
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    positions.try_emplace(names[i], i);
+  }
+
+  const auto position = [&positions](const AurPackage &package) {
+    const auto it = positions.find(package.name());
+    return it != positions.end() ? it->second : positions.size();
+  };
+  std::ranges::stable_sort(packages, std::less{}, position);
+
+  return RpcResponse{std::move(packages)};
+}
+
+std::expected<std::vector<FieldSearchMatch>, std::string>
+Client::ExecuteFieldSearch(
+    const std::span<const SearchRequest::SearchBy> fields,
+    const std::span<const std::string> terms) {
+  const std::vector<SearchRequest::SearchBy> unique_fields =
+      detail::UniqueFields(fields);
+
+  std::vector<SearchRequest> requests;
+  requests.reserve(terms.size() * unique_fields.size());
+  for (const std::string &term : terms) {
+    for (const SearchRequest::SearchBy field : unique_fields) {
+      requests.emplace_back(field, term);
+    }
+  }
+
+  std::vector<RpcResponse> responses;
+  responses.reserve(requests.size());
+  for (std::expected<RpcResponse, std::string> &result :
+       ExecuteMany<SearchRequest, RpcResponse>(requests)) {
+    if (!result.has_value()) {
+      return std::unexpected{std::move(result.error())};
+    }
+    responses.push_back(std::move(result.value()));
+  }
+  return detail::MergeFieldSearches(unique_fields, responses);
+}
+
+std::future<std::expected<std::vector<FieldSearchMatch>, std::string>>
+Client::ExecuteFieldSearchAsync(std::vector<SearchRequest::SearchBy> fields,
+                                std::vector<std::string> terms) {
+  return std::async(std::launch::async, [this, fields = std::move(fields),
+                                         terms = std::move(terms)] {
+    return ExecuteFieldSearch(fields, terms);
+  });
+}
+
+std::expected<std::size_t, std::string> Client::ExecuteStreaming(
+    const RpcRequest &request, RpcResponseStream::PackageCallback on_package) {
+  RpcResponseStream stream{std::move(on_package)};
+  const std::expected<std::string, std::string> body =
+      Perform(request, &stream);
+
+  // A malformed response aborts the transfer, so its parse error is the
+  // more useful one to report
+  if (stream.error().has_value()) {
+    return std::unexpected{stream.error().value()};
+  }
+  if (!body.has_value()) {
+    return std::unexpected{body.error()};
+  }
+  return stream.Finish();
+}
+
+std::expected<std::string, std::string> Client::Perform(
+    const HttpRequest &request, RpcResponseStream *stream) {
+  // Batches are where retries, hedging and coalescing happen, and a batch of
+  // one costs no more than a single transfer
+  if (scheduler_ && stream == nullptr) {
+    const HttpRequest *const requests[] = {&request};
+    return std::move(PerformMany(requests).front());
+  }
+
+  if (!curl_handle_) {
+    return std::unexpected{"CURL handle not initialized"};
+  }
+
+  TransferState state;
+  state.stream = stream;
+  for (int attempts = 1;; ++attempts) {
+    if (std::optional<std::string> cached =
+            BeginTransfer(cache_.get(), request, base_url_, &state)) {
+      if (stream != nullptr) {
+        stream->Feed(*cached);
+      }
+      return std::move(*cached);
+    }
+    PrepareHandle(curl_handle_.get(), request, base_url_, &state);
+    if (scheduler_) {
+      WaitToStart();
+    }
+
+    const CURLcode res = curl_easy_perform(curl_handle_.get());
+    if (res == CURLE_OK) {
+      RecordTransfer(curl_handle_.get());
+    }
+
+    // Packages may already have been streamed when the connection failed,
+    // so only error responses, whose body is never streamed, are retried
+    long http_code = 0;
+    curl_easy_getinfo(curl_handle_.get(), CURLINFO_RESPONSE_CODE, &http_code);
+    if (scheduler_ && res == CURLE_OK &&
+        detail::IsTransientFailure(res, http_code)) {
+      if (const auto delay = RetryDelay(attempts, state.retry_after)) {
+        std::this_thread::sleep_for(*delay);
+        continue;
+      }
+    }
+    return FinishTransfer(cache_.get(), request, curl_handle_.get(), res,
+                          &state);
+  }
+}
+
+void Client::WaitToStart() {
+  while (true) {
+    const RequestScheduler::Clock::duration wait =
+        scheduler_->TryStart(RequestScheduler::Clock::now());
+    if (wait == RequestScheduler::Clock::duration::zero()) {
+      return;
+    }
+    std::this_thread::sleep_for(wait);
+  }
+}
+
+std::optional<RequestScheduler::Clock::duration> Client::RetryDelay(
+    const int attempts, const std::string_view retry_after) {
+  const std::optional<std::chrono::seconds> requested =
+      detail::ParseRetryAfter(retry_after);
+  // A server that asks for a pause gets it from every request, not just
+  // this one, but never longer than a retry would wait
+  if (requested.has_value()) {
+    scheduler_->Throttle(
+        RequestScheduler::Clock::now() +
+        std::min<RequestScheduler::Clock::duration>(
+            *requested, scheduler_->options().max_delay));
+  }
+  return scheduler_->RetryDelay(attempts, requested);
+}
+
+std::vector<std::expected<std::string, std::string>> Client::PerformMany(
+    std::span<const HttpRequest *const> requests) {
+  using Clock = RequestScheduler::Clock;
+
+  std::vector<std::expected<std::string, std::string>> results(
+      requests.size());
+  if (requests.empty()) {
+    return results;
+  }
+
+  if (!curl_handle_ || !multi_handle_) {
+    std::ranges::fill(results,
+                      std::unexpected{"CURL handle not initialized"});
+    return results;
+  }
+
+  const Clock::duration hedge_after =
+      scheduler_ ? Clock::duration{scheduler_->options().hedge_after}
+                 : Clock::duration::zero();
+  const bool hedging = hedge_after > Clock::duration::zero();
+
+  CURLM *multi = multi_handle_.get();
+  // A hedge needs a transfer of its own, even in a batch of one
+  std::vector<Transfer> transfers(std::min(
+      requests.size() * (hedging ? 2 : 1), max_concurrent_requests_));
+
+  struct Progress {
+    int attempts = 0;
+    // The transfers running for the request, two while it is hedged
+    std::size_t running = 0;
+    bool hedged = false;
+    bool done = false;
+    // Set when other requests wait for this one's result, see
+    // RequestScheduler::ClaimRequest
+    bool leader = false;
+    Clock::time_point started_at;
+  };
+  std::vector<Progress> progress(requests.size());
+  std::deque<std::size_t> pending(requests.size());
+  std::iota(pending.begin(), pending.end(), 0UZ);
+  // Requests waiting to be retried, and when they may be
+  std::vector<std::pair<Clock::time_point, std::size_t>> backing_off;
+  // Requests waiting for an identical request of another batch
+  std::vector<
+      std::pair<std::size_t, std::shared_future<RequestScheduler::Result>>>
+      following;
+  std::size_t finished = 0;
+  // When a request that is held back may start
+  Clock::time_point wake_at = Clock::time_point::max();
+
+  const auto cache_key = [&](const std::size_t index) {
+    return ResponseCache::Key(*requests[index], base_url_);
+  };
+
+  const auto finish = [&](const std::size_t index,
+                          std::expected<std::string, std::string> result) {
+    progress[index].done = true;
+    ++finished;
+    if (progress[index].leader) {
+      scheduler_->Publish(cache_key(index), result);
+    }
+    results[index] = std::move(result);
+  };
+
+  const auto launch = [&](Transfer &transfer, const std::size_t index,
+                          const Clock::time_point now, const bool hedge) {
+    transfer.index = index;
+    transfer.active = true;
+    ++progress[index].running;
+    progress[index].started_at = now;
+    PrepareHandle(transfer.handle.get(), *requests[index], base_url_,
+                  &transfer.state);
+    // Waiting to multiplex over the connection of a stalled transfer would
+    // stall the hedge as well
+    curl_easy_setopt(transfer.handle.get(), CURLOPT_PIPEWAIT, hedge ? 0L : 1L);
+    curl_multi_add_handle(multi, transfer.handle.get());
+  };
+
+  // Starts the next pending request that can't be answered from the cache or
+  // by another batch, returning false if there is none or it has to wait
+  const auto start_transfer = [&](Transfer &transfer,
+                                  const Clock::time_point now) {
+    while (!pending.empty()) {
+      const std::size_t index = pending.front();
+      Progress &request = progress[index];
+      if (std::optional<std::string> cached = BeginTransfer(
+              cache_.get(), *requests[index], base_url_, &transfer.state)) {
+        pending.pop_front();
+        finish(index, std::move(*cached));
+        continue;
+      }
+
+      if (scheduler_ && !request.leader) {
+        RequestScheduler::Claim claim =
+            scheduler_->ClaimRequest(cache_key(index));
+        if (!claim.leader) {
+          pending.pop_front();
+          following.emplace_back(index, std::move(claim.result));
+          continue;
+        }
+        request.leader = true;
+      }
+
+      if (scheduler_) {
+        if (const Clock::duration wait = scheduler_->TryStart(now);
+            wait != Clock::duration::zero()) {
+          wake_at = std::min(wake_at, now + wait);
+          return false;
+        }
+      }
+
+      pending.pop_front();
+      ++request.attempts;
+      request.hedged = false;
+      launch(transfer, index, now, false);
+      return true;
+    }
+    return false;
+  };
+
+  // Duplicates the request that has been running the longest past
+  // hedge_after, once nothing is pending
+  const auto start_hedge = [&](Transfer &transfer,
+                               const Clock::time_point now) {
+    if (!hedging || !pending.empty()) {
+      return false;
+    }
+
+    std::optional<std::size_t> slowest;
+    for (const Transfer &other : transfers) {
+      if (!other.active) {
+        continue;
+      }
+      const Progress &request = progress[other.index];
+      if (request.hedged || request.running != 1) {
+        continue;
+      }
+      if (now - request.started_at < hedge_after) {
+        wake_at = std::min(wake_at, request.started_at + hedge_after);
+      } else if (!slowest.has_value() ||
+                 request.started_at < progress[*slowest].started_at) {
+        slowest = other.index;
+      }
+    }
+    if (!slowest.has_value()) {
+      return false;
+    }
+
+    if (const Clock::duration wait = scheduler_->TryStart(now);
+        wait != Clock::duration::zero()) {
+      wake_at = std::min(wake_at, now + wait);
+      return false;
+    }
+    // Nothing is cached for the request, but the hedge still needs its own
+    // revalidation headers
+    static_cast<void>(BeginTransfer(cache_.get(), *requests[*slowest],
+                                    base_url_, &transfer.state));
+    progress[*slowest].hedged = true;
+    launch(transfer, *slowest, progress[*slowest].started_at, true);
+    return true;
+  };
+
+  // Stops the transfers still running for a request that has finished, such
+  // as the slower of a hedged pair
+  const auto cancel = [&](const std::size_t index) {
+    for (Transfer &transfer : transfers) {
+      if (transfer.active && transfer.index == index) {
+        curl_multi_remove_handle(multi, transfer.handle.get());
+        transfer.active = false;
+        --progress[index].running;
+      }
+    }
+  };
+
+  for (Transfer &transfer : transfers) {
+    // Duplicating the primary handle carries over the common options set in
+    // the constructor
+    transfer.handle.reset(curl_easy_duphandle(curl_handle_.get()));
+    if (!transfer.handle) {
+      std::ranges::fill(results,
+                        std::unexpected{"CURL handle not initialized"});
+      return results;
+    }
+    // The share handle is not carried over
+    if (share_ != nullptr) {
+      curl_easy_setopt(transfer.handle.get(), CURLOPT_SHARE, share_);
+    }
+    curl_easy_setopt(transfer.handle.get(), CURLOPT_PRIVATE, &transfer);
+  }
+
+  // Starts what can be started and returns whether anything was, after
+  // moving on the requests that are done backing off or waiting
+  const auto refill = [&] {
+    const Clock::time_point now = Clock::now();
+    wake_at = Clock::time_point::max();
+
+    std::erase_if(backing_off, [&](const auto &retry) {
+      if (retry.first > now) {
+        wake_at = std::min(wake_at, retry.first);
+        return false;
+      }
+      pending.push_back(retry.second);
+      return true;
+    });
+    std::erase_if(following, [&](auto &follower) {
+      if (follower.second.wait_for(std::chrono::seconds{0}) !=
+          std::future_status::ready) {
+        return false;
+      }
+      finish(follower.first, follower.second.get());
+      return true;
+    });
+
+    bool started_transfer = false;
+    for (Transfer &transfer : transfers) {
+      if (!transfer.active) {
+        started_transfer |=
+            start_transfer(transfer, now) || start_hedge(transfer, now);
+      }
+    }
+    return started_transfer;
+  };
+  refill();
+
+  while (finished < requests.size()) {
+    int running = 0;
+    if (const CURLMcode mc = curl_multi_perform(multi, &running);
+        mc != CURLM_OK) {
+      const std::string error =
+          std::format("CURL error: {}", curl_multi_strerror(mc));
+      for (Transfer &transfer : transfers) {
+        if (transfer.active) {
+          curl_multi_remove_handle(multi, transfer.handle.get());
+          transfer.active = false;
+        }
+      }
+      for (std::size_t i = 0; i < requests.size(); ++i) {
+        if (!progress[i].done) {
+          finish(i, std::unexpected{error});
+        }
+      }
+      break;
+    }
+
+    int messages_left = 0;
+    while (const CURLMsg *msg = curl_multi_info_read(multi, &messages_left)) {
+      if (msg->msg != CURLMSG_DONE) continue;
+
+      Transfer *transfer = nullptr;
+      curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &transfer);
+      const CURLcode result = msg->data.result;
+      curl_multi_remove_handle(multi, msg->easy_handle);
+      transfer->active = false;
+      const std::size_t index = transfer->index;
+      --progress[index].running;
+      if (result == CURLE_OK) {
+        RecordTransfer(transfer->handle.get());
+      }
+
+      long http_code = 0;
+      curl_easy_getinfo(transfer->handle.get(), CURLINFO_RESPONSE_CODE,
+                        &http_code);
+      if (scheduler_ && detail::IsTransientFailure(result, http_code)) {
+        // The other transfer of a hedged pair may still succeed
+        if (progress[index].running > 0) {
+          continue;
+        }
+        if (const auto delay = RetryDelay(progress[index].attempts,
+                                          transfer->state.retry_after)) {
+          backing_off.emplace_back(Clock::now() + *delay, index);
+          continue;
+        }
+      }
+
+      finish(index, FinishTransfer(cache_.get(), *requests[index],
+                                   transfer->handle.get(), result,
+                                   &transfer->state));
+      cancel(index);
+    }
+
+    // Newly added handles have no sockets to wait on until the next call to
+    // curl_multi_perform, so only poll when nothing was started. Requests
+    // held back or waiting for another batch are checked on again in time.
+    if (!refill() && finished < requests.size()) {
+      const Clock::time_point now = Clock::now();
+      // With no transfers of its own, the batch only waits on other
+      // batches, and is woken as soon as one of them publishes
+      if (running == 0 && !following.empty()) {
+        following.front().second.wait_until(
+            std::min(wake_at, now + std::chrono::seconds{1}));
+        continue;
+      }
+      const Clock::duration longest =
+          following.empty() ? Clock::duration{std::chrono::seconds{1}}
+                            : Clock::duration{std::chrono::milliseconds{10}};
+      const Clock::duration wait =
+          std::max(std::min(wake_at, now + longest) - now,
+                   Clock::duration::zero());
+      curl_multi_poll(
+          multi, nullptr, 0,
+          static_cast<int>(
+              std::chrono::ceil<std::chrono::milliseconds>(wait).count()),
+          nullptr);
+    }
+  }
+
+  return results;
+}
+
+}  // namespace aurpp
@@ -3,19 +3,106 @@
 #ifndef AURPP_CLIENT_H_
 #define AURPP_CLIENT_H_
 
+#include <aurpp/cache.h>
+#include <aurpp/connection_state.h>
 #include <aurpp/request.h>
 #include <aurpp/response.h>
+#include <aurpp/scheduler.h>
+#include <aurpp/stream.h>
 #include <curl/curl.h>
 
+#include <algorithm>
+#include <chrono>
 #include <concepts>
+#include <cstddef>
 #include <expected>
+#include <filesystem>
+#include <functional>
+#include <future>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace aurpp {
 
+// A package found by a search across several fields
+struct FieldSearchMatch {
+  AurPackage package;
+  // The fields the package was found by, in the order they were searched
+  std::vector<SearchRequest::SearchBy> fields;
+};
+
+// How a transfer that reached the server went. Times are measured from the
+// start of the transfer, as curl does, so every phase ends where the next
+// one begins. A reused connection skips the name lookup, connect and TLS
+// phases, whose times are then zero.
+struct TransferInfo {
+  std::string url;
+  // The protocol the response arrived over, like "HTTP/2"
+  std::string_view http_version;
+  // When the host name was resolved
+  std::chrono::microseconds name_lookup_time{};
+  // When the TCP connection or QUIC handshake was established
+  std::chrono::microseconds connect_time{};
+  // When the TLS handshake completed, zero for plain HTTP
+  std::chrono::microseconds tls_time{};
+  // When the first byte of the response arrived
+  std::chrono::microseconds start_transfer_time{};
+  std::chrono::microseconds total_time{};
+  // The size of the body as it was sent, before it was decompressed
+  std::size_t downloaded_bytes = 0;
+  bool reused_connection = false;
+};
+
 namespace detail {
 
+// The most capable HTTP version curl was built with, given the features of
+// curl_version_info(). HTTP/3 falls back to HTTP/2 or HTTP/1.1 when the
+// QUIC handshake fails, and HTTP/2 falls back to HTTP/1.1 when the server
+// doesn't negotiate it.
+constexpr long PreferredHttpVersion(const int features) {
+  if ((features & CURL_VERSION_HTTP3) != 0) {
+    return CURL_HTTP_VERSION_3;
+  } else if ((features & CURL_VERSION_HTTP2) != 0) {
+    return CURL_HTTP_VERSION_2TLS;
+  } else {
+    return CURL_HTTP_VERSION_1_1;
+  }
+}
+
+// Names a CURLINFO_HTTP_VERSION value
+constexpr std::string_view HttpVersionName(const long http_version) {
+  switch (http_version) {
+    case CURL_HTTP_VERSION_1_0:
+      return "HTTP/1.0";
+    case CURL_HTTP_VERSION_1_1:
+      return "HTTP/1.1";
+    case CURL_HTTP_VERSION_2_0:
+      return "HTTP/2";
+    case CURL_HTTP_VERSION_3:
+      return "HTTP/3";
+    default:
+      return "unknown";
+  }
+}
+
+// The host name in url, or empty for a URL without one or with an IPv6
+// address
+constexpr std::string_view UrlHost(const std::string_view url) {
+  const std::size_t scheme_end = url.find("://");
+  if (scheme_end == std::string_view::npos) {
+    return {};
+  }
+  const std::string_view rest = url.substr(scheme_end + 3);
+  if (rest.starts_with('[')) {
+    return {};
+  }
+  return rest.substr(0, rest.find_first_of(":/?#"));
+}
+
 constexpr std::size_t WriteCallback(void *contents, const std::size_t size,
                                     const std::size_t nmemb, void *userp) {
   const std::size_t total_size = size * nmemb;
@@ -24,21 +111,31 @@ constexpr std::size_t WriteCallback(void *contents, const std::size_t size,
   return total_size;
 }
 
+// Merges the responses of searching every field for every term, stored term
+// by term with one response per field. A package matches when some field
+// matches each term. Matches are deduplicated by ID and ordered by their
+// first appearance for the first term.
+std::vector<FieldSearchMatch> MergeFieldSearches(
+    std::span<const SearchRequest::SearchBy> fields,
+    std::span<const RpcResponse> responses);
+
+// Returns fields without duplicates, keeping the first occurrence of each
+std::vector<SearchRequest::SearchBy> UniqueFields(
+    std::span<const SearchRequest::SearchBy> fields);
+
 }  // namespace detail
 
-// TODO: rewrite this using curl's multi interface.
 class Client {
  public:
-  explicit Client(std::string base_url = "https://aur.archlinux.org")
-      : curl_handle_{curl_easy_init(), curl_easy_cleanup},
-        base_url_(std::move(base_url)) {
-    if (curl_handle_) {
-      curl_easy_setopt(curl_handle_.get(), CURLOPT_HTTP_VERSION,
-                       CURL_HTTP_VERSION_3);
-      curl_easy_setopt(curl_handle_.get(), CURLOPT_FOLLOWLOCATION, 1L);
-      curl_easy_setopt(curl_handle_.get(), CURLOPT_USERAGENT, "yarp/1.0");
-    }
-  }
+  static constexpr std::size_t kDefaultMaxConcurrentRequests = 8;
+  static constexpr std::size_t kDefaultInfoChunkSize = 150;
+
+  explicit Client(std::string base_url = "https://aur.archlinux.org");
+
+  // Uses share instead of a share handle of its own. share must outlive the
+  // client, and needs lock functions when clients using it run on different
+  // threads, see ClientPool.
+  Client(std::string base_url, CURLSH *share);
 
   Client(const Client &) = delete;
   Client &operator=(const Client &) = delete;
@@ -46,61 +143,174 @@ class Client {
   Client(Client &&) = delete;
   Client &operator=(Client &&) = delete;
 
+  // Saves the connection state, see EnableConnectionState
+  ~Client();
+
   template <typename RequestType, typename ResponseType>
     requires std::derived_from<RequestType, HttpRequest>
   std::expected<ResponseType, std::string> Execute(const RequestType &request);
 
+  // Passes every package in the response to on_package as soon as its bytes
+  // have arrived, instead of waiting for the whole response, and returns the
+  // number of packages. Packages received before a failed transfer have
+  // already been passed on when the error is returned. The body isn't kept,
+  // so a streamed response is answered from and revalidated against the
+  // cache, but never stored in it; Execute stores the same request.
+  std::expected<std::size_t, std::string> ExecuteStreaming(
+      const RpcRequest &request, RpcResponseStream::PackageCallback on_package);
+
+  // Runs all requests concurrently using curl's multi interface, with at most
+  // max_concurrent_requests() transfers in flight at any time. The results
+  // are returned in the same order as the requests.
+  template <typename RequestType, typename ResponseType>
+    requires std::derived_from<RequestType, HttpRequest>
+  std::vector<std::expected<ResponseType, std::string>> ExecuteMany(
+      std::span<const RequestType> requests);
+
+  // Looks up every package in names, splitting the lookup into InfoRequests
+  // of at most info_chunk_size() names that are executed concurrently. The
+  // packages of all chunks are merged into one response, ordered like names.
+  std::expected<RpcResponse, std::string> ExecuteInfo(
+      std::span<const std::string> names);
+
+  // Searches every field in fields for every term and reports the fields
+  // each package was found by. A package matches when each term matches at
+  // least one of the fields. All requests run concurrently.
+  std::expected<std::vector<FieldSearchMatch>, std::string> ExecuteFieldSearch(
+      std::span<const SearchRequest::SearchBy> fields,
+      std::span<const std::string> terms);
+
+  // Starts ExecuteFieldSearch on another thread and returns its result as a
+  // future, so the caller can do other work while the requests are in
+  // flight. The client must not be used again until the future is ready.
+  std::future<std::expected<std::vector<FieldSearchMatch>, std::string>>
+  ExecuteFieldSearchAsync(std::vector<SearchRequest::SearchBy> fields,
+                          std::vector<std::string> terms);
+
+  // Answers requests from an on-disk cache under directory while the cached
+  // response is fresh, and revalidates stale responses with the server when
+  // it sent an ETag or Last-Modified header.
+  void EnableCache(std::filesystem::path directory);
+
+  // Keeps connection state under directory so later processes start warm:
+  // curl's Alt-Svc and HSTS caches, which let them go straight to HTTP/3 and
+  // HTTPS, the addresses hosts resolved to, and TLS sessions to resume. The
+  // state is saved when the client is destroyed.
+  void EnableConnectionState(std::filesystem::path directory);
+
+  [[nodiscard]] ResponseCache *cache() const noexcept { return cache_.get(); }
+
+  // Lets scheduler decide when requests start, which retries transient
+  // failures, hedges slow requests and shares the transfers of identical
+  // requests with other clients using the same scheduler. Without one,
+  // every request is attempted once, as soon as possible. Streamed
+  // responses are only retried when the server answered with an error.
+  void set_scheduler(std::shared_ptr<RequestScheduler> scheduler) {
+    scheduler_ = std::move(scheduler);
+  }
+
+  // Calls observer after every transfer that reached the server, e.g. to
+  // show which protocol was used and whether the connection was reused
+  void set_transfer_observer(
+      std::function<void(const TransferInfo &)> observer) {
+    transfer_observer_ = std::move(observer);
+  }
+
+  [[nodiscard]] constexpr std::size_t max_concurrent_requests()
+      const noexcept {
+    return max_concurrent_requests_;
+  }
+
+  constexpr void set_max_concurrent_requests(
+      const std::size_t max_concurrent_requests) noexcept {
+    max_concurrent_requests_ =
+        std::max<std::size_t>(max_concurrent_requests, 1);
+  }
+
+  [[nodiscard]] constexpr std::size_t info_chunk_size() const noexcept {
+    return info_chunk_size_;
+  }
+
+  constexpr void set_info_chunk_size(
+      const std::size_t info_chunk_size) noexcept {
+    info_chunk_size_ = std::max<std::size_t>(info_chunk_size, 1);
+  }
+
  private:
+  // With a stream, the body is parsed while it is received. The returned body
+  // is then empty unless the response is cached.
+  [[nodiscard]] std::expected<std::string, std::string> Perform(
+      const HttpRequest &request, RpcResponseStream *stream = nullptr);
+
+  [[nodiscard]] std::vector<std::expected<std::string, std::string>>
+  PerformMany(std::span<const HttpRequest *const> requests);
+
+  // Called once a transfer completed successfully
+  void RecordTransfer(CURL *handle);
+
+  // Blocks until the scheduler lets a request start
+  void WaitToStart();
+
+  // Returns how long to wait before retrying a request that failed attempts
+  // times with the given Retry-After header, or nullopt to give up
+  [[nodiscard]] std::optional<RequestScheduler::Clock::duration> RetryDelay(
+      int attempts, std::string_view retry_after);
+
+  void SaveConnectionState();
+
+  // Holds the connection pool, DNS cache and TLS sessions of every handle,
+  // so single requests and concurrent batches reuse the same connections.
+  // Declared first so that it outlives the handles that use it, like the
+  // resolve list. Null when the client was given a share.
+  std::unique_ptr<CURLSH, decltype(&curl_share_cleanup)> share_handle_;
+  // The share every handle uses, owned or not
+  CURLSH *share_ = nullptr;
+  std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)> resolve_list_{
+      nullptr, curl_slist_free_all};
   std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> curl_handle_;
+  std::unique_ptr<CURLM, decltype(&curl_multi_cleanup)> multi_handle_;
   std::string base_url_;
+  std::unique_ptr<ResponseCache> cache_;
+  std::size_t max_concurrent_requests_ = kDefaultMaxConcurrentRequests;
+  std::size_t info_chunk_size_ = kDefaultInfoChunkSize;
+  std::function<void(const TransferInfo &)> transfer_observer_;
+  std::shared_ptr<RequestScheduler> scheduler_;
+  std::filesystem::path connection_state_dir_;
+  ConnectionState connection_state_;
 };
 
 template <typename RequestType, typename ResponseType>
   requires std::derived_from<RequestType, HttpRequest>
 std::expected<ResponseType, std::string> Client::Execute(
     const RequestType &request) {
-  if (!curl_handle_) {
-    return std::unexpected{"CURL handle not initialized"};
-  }
-
-  std::string response_data{};
-  const std::string url = request.Url(base_url_);
-
-  curl_easy_setopt(curl_handle_.get(), CURLOPT_URL, url.c_str());
-  curl_easy_setopt(curl_handle_.get(), CURLOPT_WRITEFUNCTION,
-                   detail::WriteCallback);
-  curl_easy_setopt(curl_handle_.get(), CURLOPT_WRITEDATA, &response_data);
-
-  switch (request.command()) {
-    case HttpRequest::Command::kGet: {
-      curl_easy_setopt(curl_handle_.get(), CURLOPT_HTTPGET, 1L);
-      break;
-    }
-    case HttpRequest::Command::kPost: {
-      const std::string payload = request.Payload();
-      curl_easy_setopt(curl_handle_.get(), CURLOPT_POST, 1L);
-      curl_easy_setopt(curl_handle_.get(), CURLOPT_POSTFIELDS, payload.c_str());
-      curl_easy_setopt(curl_handle_.get(), CURLOPT_POSTFIELDSIZE,
-                       payload.size());
-      break;
-    }
-    default:
-      std::unreachable();
+  std::expected<std::string, std::string> body = Perform(request);
+  if (!body.has_value()) {
+    return std::unexpected{std::move(body.error())};
   }
+  return ResponseType::Parse(std::move(body.value()));
+}
 
-  if (const CURLcode res = curl_easy_perform(curl_handle_.get());
-      res != CURLE_OK) {
-    return std::unexpected{
-        std::format("CURL error: {}", curl_easy_strerror(res))};
+template <typename RequestType, typename ResponseType>
+  requires std::derived_from<RequestType, HttpRequest>
+std::vector<std::expected<ResponseType, std::string>> Client::ExecuteMany(
+    std::span<const RequestType> requests) {
+  std::vector<const HttpRequest *> request_ptrs;
+  request_ptrs.reserve(requests.size());
+  for (const RequestType &request : requests) {
+    request_ptrs.push_back(&request);
   }
 
-  long http_code = 0;
-  curl_easy_getinfo(curl_handle_.get(), CURLINFO_RESPONSE_CODE, &http_code);
-  if (http_code != 200) {
-    return std::unexpected{std::format("HTTP error: {}", http_code)};
+  std::vector<std::expected<ResponseType, std::string>> results;
+  results.reserve(requests.size());
+  for (std::expected<std::string, std::string> &body :
+       PerformMany(request_ptrs)) {
+    if (body.has_value()) {
+      results.push_back(ResponseType::Parse(std::move(body.value())));
+    } else {
+      results.push_back(std::unexpected{std::move(body.error())});
+    }
   }
-
-  return ResponseType::Parse(response_data);
+  return results;
 }
 
 }  // namespace aurpp
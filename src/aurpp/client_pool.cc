@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: MIT
+
+#include <aurpp/client_pool.h>
+
+#include <utility>
+
+namespace aurpp {
+
+ClientPool::Lease &ClientPool::Lease::operator=(Lease &&other) noexcept {
+  if (this != &other) {
+    if (client_) {
+      pool_->Release(std::move(client_));
+    }
+    pool_ = other.pool_;
+    client_ = std::move(other.client_);
+  }
+  return *this;
+}
+
+ClientPool::Lease::~Lease() {
+  if (client_) {
+    pool_->Release(std::move(client_));
+  }
+}
+
+ClientPool::ClientPool(std::string base_url)
+    : share_handle_{curl_share_init(), curl_share_cleanup},
+      base_url_(std::move(base_url)) {
+  if (share_handle_) {
+    curl_share_setopt(share_handle_.get(), CURLSHOPT_LOCKFUNC, LockShare);
+    curl_share_setopt(share_handle_.get(), CURLSHOPT_UNLOCKFUNC, UnlockShare);
+    curl_share_setopt(share_handle_.get(), CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share_handle_.get(), CURLSHOPT_SHARE,
+                      CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_handle_.get(), CURLSHOPT_SHARE,
+                      CURL_LOCK_DATA_SSL_SESSION);
+  }
+}
+
+ClientPool::~ClientPool() {
+  // The clients must go before the share they use
+  idle_.clear();
+}
+
+ClientPool::Lease ClientPool::Acquire() {
+  {
+    std::lock_guard lock{mutex_};
+    if (!idle_.empty()) {
+      std::unique_ptr<Client> client = std::move(idle_.back());
+      idle_.pop_back();
+      return Lease{this, std::move(client)};
+    }
+    ++size_;
+  }
+
+  // Created outside the lock, since setting up a client opens its cache
+  auto client = std::make_unique<Client>(base_url_, share_handle_.get());
+  if (!cache_dir_.empty()) {
+    client->EnableCache(cache_dir_);
+  }
+  client->set_scheduler(scheduler_);
+  return Lease{this, std::move(client)};
+}
+
+void ClientPool::EnableCache(std::filesystem::path directory) {
+  cache_dir_ = std::move(directory);
+}
+
+std::size_t ClientPool::size() const {
+  std::lock_guard lock{mutex_};
+  return size_;
+}
+
+void ClientPool::Release(std::unique_ptr<Client> client) {
+  std::lock_guard lock{mutex_};
+  idle_.push_back(std::move(client));
+}
+
+void ClientPool::LockShare(CURL *, const curl_lock_data data,
+                           curl_lock_access, void *userptr) {
+  static_cast<ClientPool *>(userptr)->share_locks_.at(data).lock();
+}
+
+void ClientPool::UnlockShare(CURL *, const curl_lock_data data,
+                             void *userptr) {
+  static_cast<ClientPool *>(userptr)->share_locks_.at(data).unlock();
+}
+
+}  // namespace aurpp
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef AURPP_CLIENT_POOL_H_
+#define AURPP_CLIENT_POOL_H_
+
+#include <aurpp/client.h>
+#include <aurpp/scheduler.h>
+#include <curl/curl.h>
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace aurpp {
+
+// Hands out Clients to threads that run requests in parallel. The clients
+// share one DNS cache and one TLS session cache, so a host is resolved once
+// and later handshakes resume the first one. Connections are not shared:
+// curl doesn't support using a shared connection cache from concurrent
+// threads. Instead a client goes back to the pool with its connections
+// intact, and the next thread to acquire it reuses them.
+class ClientPool {
+ public:
+  // A client acquired from the pool, returned to it on destruction. Only
+  // the thread holding the lease may use the client.
+  class Lease {
+   public:
+    Lease(Lease &&) noexcept = default;
+    Lease &operator=(Lease &&other) noexcept;
+
+    Lease(const Lease &) = delete;
+    Lease &operator=(const Lease &) = delete;
+
+    ~Lease();
+
+    Client &operator*() const noexcept { return *client_; }
+    Client *operator->() const noexcept { return client_.get(); }
+
+   private:
+    friend class ClientPool;
+
+    Lease(ClientPool *pool, std::unique_ptr<Client> client)
+        : pool_(pool), client_(std::move(client)) {}
+
+    ClientPool *pool_;
+    std::unique_ptr<Client> client_;
+  };
+
+  explicit ClientPool(std::string base_url = "https://aur.archlinux.org");
+
+  ClientPool(const ClientPool &) = delete;
+  ClientPool &operator=(const ClientPool &) = delete;
+
+  ClientPool(ClientPool &&) = delete;
+  ClientPool &operator=(ClientPool &&) = delete;
+
+  // Every lease must have been returned
+  ~ClientPool();
+
+  // Returns an idle client, or a new one if every client is leased. Safe to
+  // call from any thread.
+  [[nodiscard]] Lease Acquire();
+
+  // Makes every client answer requests from the on-disk cache under
+  // directory, see Client::EnableCache. Must be called before the first
+  // Acquire.
+  void EnableCache(std::filesystem::path directory);
+
+  // Gives every client scheduler, see Client::set_scheduler. Sharing one
+  // scheduler keeps the pool within one rate limit and lets threads share
+  // the transfers of identical requests. Must be called before the first
+  // Acquire.
+  void set_scheduler(std::shared_ptr<RequestScheduler> scheduler) {
+    scheduler_ = std::move(scheduler);
+  }
+
+  // The number of clients created so far
+  [[nodiscard]] std::size_t size() const;
+
+ private:
+  void Release(std::unique_ptr<Client> client);
+
+  static void LockShare(CURL *handle, curl_lock_data data,
+                        curl_lock_access access, void *userptr);
+  static void UnlockShare(CURL *handle, curl_lock_data data, void *userptr);
+
+  // One lock per kind of shared data, so resolving a name doesn't wait for a
+  // TLS session to be stored
+  std::array<std::mutex, CURL_LOCK_DATA_LAST> share_locks_;
+  // Declared after the locks it uses and before the clients that use it
+  std::unique_ptr<CURLSH, decltype(&curl_share_cleanup)> share_handle_;
+  std::string base_url_;
+  std::filesystem::path cache_dir_;
+  std::shared_ptr<RequestScheduler> scheduler_;
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Client>> idle_;
+  std::size_t size_ = 0;
+};
+
+}  // namespace aurpp
+
+#endif  // AURPP_CLIENT_POOL_H_
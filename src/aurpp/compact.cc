@@ -0,0 +1,366 @@
+// SPDX-License-Identifier: MIT
+
+#include <aurpp/compact.h>
+
+#include <aurpp/decoder.h>
+
+#include <format>
+#include <functional>
+#include <utility>
+
+namespace {
+
+using aurpp::detail::CompactStorage;
+using aurpp::detail::JsonCursor;
+using aurpp::detail::ListRef;
+using aurpp::detail::PackageRecord;
+using aurpp::detail::RpcField;
+using aurpp::detail::StringRef;
+
+constexpr std::size_t kMaxArenaSize = StringRef::kAbsent;
+
+// Decodes packages into a CompactStorage. Identical strings, such as common
+// dependencies and licenses, are stored in the arena only once.
+class CompactBuilder {
+ public:
+  explicit CompactBuilder(CompactStorage *storage)
+      : storage_(storage), slots_(kInitialSlots) {}
+
+  std::expected<void, std::string> DecodePackage(JsonCursor &cursor);
+
+ private:
+  static constexpr std::size_t kInitialSlots = 1024;
+
+  std::optional<StringRef> Intern(std::string_view value);
+  void GrowSlots();
+
+  bool ReadString(JsonCursor &cursor, StringRef &out, bool nullable);
+  bool ReadStringList(JsonCursor &cursor, ListRef &out);
+
+  template <typename T>
+  bool ReadNumber(JsonCursor &cursor, T &out) {
+    if (cursor.Null()) {
+      return true;
+    }
+    const std::optional<std::string_view> text = cursor.Number();
+    return text.has_value() && aurpp::detail::ParseNumber(text.value(), out);
+  }
+
+  [[nodiscard]] std::string_view View(const StringRef ref) const {
+    return std::string_view{storage_->arena}.substr(ref.offset, ref.size);
+  }
+
+  CompactStorage *storage_;
+  // Open addressing hash table of the interned strings. Unused slots hold an
+  // absent StringRef.
+  std::vector<StringRef> slots_;
+  std::size_t interned_ = 0;
+};
+
+std::optional<StringRef> CompactBuilder::Intern(const std::string_view value) {
+  // Keep the load factor below one half so probe sequences stay short
+  if ((interned_ + 1) * 2 > slots_.size()) {
+    GrowSlots();
+  }
+
+  const std::size_t mask = slots_.size() - 1;
+  std::size_t slot = std::hash<std::string_view>{}(value) & mask;
+  while (slots_[slot].has_value()) {
+    if (View(slots_[slot]) == value) {
+      return slots_[slot];
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  if (storage_->arena.size() + value.size() >= kMaxArenaSize) {
+    return std::nullopt;
+  }
+  const StringRef ref{static_cast<std::uint32_t>(storage_->arena.size()),
+                      static_cast<std::uint32_t>(value.size())};
+  storage_->arena.append(value);
+  slots_[slot] = ref;
+  ++interned_;
+  return ref;
+}
+
+void CompactBuilder::GrowSlots() {
+  std::vector<StringRef> old_slots(slots_.size() * 2);
+  old_slots.swap(slots_);
+
+  const std::size_t mask = slots_.size() - 1;
+  for (const StringRef ref : old_slots) {
+    if (!ref.has_value()) {
+      continue;
+    }
+    std::size_t slot = std::hash<std::string_view>{}(View(ref)) & mask;
+    while (slots_[slot].has_value()) {
+      slot = (slot + 1) & mask;
+    }
+    slots_[slot] = ref;
+  }
+}
+
+bool CompactBuilder::ReadString(JsonCursor &cursor, StringRef &out,
+                                const bool nullable) {
+  if (cursor.Null()) {
+    // Like AurPackage, a null required string reads as an empty string
+    out = nullable ? StringRef{} : StringRef{0, 0};
+    return true;
+  }
+  const std::optional<std::string_view> value = cursor.String();
+  if (!value.has_value()) {
+    return false;
+  }
+  const std::optional<StringRef> ref = Intern(value.value());
+  if (!ref.has_value()) {
+    return false;
+  }
+  out = ref.value();
+  return true;
+}
+
+bool CompactBuilder::ReadStringList(JsonCursor &cursor, ListRef &out) {
+  if (cursor.Null()) {
+    out = ListRef{};
+    return true;
+  }
+  if (!cursor.Consume('[')) {
+    return false;
+  }
+
+  // Lists never nest, so the items of one list are always contiguous
+  std::vector<StringRef> &items = storage_->list_items;
+  out = ListRef{static_cast<std::uint32_t>(items.size()), 0};
+  if (cursor.Consume(']')) {
+    return true;
+  }
+  do {
+    const std::optional<std::string_view> value = cursor.String();
+    if (!value.has_value()) {
+      return false;
+    }
+    const std::optional<StringRef> ref = Intern(value.value());
+    if (!ref.has_value()) {
+      return false;
+    }
+    items.push_back(ref.value());
+    ++out.size;
+  } while (cursor.Consume(','));
+  return cursor.Consume(']');
+}
+
+std::expected<void, std::string> CompactBuilder::DecodePackage(
+    JsonCursor &cursor) {
+  if (!cursor.Consume('{')) {
+    return std::unexpected{cursor.Error("Expected a package object")};
+  }
+
+  PackageRecord &record = storage_->records.emplace_back();
+  // Required strings default to empty rather than absent
+  record.name = record.version = record.package_base = StringRef{0, 0};
+  if (cursor.Consume('}')) {
+    return {};
+  }
+
+  do {
+    const std::optional<std::string_view> key = cursor.String();
+    if (!key.has_value() || !cursor.Consume(':')) {
+      return std::unexpected{cursor.Error("Expected a field name")};
+    }
+
+    const RpcField field = aurpp::detail::LookupRpcField(key.value());
+    bool valid = false;
+    switch (field) {
+      case RpcField::kName:
+        valid = ReadString(cursor, record.name, false);
+        break;
+      case RpcField::kVersion:
+        valid = ReadString(cursor, record.version, false);
+        break;
+      case RpcField::kDescription:
+        valid = ReadString(cursor, record.description, true);
+        break;
+      case RpcField::kMaintainer:
+        valid = ReadString(cursor, record.maintainer, true);
+        break;
+      case RpcField::kUrl:
+        valid = ReadString(cursor, record.url, true);
+        break;
+      case RpcField::kNumVotes:
+        valid = ReadNumber(cursor, record.num_votes);
+        break;
+      case RpcField::kPopularity:
+        valid = ReadNumber(cursor, record.popularity);
+        break;
+      case RpcField::kOutOfDate:
+        record.has_out_of_date = !cursor.Null();
+        valid = !record.has_out_of_date ||
+                ReadNumber(cursor, record.out_of_date);
+        break;
+      case RpcField::kPackageBase:
+        valid = ReadString(cursor, record.package_base, false);
+        break;
+      case RpcField::kPackageBaseId:
+        valid = ReadNumber(cursor, record.package_base_id);
+        break;
+      case RpcField::kFirstSubmitted:
+        valid = ReadNumber(cursor, record.first_submitted);
+        break;
+      case RpcField::kLastModified:
+        valid = ReadNumber(cursor, record.last_modified);
+        break;
+      case RpcField::kUrlPath:
+        valid = ReadString(cursor, record.url_path, true);
+        break;
+      case RpcField::kId:
+        valid = ReadNumber(cursor, record.id);
+        break;
+      case RpcField::kDepends:
+        valid = ReadStringList(cursor, record.depends);
+        break;
+      case RpcField::kMakeDepends:
+        valid = ReadStringList(cursor, record.make_depends);
+        break;
+      case RpcField::kOptDepends:
+        valid = ReadStringList(cursor, record.opt_depends);
+        break;
+      case RpcField::kCheckDepends:
+        valid = ReadStringList(cursor, record.check_depends);
+        break;
+      case RpcField::kConflicts:
+        valid = ReadStringList(cursor, record.conflicts);
+        break;
+      case RpcField::kProvides:
+        valid = ReadStringList(cursor, record.provides);
+        break;
+      case RpcField::kReplaces:
+        valid = ReadStringList(cursor, record.replaces);
+        break;
+      case RpcField::kGroups:
+        valid = ReadStringList(cursor, record.groups);
+        break;
+      case RpcField::kLicense:
+        valid = ReadStringList(cursor, record.license);
+        break;
+      case RpcField::kKeywords:
+        valid = ReadStringList(cursor, record.keywords);
+        break;
+      case RpcField::kUnknown:
+        valid = cursor.SkipValue();
+        break;
+    }
+
+    if (!valid) {
+      return std::unexpected{cursor.Error(
+          field == RpcField::kUnknown
+              ? std::string{"Invalid value"}
+              : std::format("Invalid value for {}",
+                            aurpp::detail::RpcFieldName(field)))};
+    }
+  } while (cursor.Consume(','));
+
+  if (!cursor.Consume('}')) {
+    return std::unexpected{cursor.Error("Expected ',' or '}'")};
+  }
+  return {};
+}
+
+template <typename List>
+std::optional<std::vector<std::string>> ToVector(
+    const std::optional<List> &list) {
+  if (!list.has_value()) {
+    return std::nullopt;
+  }
+  return std::vector<std::string>(list->begin(), list->end());
+}
+
+}  // namespace
+
+namespace aurpp {
+
+AurPackage CompactPackage::ToAurPackage() const {
+  AurPackage pkg{};
+  pkg.set_name(name());
+  pkg.set_version(version());
+  if (const auto value = description()) {
+    pkg.set_description(*value);
+  }
+  if (const auto value = maintainer()) {
+    pkg.set_maintainer(*value);
+  }
+  if (const auto value = url()) {
+    pkg.set_url(*value);
+  }
+  pkg.set_num_votes(num_votes());
+  pkg.set_popularity(popularity());
+  if (const auto value = out_of_date()) {
+    pkg.set_out_of_date(*value);
+  }
+  pkg.set_package_base(package_base());
+  pkg.set_package_base_id(package_base_id());
+  pkg.set_first_submitted(first_submitted());
+  pkg.set_last_modified(last_modified());
+  if (const auto value = url_path()) {
+    pkg.set_url_path(*value);
+  }
+  pkg.set_id(id());
+
+  if (auto list = ToVector(depends())) {
+    pkg.set_depends(std::move(*list));
+  }
+  if (auto list = ToVector(make_depends())) {
+    pkg.set_make_depends(std::move(*list));
+  }
+  if (auto list = ToVector(opt_depends())) {
+    pkg.set_opt_depends(std::move(*list));
+  }
+  if (auto list = ToVector(check_depends())) {
+    pkg.set_check_depends(std::move(*list));
+  }
+  if (auto list = ToVector(conflicts())) {
+    pkg.set_conflicts(std::move(*list));
+  }
+  if (auto list = ToVector(provides())) {
+    pkg.set_provides(std::move(*list));
+  }
+  if (auto list = ToVector(replaces())) {
+    pkg.set_replaces(std::move(*list));
+  }
+  if (auto list = ToVector(groups())) {
+    pkg.set_groups(std::move(*list));
+  }
+  if (auto list = ToVector(license())) {
+    pkg.set_license(std::move(*list));
+  }
+  if (auto list = ToVector(keywords())) {
+    pkg.set_keywords(std::move(*list));
+  }
+  return pkg;
+}
+
+std::expected<CompactRpcResponse, std::string> CompactRpcResponse::Parse(
+    const std::string_view file_contents) {
+  CompactRpcResponse response;
+  CompactBuilder builder{response.storage_.get()};
+
+  const std::expected<std::size_t, std::string> result = detail::DecodeResults(
+      file_contents,
+      [&builder](JsonCursor &cursor) { return builder.DecodePackage(cursor); });
+  if (!result.has_value()) {
+    return std::unexpected{result.error()};
+  }
+
+  // The arena grows geometrically while decoding, return the slack
+  response.storage_->arena.shrink_to_fit();
+  response.storage_->list_items.shrink_to_fit();
+  response.storage_->records.shrink_to_fit();
+  return response;
+}
+
+std::size_t CompactRpcResponse::memory_usage() const noexcept {
+  return storage_->arena.capacity() +
+         storage_->list_items.capacity() * sizeof(detail::StringRef) +
+         storage_->records.capacity() * sizeof(detail::PackageRecord);
+}
+
+}  // namespace aurpp
@@ -0,0 +1,297 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef AURPP_COMPACT_H_
+#define AURPP_COMPACT_H_
+
+#include <aurpp/package.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace aurpp {
+
+namespace detail {
+
+// A string in the arena of a CompactRpcResponse
+struct StringRef {
+  static constexpr std::uint32_t kAbsent =
+      std::numeric_limits<std::uint32_t>::max();
+
+  [[nodiscard]] constexpr bool has_value() const noexcept {
+    return offset != kAbsent;
+  }
+
+  std::uint32_t offset = kAbsent;
+  std::uint32_t size = 0;
+};
+
+// A range of strings in the list pool of a CompactRpcResponse
+struct ListRef {
+  [[nodiscard]] constexpr bool has_value() const noexcept {
+    return first != StringRef::kAbsent;
+  }
+
+  std::uint32_t first = StringRef::kAbsent;
+  std::uint32_t size = 0;
+};
+
+// The fixed size part of a package. Everything variable sized lives in the
+// arena and list pool it refers to.
+struct PackageRecord {
+  StringRef name;
+  StringRef version;
+  StringRef description;
+  StringRef maintainer;
+  StringRef url;
+  StringRef package_base;
+  StringRef url_path;
+  ListRef depends;
+  ListRef make_depends;
+  ListRef opt_depends;
+  ListRef check_depends;
+  ListRef conflicts;
+  ListRef provides;
+  ListRef replaces;
+  ListRef groups;
+  ListRef license;
+  ListRef keywords;
+  double popularity{};
+  std::uint64_t out_of_date{};
+  int num_votes{};
+  int package_base_id{};
+  int first_submitted{};
+  int last_modified{};
+  int id{};
+  bool has_out_of_date = false;
+};
+
+struct CompactStorage {
+  // Every distinct string of the response, back to back
+  std::string arena;
+  std::vector<StringRef> list_items;
+  std::vector<PackageRecord> records;
+};
+
+class StringResolver {
+ public:
+  constexpr explicit StringResolver(const CompactStorage *storage) noexcept
+      : storage_(storage) {}
+
+  [[nodiscard]] constexpr std::string_view operator()(
+      const StringRef ref) const noexcept {
+    return std::string_view{storage_->arena}.substr(ref.offset, ref.size);
+  }
+
+ private:
+  const CompactStorage *storage_;
+};
+
+}  // namespace detail
+
+// A view of one package in a CompactRpcResponse. It stays valid for as long
+// as the response it came from, including across moves of the response.
+class CompactPackage {
+ public:
+  using StringList =
+      std::ranges::transform_view<std::span<const detail::StringRef>,
+                                  detail::StringResolver>;
+
+  [[nodiscard]] constexpr std::string_view name() const noexcept {
+    return String(record_->name);
+  }
+
+  [[nodiscard]] constexpr std::string_view version() const noexcept {
+    return String(record_->version);
+  }
+
+  [[nodiscard]] constexpr std::optional<std::string_view> description()
+      const noexcept {
+    return OptionalString(record_->description);
+  }
+
+  [[nodiscard]] constexpr std::optional<std::string_view> maintainer()
+      const noexcept {
+    return OptionalString(record_->maintainer);
+  }
+
+  [[nodiscard]] constexpr std::optional<std::string_view> url() const noexcept {
+    return OptionalString(record_->url);
+  }
+
+  [[nodiscard]] constexpr int num_votes() const noexcept {
+    return record_->num_votes;
+  }
+
+  [[nodiscard]] constexpr double popularity() const noexcept {
+    return record_->popularity;
+  }
+
+  [[nodiscard]] constexpr std::optional<std::uint64_t> out_of_date()
+      const noexcept {
+    if (!record_->has_out_of_date) {
+      return std::nullopt;
+    }
+    return record_->out_of_date;
+  }
+
+  [[nodiscard]] constexpr std::string_view package_base() const noexcept {
+    return String(record_->package_base);
+  }
+
+  [[nodiscard]] constexpr int package_base_id() const noexcept {
+    return record_->package_base_id;
+  }
+
+  [[nodiscard]] constexpr int first_submitted() const noexcept {
+    return record_->first_submitted;
+  }
+
+  [[nodiscard]] constexpr int last_modified() const noexcept {
+    return record_->last_modified;
+  }
+
+  [[nodiscard]] constexpr std::optional<std::string_view> url_path()
+      const noexcept {
+    return OptionalString(record_->url_path);
+  }
+
+  [[nodiscard]] constexpr int id() const noexcept { return record_->id; }
+
+  [[nodiscard]] constexpr std::optional<StringList> depends() const noexcept {
+    return List(record_->depends);
+  }
+
+  [[nodiscard]] constexpr std::optional<StringList> make_depends()
+      const noexcept {
+    return List(record_->make_depends);
+  }
+
+  [[nodiscard]] constexpr std::optional<StringList> opt_depends()
+      const noexcept {
+    return List(record_->opt_depends);
+  }
+
+  [[nodiscard]] constexpr std::optional<StringList> check_depends()
+      const noexcept {
+    return List(record_->check_depends);
+  }
+
+  [[nodiscard]] constexpr std::optional<StringList> conflicts()
+      const noexcept {
+    return List(record_->conflicts);
+  }
+
+  [[nodiscard]] constexpr std::optional<StringList> provides() const noexcept {
+    return List(record_->provides);
+  }
+
+  [[nodiscard]] constexpr std::optional<StringList> replaces() const noexcept {
+    return List(record_->replaces);
+  }
+
+  [[nodiscard]] constexpr std::optional<StringList> groups() const noexcept {
+    return List(record_->groups);
+  }
+
+  [[nodiscard]] constexpr std::optional<StringList> license() const noexcept {
+    return List(record_->license);
+  }
+
+  [[nodiscard]] constexpr std::optional<StringList> keywords() const noexcept {
+    return List(record_->keywords);
+  }
+
+  // Copies the package out of the arena
+  [[nodiscard]] AurPackage ToAurPackage() const;
+
+ private:
+  friend class CompactRpcResponse;
+
+  constexpr CompactPackage(const detail::CompactStorage *storage,
+                           const detail::PackageRecord *record) noexcept
+      : storage_(storage), record_(record) {}
+
+  [[nodiscard]] constexpr std::string_view String(
+      const detail::StringRef ref) const noexcept {
+    return detail::StringResolver{storage_}(ref);
+  }
+
+  [[nodiscard]] constexpr std::optional<std::string_view> OptionalString(
+      const detail::StringRef ref) const noexcept {
+    if (!ref.has_value()) {
+      return std::nullopt;
+    }
+    return String(ref);
+  }
+
+  [[nodiscard]] constexpr std::optional<StringList> List(
+      const detail::ListRef ref) const noexcept {
+    if (!ref.has_value()) {
+      return std::nullopt;
+    }
+    const std::span<const detail::StringRef> items =
+        std::span{storage_->list_items}.subspan(ref.first, ref.size);
+    return StringList{items, detail::StringResolver{storage_}};
+  }
+
+  const detail::CompactStorage *storage_;
+  const detail::PackageRecord *record_;
+};
+
+// An RPC response that stores its packages as fixed size records. All strings
+// of the response are interned into one arena and list fields are ranges into
+// a shared pool, so a response takes a handful of allocations regardless of
+// how many packages it holds.
+class CompactRpcResponse {
+ public:
+  static std::expected<CompactRpcResponse, std::string> Parse(
+      std::string_view file_contents);
+
+  CompactRpcResponse()
+      : storage_(std::make_unique<detail::CompactStorage>()) {}
+
+  CompactRpcResponse(const CompactRpcResponse &) = delete;
+  CompactRpcResponse &operator=(const CompactRpcResponse &) = delete;
+
+  CompactRpcResponse(CompactRpcResponse &&) = default;
+  CompactRpcResponse &operator=(CompactRpcResponse &&) = default;
+
+  [[nodiscard]] std::size_t size() const noexcept {
+    return storage_->records.size();
+  }
+
+  [[nodiscard]] bool empty() const noexcept {
+    return storage_->records.empty();
+  }
+
+  [[nodiscard]] CompactPackage operator[](const std::size_t index) const {
+    return CompactPackage{storage_.get(), &storage_->records[index]};
+  }
+
+  [[nodiscard]] auto packages() const {
+    return std::views::iota(std::size_t{0}, size()) |
+           std::views::transform(
+               [storage = storage_.get()](const std::size_t index) {
+                 return CompactPackage{storage, &storage->records[index]};
+               });
+  }
+
+  // The number of bytes allocated for the arena, list pool and records
+  [[nodiscard]] std::size_t memory_usage() const noexcept;
+
+ private:
+  std::unique_ptr<detail::CompactStorage> storage_;
+};
+
+}  // namespace aurpp
+
+#endif  // AURPP_COMPACT_H_
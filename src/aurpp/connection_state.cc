@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: MIT
+
+#include <aurpp/atomic_file.h>
+#include <aurpp/connection_state.h>
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+constexpr std::string_view kMagic = "yarp-connections-v1\n";
+
+}  // namespace
+
+namespace aurpp {
+
+ConnectionState ConnectionState::Load(const std::filesystem::path &path,
+                                      const Clock::time_point now) {
+  std::ifstream file{path, std::ios::binary};
+  if (!file) {
+    return {};
+  }
+
+  std::string magic(kMagic.size(), '\0');
+  if (!file.read(magic.data(), static_cast<std::streamsize>(magic.size())) ||
+      magic != kMagic) {
+    return {};
+  }
+
+  std::size_t address_count = 0;
+  std::size_t session_count = 0;
+  if (!(file >> address_count >> session_count) || file.get() != '\n') {
+    return {};
+  }
+
+  ConnectionState state;
+  for (std::size_t i = 0; i < address_count; ++i) {
+    Address address;
+    Clock::rep resolved_at = 0;
+    if (!(file >> address.host >> address.port >> address.ip >>
+          resolved_at) ||
+        file.get() != '\n') {
+      return {};
+    }
+    address.resolved_at = Clock::time_point{Clock::duration{resolved_at}};
+    state.addresses_.push_back(std::move(address));
+  }
+
+  const auto read_field = [&file](const std::size_t size) {
+    std::string field(size, '\0');
+    file.read(field.data(), static_cast<std::streamsize>(size));
+    return field;
+  };
+
+  for (std::size_t i = 0; i < session_count; ++i) {
+    std::size_t key_size = 0;
+    std::size_t shmac_size = 0;
+    std::size_t data_size = 0;
+    Clock::rep valid_until = 0;
+    if (!(file >> key_size >> shmac_size >> data_size >> valid_until) ||
+        file.get() != '\n') {
+      return {};
+    }
+
+    TlsSession session;
+    session.key = read_field(key_size);
+    session.shmac = read_field(shmac_size);
+    session.data = read_field(data_size);
+    session.valid_until = Clock::time_point{Clock::duration{valid_until}};
+    if (session.valid_until > now) {
+      state.tls_sessions_.push_back(std::move(session));
+    }
+  }
+
+  // A short read means the file was truncated
+  if (!file) {
+    return {};
+  }
+  return state;
+}
+
+bool ConnectionState::Save(const std::filesystem::path &path) const {
+  std::string bytes{kMagic};
+  const auto out = std::back_inserter(bytes);
+  std::format_to(out, "{} {}\n", addresses_.size(), tls_sessions_.size());
+  for (const Address &address : addresses_) {
+    std::format_to(out, "{} {} {} {}\n", address.host, address.port,
+                   address.ip, address.resolved_at.time_since_epoch().count());
+  }
+  for (const TlsSession &session : tls_sessions_) {
+    std::format_to(out, "{} {} {} {}\n", session.key.size(),
+                   session.shmac.size(), session.data.size(),
+                   session.valid_until.time_since_epoch().count());
+    bytes.append(session.key);
+    bytes.append(session.shmac);
+    bytes.append(session.data);
+  }
+  // TLS sessions let whoever reads them resume the user's sessions
+  return WriteFileAtomically(path, bytes, 0600).has_value();
+}
+
+std::vector<std::string> ConnectionState::ResolveEntries(
+    const Clock::time_point now) const {
+  std::vector<std::string> entries;
+  for (const Address &address : addresses_) {
+    if (now - address.resolved_at >= kAddressTtl) {
+      continue;
+    }
+    // IPv6 addresses are bracketed, since they contain the separator
+    if (address.ip.contains(':')) {
+      entries.push_back(std::format("+{}:{}:[{}]", address.host, address.port,
+                                    address.ip));
+    } else {
+      entries.push_back(
+          std::format("+{}:{}:{}", address.host, address.port, address.ip));
+    }
+  }
+  return entries;
+}
+
+void ConnectionState::RecordAddress(const std::string_view host,
+                                    const int port, const std::string_view ip,
+                                    const Clock::time_point now) {
+  // Names and addresses are stored space separated
+  if (host.empty() || ip.empty() || host.contains(' ') || ip.contains(' ')) {
+    return;
+  }
+
+  const auto it = std::ranges::find_if(
+      addresses_, [host, port](const Address &address) {
+        return address.host == host && address.port == port;
+      });
+  if (it == addresses_.end()) {
+    addresses_.push_back({std::string{host}, port, std::string{ip}, now});
+  } else if (it->ip != ip || now - it->resolved_at >= kAddressTtl) {
+    it->ip = ip;
+    it->resolved_at = now;
+  }
+}
+
+void ConnectionState::RecordTlsSession(TlsSession session) {
+  const auto it = std::ranges::find(tls_sessions_, session.key,
+                                    &TlsSession::key);
+  if (it == tls_sessions_.end()) {
+    tls_sessions_.push_back(std::move(session));
+  } else {
+    *it = std::move(session);
+  }
+}
+
+}  // namespace aurpp
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef AURPP_CONNECTION_STATE_H_
+#define AURPP_CONNECTION_STATE_H_
+
+#include <chrono>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace aurpp {
+
+// Connection state that is worth keeping between processes: the addresses
+// hosts resolved to and the TLS sessions that can be resumed. It is stored
+// in a single file that is written like ResponseCache entries, so processes
+// sharing it only ever see a complete file.
+class ConnectionState {
+ public:
+  using Clock = std::chrono::system_clock;
+
+  struct Address {
+    std::string host;
+    int port = 0;
+    std::string ip;
+    Clock::time_point resolved_at;
+  };
+
+  struct TlsSession {
+    // curl's key for the peer the session belongs to
+    std::string key;
+    std::string shmac;
+    std::string data;
+    Clock::time_point valid_until;
+  };
+
+  // How long a resolved address is used without asking DNS again
+  static constexpr std::chrono::seconds kAddressTtl{600};
+
+  // Loads the state saved at path, leaving out sessions that expired before
+  // now. A missing or damaged file yields an empty state.
+  static ConnectionState Load(const std::filesystem::path &path,
+                              Clock::time_point now);
+
+  // Returns false if the state could not be written. A failed write leaves
+  // the previous file intact. The file is only readable by its owner.
+  bool Save(const std::filesystem::path &path) const;
+
+  // Returns CURLOPT_RESOLVE entries for the addresses that are still fresh
+  // at now. The entries are marked to expire from curl's DNS cache like
+  // resolved ones.
+  [[nodiscard]] std::vector<std::string> ResolveEntries(
+      Clock::time_point now) const;
+
+  // Remembers that host:port was reached at ip. An address that is already
+  // known keeps the time it was first resolved, so it is looked up again
+  // once it expires even though every connection used it.
+  void RecordAddress(std::string_view host, int port, std::string_view ip,
+                     Clock::time_point now);
+
+  // Adds session, replacing any session with the same key
+  void RecordTlsSession(TlsSession session);
+
+  [[nodiscard]] std::span<const Address> addresses() const noexcept {
+    return addresses_;
+  }
+
+  [[nodiscard]] std::span<const TlsSession> tls_sessions() const noexcept {
+    return tls_sessions_;
+  }
+
+ private:
+  std::vector<Address> addresses_;
+  std::vector<TlsSession> tls_sessions_;
+};
+
+}  // namespace aurpp
+
+#endif  // AURPP_CONNECTION_STATE_H_
@@ -0,0 +1,517 @@
+// SPDX-License-Identifier: MIT
+
+#include <aurpp/decoder.h>
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <format>
+#include <vector>
+
+namespace {
+
+using aurpp::detail::RpcField;
+
+// Indexed by RpcField
+constexpr std::array<std::string_view, 24> kFieldNames{
+    "Name",        "Version",      "Description",   "Maintainer",
+    "URL",         "NumVotes",     "Popularity",    "OutOfDate",
+    "PackageBase", "PackageBaseID", "FirstSubmitted", "LastModified",
+    "URLPath",     "ID",           "Depends",       "MakeDepends",
+    "OptDepends",  "CheckDepends", "Conflicts",     "Provides",
+    "Replaces",    "Groups",       "License",       "Keywords",
+};
+
+constexpr std::size_t kFieldTableBits = 6;
+constexpr std::size_t kFieldTableSize = std::size_t{1} << kFieldTableBits;
+
+constexpr std::size_t FieldHash(const std::string_view name,
+                                const std::uint32_t seed) {
+  std::uint32_t hash = 2166136261u ^ seed;
+  for (const char c : name) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 16777619u;
+  }
+  // The low bits of FNV-1a only depend on the low bits of the input
+  return hash >> (32 - kFieldTableBits);
+}
+
+// Searches for a seed that maps every field name to a distinct slot, which
+// makes the lookup table below a perfect hash
+consteval std::uint32_t FindFieldSeed() {
+  for (std::uint32_t seed = 0;; ++seed) {
+    std::array<bool, kFieldTableSize> used{};
+    bool collision = false;
+    for (const std::string_view name : kFieldNames) {
+      const std::size_t slot = FieldHash(name, seed);
+      collision = collision || used[slot];
+      used[slot] = true;
+    }
+    if (!collision) {
+      return seed;
+    }
+  }
+}
+
+constexpr std::uint32_t kFieldSeed = FindFieldSeed();
+
+consteval std::array<RpcField, kFieldTableSize> BuildFieldTable() {
+  std::array<RpcField, kFieldTableSize> table{};
+  table.fill(RpcField::kUnknown);
+  for (std::size_t i = 0; i < kFieldNames.size(); ++i) {
+    table[FieldHash(kFieldNames[i], kFieldSeed)] = static_cast<RpcField>(i);
+  }
+  return table;
+}
+
+constexpr std::array<RpcField, kFieldTableSize> kFieldTable = BuildFieldTable();
+
+constexpr RpcField LookupField(const std::string_view name) {
+  const RpcField field = kFieldTable[FieldHash(name, kFieldSeed)];
+  if (field == RpcField::kUnknown ||
+      kFieldNames[std::to_underlying(field)] != name) {
+    return RpcField::kUnknown;
+  }
+  return field;
+}
+
+static_assert(LookupField("Name") == RpcField::kName);
+static_assert(LookupField("Keywords") == RpcField::kKeywords);
+static_assert(LookupField("Submitter") == RpcField::kUnknown);
+
+constexpr bool IsWhitespace(const char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+constexpr void AppendUtf8(std::string &out, const char32_t code_point) {
+  if (code_point < 0x80) {
+    out.push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+std::optional<char32_t> ParseHex4(const std::string_view digits) {
+  std::uint32_t value = 0;
+  const auto [ptr, ec] = std::from_chars(
+      digits.data(), digits.data() + digits.size(), value, 16);
+  if (digits.size() != 4 || ec != std::errc{} ||
+      ptr != digits.data() + digits.size()) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+// Field readers, following AurPackage::FromJson: a null leaves required
+// fields at their default and optional fields empty
+bool ReadString(aurpp::detail::JsonCursor &cursor, std::string &out) {
+  if (cursor.Null()) {
+    return true;
+  }
+  const std::optional<std::string_view> value = cursor.String();
+  if (!value.has_value()) {
+    return false;
+  }
+  out = value.value();
+  return true;
+}
+
+bool ReadString(aurpp::detail::JsonCursor &cursor,
+                std::optional<std::string> &out) {
+  if (cursor.Null()) {
+    out.reset();
+    return true;
+  }
+  return ReadString(cursor, out.emplace());
+}
+
+template <typename T>
+bool ReadNumber(aurpp::detail::JsonCursor &cursor, T &out) {
+  if (cursor.Null()) {
+    return true;
+  }
+  const std::optional<std::string_view> text = cursor.Number();
+  return text.has_value() && aurpp::detail::ParseNumber(text.value(), out);
+}
+
+template <typename T>
+bool ReadNumber(aurpp::detail::JsonCursor &cursor, std::optional<T> &out) {
+  if (cursor.Null()) {
+    out.reset();
+    return true;
+  }
+  return ReadNumber(cursor, out.emplace());
+}
+
+bool ReadStringList(aurpp::detail::JsonCursor &cursor,
+                    std::optional<std::vector<std::string>> &out) {
+  if (cursor.Null()) {
+    out.reset();
+    return true;
+  }
+  if (!cursor.Consume('[')) {
+    return false;
+  }
+
+  std::vector<std::string> &list = out.emplace();
+  if (cursor.Consume(']')) {
+    return true;
+  }
+  do {
+    const std::optional<std::string_view> value = cursor.String();
+    if (!value.has_value()) {
+      return false;
+    }
+    list.emplace_back(value.value());
+  } while (cursor.Consume(','));
+  return cursor.Consume(']');
+}
+
+}  // namespace
+
+namespace aurpp {
+
+namespace detail {
+
+void JsonCursor::SkipWhitespace() {
+  while (position_ < input_.size() && IsWhitespace(input_[position_])) {
+    ++position_;
+  }
+}
+
+bool JsonCursor::Consume(const char c) {
+  SkipWhitespace();
+  if (position_ < input_.size() && input_[position_] == c) {
+    ++position_;
+    return true;
+  }
+  return false;
+}
+
+bool JsonCursor::Null() {
+  SkipWhitespace();
+  if (input_.substr(position_).starts_with("null")) {
+    position_ += 4;
+    return true;
+  }
+  return false;
+}
+
+std::optional<std::string_view> JsonCursor::String() {
+  SkipWhitespace();
+  if (position_ >= input_.size() || input_[position_] != '"') {
+    return std::nullopt;
+  }
+
+  const std::size_t start = position_ + 1;
+  std::size_t end = input_.find_first_of("\"\\", start);
+  if (end == std::string_view::npos) {
+    return std::nullopt;
+  }
+  if (input_[end] == '"') {
+    position_ = end + 1;
+    return input_.substr(start, end - start);
+  }
+
+  // Escape sequences need decoding into the buffer
+  buffer_.assign(input_.substr(start, end - start));
+  while (end < input_.size()) {
+    const char c = input_[end];
+    if (c == '"') {
+      position_ = end + 1;
+      return buffer_;
+    }
+    if (c != '\\') {
+      buffer_.push_back(c);
+      ++end;
+      continue;
+    }
+
+    if (end + 1 >= input_.size()) {
+      return std::nullopt;
+    }
+    const char escaped = input_[end + 1];
+    end += 2;
+    switch (escaped) {
+      case '"':
+      case '\\':
+      case '/':
+        buffer_.push_back(escaped);
+        break;
+      case 'b':
+        buffer_.push_back('\b');
+        break;
+      case 'f':
+        buffer_.push_back('\f');
+        break;
+      case 'n':
+        buffer_.push_back('\n');
+        break;
+      case 'r':
+        buffer_.push_back('\r');
+        break;
+      case 't':
+        buffer_.push_back('\t');
+        break;
+      case 'u': {
+        std::optional<char32_t> code_point = ParseHex4(input_.substr(end, 4));
+        if (!code_point.has_value()) {
+          return std::nullopt;
+        }
+        end += 4;
+
+        // Characters outside the basic plane are encoded as surrogate pairs
+        if (*code_point >= 0xD800 && *code_point < 0xDC00 &&
+            input_.substr(end).starts_with("\\u")) {
+          const std::optional<char32_t> low =
+              ParseHex4(input_.substr(end + 2, 4));
+          if (low.has_value() && *low >= 0xDC00 && *low < 0xE000) {
+            code_point =
+                0x10000 + ((*code_point - 0xD800) << 10) + (*low - 0xDC00);
+            end += 6;
+          }
+        }
+        AppendUtf8(buffer_, *code_point);
+        break;
+      }
+      default:
+        return std::nullopt;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string_view> JsonCursor::Number() {
+  SkipWhitespace();
+  const std::size_t start = position_;
+  std::size_t end = start;
+  while (end < input_.size() &&
+         std::string_view{"+-.0123456789eE"}.contains(input_[end])) {
+    ++end;
+  }
+  if (end == start) {
+    return std::nullopt;
+  }
+  position_ = end;
+  return input_.substr(start, end - start);
+}
+
+bool JsonCursor::SkipValue() {
+  SkipWhitespace();
+  if (position_ >= input_.size()) {
+    return false;
+  }
+
+  switch (input_[position_]) {
+    case '"':
+      return String().has_value();
+    case '{':
+      ++position_;
+      if (Consume('}')) {
+        return true;
+      }
+      do {
+        if (!String().has_value() || !Consume(':') || !SkipValue()) {
+          return false;
+        }
+      } while (Consume(','));
+      return Consume('}');
+    case '[':
+      ++position_;
+      if (Consume(']')) {
+        return true;
+      }
+      do {
+        if (!SkipValue()) {
+          return false;
+        }
+      } while (Consume(','));
+      return Consume(']');
+    default:
+      break;
+  }
+
+  for (const std::string_view literal : {"null", "true", "false"}) {
+    if (input_.substr(position_).starts_with(literal)) {
+      position_ += literal.size();
+      return true;
+    }
+  }
+  return Number().has_value();
+}
+
+bool JsonCursor::AtEnd() {
+  SkipWhitespace();
+  return position_ == input_.size();
+}
+
+std::string JsonCursor::Error(const std::string_view message) const {
+  return std::format("{} at offset {}", message, position_);
+}
+
+std::expected<AurPackage, std::string> PackageDecoder::Decode(
+    JsonCursor &cursor) {
+  if (!cursor.Consume('{')) {
+    return std::unexpected{cursor.Error("Expected a package object")};
+  }
+
+  AurPackage pkg{};
+  if (cursor.Consume('}')) {
+    return pkg;
+  }
+
+  do {
+    const std::optional<std::string_view> key = cursor.String();
+    if (!key.has_value() || !cursor.Consume(':')) {
+      return std::unexpected{cursor.Error("Expected a field name")};
+    }
+
+    const RpcField field = LookupField(key.value());
+    bool valid = false;
+    switch (field) {
+      case RpcField::kName:
+        valid = ReadString(cursor, pkg.name_);
+        break;
+      case RpcField::kVersion:
+        valid = ReadString(cursor, pkg.version_);
+        break;
+      case RpcField::kDescription:
+        valid = ReadString(cursor, pkg.description_);
+        break;
+      case RpcField::kMaintainer:
+        valid = ReadString(cursor, pkg.maintainer_);
+        break;
+      case RpcField::kUrl:
+        valid = ReadString(cursor, pkg.url_);
+        break;
+      case RpcField::kNumVotes:
+        valid = ReadNumber(cursor, pkg.num_votes_);
+        break;
+      case RpcField::kPopularity:
+        valid = ReadNumber(cursor, pkg.popularity_);
+        break;
+      case RpcField::kOutOfDate:
+        valid = ReadNumber(cursor, pkg.out_of_date_);
+        break;
+      case RpcField::kPackageBase:
+        valid = ReadString(cursor, pkg.package_base_);
+        break;
+      case RpcField::kPackageBaseId:
+        valid = ReadNumber(cursor, pkg.package_base_id_);
+        break;
+      case RpcField::kFirstSubmitted:
+        valid = ReadNumber(cursor, pkg.first_submitted_);
+        break;
+      case RpcField::kLastModified:
+        valid = ReadNumber(cursor, pkg.last_modified_);
+        break;
+      case RpcField::kUrlPath:
+        valid = ReadString(cursor, pkg.url_path_);
+        break;
+      case RpcField::kId:
+        valid = ReadNumber(cursor, pkg.id_);
+        break;
+      case RpcField::kDepends:
+        valid = ReadStringList(cursor, pkg.depends_);
+        break;
+      case RpcField::kMakeDepends:
+        valid = ReadStringList(cursor, pkg.make_depends_);
+        break;
+      case RpcField::kOptDepends:
+        valid = ReadStringList(cursor, pkg.opt_depends_);
+        break;
+      case RpcField::kCheckDepends:
+        valid = ReadStringList(cursor, pkg.check_depends_);
+        break;
+      case RpcField::kConflicts:
+        valid = ReadStringList(cursor, pkg.conflicts_);
+        break;
+      case RpcField::kProvides:
+        valid = ReadStringList(cursor, pkg.provides_);
+        break;
+      case RpcField::kReplaces:
+        valid = ReadStringList(cursor, pkg.replaces_);
+        break;
+      case RpcField::kGroups:
+        valid = ReadStringList(cursor, pkg.groups_);
+        break;
+      case RpcField::kLicense:
+        valid = ReadStringList(cursor, pkg.license_);
+        break;
+      case RpcField::kKeywords:
+        valid = ReadStringList(cursor, pkg.keywords_);
+        break;
+      case RpcField::kUnknown:
+        valid = cursor.SkipValue();
+        break;
+    }
+
+    if (!valid) {
+      return std::unexpected{cursor.Error(
+          field == RpcField::kUnknown
+              ? std::string{"Invalid value"}
+              : std::format("Invalid value for {}",
+                            kFieldNames[std::to_underlying(field)]))};
+    }
+  } while (cursor.Consume(','));
+
+  if (!cursor.Consume('}')) {
+    return std::unexpected{cursor.Error("Expected ',' or '}'")};
+  }
+  return pkg;
+}
+
+RpcField LookupRpcField(const std::string_view name) {
+  return LookupField(name);
+}
+
+std::string_view RpcFieldName(const RpcField field) {
+  return field == RpcField::kUnknown ? "unknown"
+                                     : kFieldNames[std::to_underlying(field)];
+}
+
+bool IsErrorResponse(const std::string_view json) {
+  JsonCursor cursor{json};
+  if (!cursor.Consume('{') || cursor.Consume('}')) {
+    return false;
+  }
+
+  do {
+    const std::optional<std::string_view> key = cursor.String();
+    if (!key.has_value() || !cursor.Consume(':')) {
+      return false;
+    }
+    if (key.value() == "type") {
+      return cursor.String() == "error";
+    }
+    if (!cursor.SkipValue()) {
+      return false;
+    }
+  } while (cursor.Consume(','));
+  return false;
+}
+
+}  // namespace detail
+
+std::expected<AurPackage, std::string> RpcDecoder::DecodePackage(
+    const std::string_view json) {
+  detail::JsonCursor cursor{json};
+  std::expected<AurPackage, std::string> package =
+      detail::PackageDecoder::Decode(cursor);
+  if (package.has_value() && !cursor.AtEnd()) {
+    return std::unexpected{cursor.Error("Unexpected data after the package")};
+  }
+  return package;
+}
+
+}  // namespace aurpp
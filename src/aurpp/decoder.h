@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef AURPP_DECODER_H_
+#define AURPP_DECODER_H_
+
+#include <aurpp/package.h>
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace aurpp {
+
+namespace detail {
+
+// A forward-only reader over a JSON document. Every method skips leading
+// whitespace and leaves the cursor unchanged when the expected token is not
+// next.
+class JsonCursor {
+ public:
+  constexpr explicit JsonCursor(const std::string_view input)
+      : input_(input) {}
+
+  JsonCursor(const JsonCursor &) = delete;
+  JsonCursor &operator=(const JsonCursor &) = delete;
+
+  // Consumes c if it is the next character
+  bool Consume(char c);
+
+  // Consumes a null literal if it is the next token
+  bool Null();
+
+  // Reads a string. Strings without escapes are returned as a view into the
+  // input, others are decoded into a buffer that is reused by the next call.
+  std::optional<std::string_view> String();
+
+  // Reads the text of a number, to be converted by the caller
+  std::optional<std::string_view> Number();
+
+  // Skips over any value, including nested objects and arrays
+  bool SkipValue();
+
+  [[nodiscard]] bool AtEnd();
+
+  [[nodiscard]] std::string Error(std::string_view message) const;
+
+ private:
+  void SkipWhitespace();
+
+  std::string_view input_;
+  std::size_t position_ = 0;
+  std::string buffer_;
+};
+
+// The fields of a package in an RPC v5 response
+enum class RpcField : std::uint8_t {
+  kName,
+  kVersion,
+  kDescription,
+  kMaintainer,
+  kUrl,
+  kNumVotes,
+  kPopularity,
+  kOutOfDate,
+  kPackageBase,
+  kPackageBaseId,
+  kFirstSubmitted,
+  kLastModified,
+  kUrlPath,
+  kId,
+  kDepends,
+  kMakeDepends,
+  kOptDepends,
+  kCheckDepends,
+  kConflicts,
+  kProvides,
+  kReplaces,
+  kGroups,
+  kLicense,
+  kKeywords,
+  kUnknown,
+};
+
+// Looks up a field by its JSON name, returning kUnknown for fields that are
+// not decoded
+RpcField LookupRpcField(std::string_view name);
+
+std::string_view RpcFieldName(RpcField field);
+
+// Converts the text of a number read with JsonCursor::Number
+template <typename T>
+bool ParseNumber(const std::string_view text, T &out) {
+  const char *end = text.data() + text.size();
+  const auto [ptr, ec] = std::from_chars(text.data(), end, out);
+  return ec == std::errc{} && ptr == end;
+}
+
+class PackageDecoder {
+ public:
+  static std::expected<AurPackage, std::string> Decode(JsonCursor &cursor);
+};
+
+// Walks the array at the cursor and calls decode_element with the cursor at
+// the start of every element. Returns the number of elements.
+template <typename DecodeElement>
+  requires std::invocable<DecodeElement &, JsonCursor &>
+std::expected<std::size_t, std::string> DecodeArray(
+    JsonCursor &cursor, DecodeElement &decode_element) {
+  if (!cursor.Consume('[')) {
+    return std::unexpected{cursor.Error("Expected an array")};
+  }
+  if (cursor.Consume(']')) {
+    return 0;
+  }
+
+  std::size_t count = 0;
+  do {
+    if (std::expected<void, std::string> result = decode_element(cursor);
+        !result.has_value()) {
+      return std::unexpected{std::move(result.error())};
+    }
+    ++count;
+  } while (cursor.Consume(','));
+
+  if (!cursor.Consume(']')) {
+    return std::unexpected{cursor.Error("Expected ',' or ']'")};
+  }
+  return count;
+}
+
+// Walks a whole response and calls decode_element with the cursor at the
+// start of every element of the "results" array. Returns the number of
+// elements, or the error message of an RPC error response.
+template <typename DecodeElement>
+  requires std::invocable<DecodeElement &, JsonCursor &>
+std::expected<std::size_t, std::string> DecodeResults(
+    const std::string_view json, DecodeElement &&decode_element) {
+  JsonCursor cursor{json};
+  std::size_t count = 0;
+  std::string rpc_error;
+
+  if (!cursor.Consume('{')) {
+    return std::unexpected{cursor.Error("Expected a JSON object")};
+  }
+
+  if (!cursor.Consume('}')) {
+    do {
+      const std::optional<std::string_view> key = cursor.String();
+      if (!key.has_value() || !cursor.Consume(':')) {
+        return std::unexpected{cursor.Error("Expected a key")};
+      }
+
+      if (key.value() == "results") {
+        if (cursor.Null()) {
+          continue;
+        }
+        std::expected<std::size_t, std::string> elements =
+            DecodeArray(cursor, decode_element);
+        if (!elements.has_value()) {
+          return std::unexpected{std::move(elements.error())};
+        }
+        count += elements.value();
+      } else if (key.value() == "error") {
+        if (const std::optional<std::string_view> error = cursor.String()) {
+          rpc_error = error.value();
+        } else if (!cursor.SkipValue()) {
+          return std::unexpected{cursor.Error("Invalid value")};
+        }
+      } else if (!cursor.SkipValue()) {
+        return std::unexpected{cursor.Error("Invalid value")};
+      }
+    } while (cursor.Consume(','));
+
+    if (!cursor.Consume('}')) {
+      return std::unexpected{cursor.Error("Expected ',' or '}'")};
+    }
+  }
+
+  if (!cursor.AtEnd()) {
+    return std::unexpected{cursor.Error("Unexpected data after the response")};
+  }
+  if (!rpc_error.empty()) {
+    return std::unexpected{std::move(rpc_error)};
+  }
+  return count;
+}
+
+// Returns whether json is an RPC error response, an object whose "type" is
+// "error". Only the top-level keys are read, and anything that isn't a JSON
+// object isn't an error response.
+bool IsErrorResponse(std::string_view json);
+
+}  // namespace detail
+
+// Decodes AUR RPC v5 responses straight into AurPackages in a single pass
+// over the input, without building an intermediate document tree.
+class RpcDecoder {
+ public:
+  // Decodes one element of the "results" array
+  static std::expected<AurPackage, std::string> DecodePackage(
+      std::string_view json);
+
+  // Decodes a whole response, passing every package to sink in order, and
+  // returns the number of packages. Error responses from the RPC interface
+  // are returned as their error message.
+  template <typename Sink>
+    requires std::invocable<Sink &, AurPackage>
+  static std::expected<std::size_t, std::string> Decode(std::string_view json,
+                                                        Sink &&sink);
+
+  // Decodes a bare JSON array of packages, the format of the AUR metadata
+  // dumps, passing every package to sink in order
+  template <typename Sink>
+    requires std::invocable<Sink &, AurPackage>
+  static std::expected<std::size_t, std::string> DecodeArray(
+      std::string_view json, Sink &&sink);
+
+ private:
+  template <typename Sink>
+  static auto PackageSink(Sink &sink) {
+    return [&sink](
+               detail::JsonCursor &cursor) -> std::expected<void, std::string> {
+      std::expected<AurPackage, std::string> package =
+          detail::PackageDecoder::Decode(cursor);
+      if (!package.has_value()) {
+        return std::unexpected{std::move(package.error())};
+      }
+      sink(std::move(package.value()));
+      return {};
+    };
+  }
+};
+
+template <typename Sink>
+  requires std::invocable<Sink &, AurPackage>
+std::expected<std::size_t, std::string> RpcDecoder::Decode(
+    const std::string_view json, Sink &&sink) {
+  return detail::DecodeResults(json, PackageSink(sink));
+}
+
+template <typename Sink>
+  requires std::invocable<Sink &, AurPackage>
+std::expected<std::size_t, std::string> RpcDecoder::DecodeArray(
+    const std::string_view json, Sink &&sink) {
+  detail::JsonCursor cursor{json};
+  auto decode_element = PackageSink(sink);
+  std::expected<std::size_t, std::string> count =
+      detail::DecodeArray(cursor, decode_element);
+  if (count.has_value() && !cursor.AtEnd()) {
+    return std::unexpected{cursor.Error("Unexpected data after the array")};
+  }
+  return count;
+}
+
+}  // namespace aurpp
+
+#endif  // AURPP_DECODER_H_
@@ -0,0 +1,221 @@
+// SPDX-License-Identifier: MIT
+
+#include <aurpp/decoder.h>
+#include <aurpp/mirror.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <optional>
+
+namespace {
+
+constexpr bool IsGzip(const std::string_view contents) {
+  return contents.size() >= 2 && contents[0] == '\x1f' &&
+         contents[1] == '\x8b';
+}
+
+std::expected<std::string, std::string> Gunzip(
+    const std::string_view compressed) {
+  constexpr std::size_t kChunkSize = 256 * 1024;
+
+  z_stream stream{};
+  // 16 selects the gzip wrapper instead of a raw zlib stream
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+    return std::unexpected{"Could not initialize zlib"};
+  }
+
+  std::string output;
+  stream.next_in =
+      reinterpret_cast<Bytef *>(const_cast<char *>(compressed.data()));
+  stream.avail_in = static_cast<uInt>(std::min<std::size_t>(
+      compressed.size(), std::numeric_limits<uInt>::max()));
+
+  int result = Z_OK;
+  while (result == Z_OK) {
+    const std::size_t offset = output.size();
+    output.resize(offset + kChunkSize);
+    stream.next_out = reinterpret_cast<Bytef *>(output.data() + offset);
+    stream.avail_out = kChunkSize;
+    result = inflate(&stream, Z_NO_FLUSH);
+    output.resize(offset + kChunkSize - stream.avail_out);
+  }
+  inflateEnd(&stream);
+
+  if (result != Z_STREAM_END) {
+    return std::unexpected{std::format(
+        "Could not decompress metadata dump: {}",
+        stream.msg != nullptr ? stream.msg : "truncated input")};
+  }
+  return output;
+}
+
+}  // namespace
+
+namespace aurpp {
+
+namespace detail {
+
+std::expected<void, std::string> ValidateSearch(
+    const SearchRequest::SearchBy search_by, const std::string_view arg) {
+  using SearchBy = SearchRequest::SearchBy;
+
+  switch (search_by) {
+    case SearchBy::kName:
+    case SearchBy::kNameDesc:
+      // Same limit as the RPC interface, which would otherwise match nearly
+      // every package
+      if (arg.size() < 2) {
+        return std::unexpected{"Query arg too small."};
+      }
+      return {};
+    case SearchBy::kInvalid:
+      return std::unexpected{"Incorrect by field specified."};
+    default:
+      if (std::ranges::find(kExactSearchFields, search_by) ==
+          kExactSearchFields.end()) {
+        return std::unexpected{
+            std::format("Searching by {} is not supported offline",
+                        SearchRequest::SearchByToString(search_by))};
+      }
+      return {};
+  }
+}
+
+}  // namespace detail
+
+LocalMirror::LocalMirror(std::vector<AurPackage> packages)
+    : packages_(std::move(packages)) {
+  BuildIndexes();
+}
+
+std::expected<LocalMirror, std::string> LocalMirror::Parse(
+    const std::string_view contents) {
+  std::string decompressed;
+  std::string_view json = contents;
+  if (IsGzip(contents)) {
+    std::expected<std::string, std::string> result = Gunzip(contents);
+    if (!result.has_value()) {
+      return std::unexpected{std::move(result.error())};
+    }
+    decompressed = std::move(result.value());
+    json = decompressed;
+  }
+
+  std::vector<AurPackage> packages;
+  const std::expected<std::size_t, std::string> count = RpcDecoder::DecodeArray(
+      json, [&packages](AurPackage package) {
+        packages.push_back(std::move(package));
+      });
+  if (!count.has_value()) {
+    return std::unexpected{count.error()};
+  }
+  if (packages.size() > std::numeric_limits<std::uint32_t>::max()) {
+    return std::unexpected{"Metadata dump has too many packages"};
+  }
+  return LocalMirror{std::move(packages)};
+}
+
+std::expected<LocalMirror, std::string> LocalMirror::Load(
+    const std::filesystem::path &path) {
+  std::ifstream file{path, std::ios::binary};
+  if (!file) {
+    return std::unexpected{
+        std::format("Could not open metadata dump {}", path.string())};
+  }
+  const std::string contents{std::istreambuf_iterator<char>{file},
+                             std::istreambuf_iterator<char>{}};
+  return Parse(contents);
+}
+
+void LocalMirror::BuildIndexes() {
+  by_name_.reserve(packages_.size());
+  for (std::uint32_t i = 0; i < packages_.size(); ++i) {
+    by_name_.try_emplace(packages_[i].name(), i);
+  }
+
+  for (std::size_t field = 0; field < detail::kExactSearchFields.size();
+       ++field) {
+    TermIndex &index = term_indexes_[field];
+    for (std::uint32_t i = 0; i < packages_.size(); ++i) {
+      const auto add = [&index, i](const std::string_view term) {
+        std::vector<std::uint32_t> &matches = index[term];
+        // A package can list a relation more than once, e.g. with a lower
+        // and an upper version bound
+        if (matches.empty() || matches.back() != i) {
+          matches.push_back(i);
+        }
+      };
+      detail::ForEachSearchTerm(packages_[i],
+                                detail::kExactSearchFields[field], add);
+    }
+  }
+}
+
+std::expected<RpcResponse, std::string> LocalMirror::Execute(
+    const InfoRequest &request) const {
+  return Info(request.args());
+}
+
+std::expected<RpcResponse, std::string> LocalMirror::Execute(
+    const SearchRequest &request) const {
+  return Search(request.search_by(), request.arg());
+}
+
+RpcResponse LocalMirror::Info(
+    const std::span<const std::string_view> names) const {
+  std::vector<std::uint32_t> indexes;
+  indexes.reserve(names.size());
+  for (const std::string_view name : names) {
+    if (const auto it = by_name_.find(name); it != by_name_.end()) {
+      indexes.push_back(it->second);
+    }
+  }
+  return Collect(indexes);
+}
+
+std::expected<RpcResponse, std::string> LocalMirror::Search(
+    const SearchBy search_by, const std::string_view arg) const {
+  if (std::expected<void, std::string> valid =
+          detail::ValidateSearch(search_by, arg);
+      !valid.has_value()) {
+    return std::unexpected{std::move(valid.error())};
+  }
+
+  if (search_by == SearchBy::kName || search_by == SearchBy::kNameDesc) {
+    std::vector<std::uint32_t> indexes;
+    for (std::uint32_t i = 0; i < packages_.size(); ++i) {
+      const AurPackage &package = packages_[i];
+      if (detail::ContainsIgnoreCase(package.name(), arg) ||
+          (search_by == SearchBy::kNameDesc &&
+           detail::ContainsIgnoreCase(package.description().value_or(""),
+                                      arg))) {
+        indexes.push_back(i);
+      }
+    }
+    return Collect(indexes);
+  }
+
+  const auto field = std::ranges::find(detail::kExactSearchFields, search_by);
+  const TermIndex &index = term_indexes_[static_cast<std::size_t>(
+      field - detail::kExactSearchFields.begin())];
+  if (const auto it = index.find(arg); it != index.end()) {
+    return Collect(it->second);
+  }
+  return RpcResponse{};
+}
+
+RpcResponse LocalMirror::Collect(
+    const std::span<const std::uint32_t> indexes) const {
+  std::vector<AurPackage> packages;
+  packages.reserve(indexes.size());
+  for (const std::uint32_t index : indexes) {
+    packages.push_back(packages_[index]);
+  }
+  return RpcResponse{std::move(packages)};
+}
+
+}  // namespace aurpp
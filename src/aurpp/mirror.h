@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef AURPP_MIRROR_H_
+#define AURPP_MIRROR_H_
+
+#include <aurpp/package.h>
+#include <aurpp/request.h>
+#include <aurpp/response.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace aurpp {
+
+namespace detail {
+
+// The fields that are searched by exact match rather than by substring
+inline constexpr std::array kExactSearchFields{
+    SearchRequest::SearchBy::kMaintainer,
+    SearchRequest::SearchBy::kDepends,
+    SearchRequest::SearchBy::kMakeDepends,
+    SearchRequest::SearchBy::kCheckDepends,
+    SearchRequest::SearchBy::kProvides,
+    SearchRequest::SearchBy::kConflicts,
+    SearchRequest::SearchBy::kReplaces,
+    SearchRequest::SearchBy::kKeywords,
+    SearchRequest::SearchBy::kGroups,
+};
+
+// Strips the version constraint of a relation like "glibc>=2.35" and the
+// description of an optional dependency like "git: VCS support", which the
+// RPC interface ignores when searching by relation
+constexpr std::string_view RelationName(const std::string_view relation) {
+  return relation.substr(0, relation.find_first_of("<>=:"));
+}
+
+constexpr bool ContainsIgnoreCase(const std::string_view haystack,
+                                  const std::string_view needle) {
+  const auto lower = [](const char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+  };
+  return !std::ranges::search(haystack, needle, {}, lower, lower).empty();
+}
+
+// Calls add with every value of package that an exact search on search_by
+// matches
+template <typename Add>
+void ForEachSearchTerm(const AurPackage &package,
+                       const SearchRequest::SearchBy search_by, Add &&add) {
+  using SearchBy = SearchRequest::SearchBy;
+
+  const auto add_relations = [&add](const auto &list) {
+    if (list.has_value()) {
+      for (const std::string &relation : list.value()) {
+        add(RelationName(relation));
+      }
+    }
+  };
+  const auto add_values = [&add](const auto &list) {
+    if (list.has_value()) {
+      for (const std::string &value : list.value()) {
+        add(std::string_view{value});
+      }
+    }
+  };
+
+  switch (search_by) {
+    case SearchBy::kMaintainer:
+      // Orphans are found by searching for an empty maintainer
+      add(package.maintainer().value_or(std::string_view{}));
+      break;
+    case SearchBy::kDepends:
+      add_relations(package.depends());
+      break;
+    case SearchBy::kMakeDepends:
+      add_relations(package.make_depends());
+      break;
+    case SearchBy::kCheckDepends:
+      add_relations(package.check_depends());
+      break;
+    case SearchBy::kProvides:
+      add_relations(package.provides());
+      break;
+    case SearchBy::kConflicts:
+      add_relations(package.conflicts());
+      break;
+    case SearchBy::kReplaces:
+      add_relations(package.replaces());
+      break;
+    case SearchBy::kKeywords:
+      add_values(package.keywords());
+      break;
+    case SearchBy::kGroups:
+      add_values(package.groups());
+      break;
+    default:
+      break;
+  }
+}
+
+// Rejects searches the RPC interface would reject, and fields that are not
+// part of the metadata dump
+std::expected<void, std::string> ValidateSearch(
+    SearchRequest::SearchBy search_by, std::string_view arg);
+
+}  // namespace detail
+
+// A local copy of the AUR built from its bulk metadata dump. Info and search
+// requests are answered from in-memory indexes with the same semantics as the
+// RPC interface, so no request reaches the network.
+class LocalMirror {
+ public:
+  using SearchBy = SearchRequest::SearchBy;
+
+  // Parses a metadata dump, either gzip compressed as served by the AUR or
+  // already decompressed
+  static std::expected<LocalMirror, std::string> Parse(
+      std::string_view contents);
+
+  static std::expected<LocalMirror, std::string> Load(
+      const std::filesystem::path &path);
+
+  LocalMirror(const LocalMirror &) = delete;
+  LocalMirror &operator=(const LocalMirror &) = delete;
+
+  LocalMirror(LocalMirror &&) = default;
+  LocalMirror &operator=(LocalMirror &&) = default;
+
+  [[nodiscard]] std::expected<RpcResponse, std::string> Execute(
+      const InfoRequest &request) const;
+
+  [[nodiscard]] std::expected<RpcResponse, std::string> Execute(
+      const SearchRequest &request) const;
+
+  // Returns the packages with the given names, ordered like names. Names
+  // that are not in the mirror are skipped.
+  [[nodiscard]] RpcResponse Info(std::span<const std::string_view> names) const;
+
+  [[nodiscard]] std::expected<RpcResponse, std::string> Search(
+      SearchBy search_by, std::string_view arg) const;
+
+  [[nodiscard]] constexpr std::span<const AurPackage> packages()
+      const noexcept {
+    return packages_;
+  }
+
+  [[nodiscard]] constexpr std::size_t size() const noexcept {
+    return packages_.size();
+  }
+
+ private:
+  // Maps a term to the indexes of the packages that have it, in dump order.
+  // Keys refer to the strings in packages_.
+  using TermIndex =
+      std::unordered_map<std::string_view, std::vector<std::uint32_t>>;
+
+  explicit LocalMirror(std::vector<AurPackage> packages);
+
+  void BuildIndexes();
+
+  [[nodiscard]] RpcResponse Collect(
+      std::span<const std::uint32_t> indexes) const;
+
+  std::vector<AurPackage> packages_;
+  std::unordered_map<std::string_view, std::uint32_t> by_name_;
+  std::array<TermIndex, detail::kExactSearchFields.size()> term_indexes_;
+};
+
+}  // namespace aurpp
+
+#endif  // AURPP_MIRROR_H_
@@ -7,11 +7,16 @@
 
 #include <cstdint>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
 namespace aurpp {
 
+namespace detail {
+class PackageDecoder;
+}  // namespace detail
+
 class AurPackage {
  public:
   constexpr AurPackage() = default;
@@ -74,54 +79,54 @@ class AurPackage {
 
   [[nodiscard]] constexpr int id() const noexcept { return id_; }
 
-  [[nodiscard]] constexpr std::optional<std::vector<std::string>> depends()
+  [[nodiscard]] constexpr std::optional<std::span<const std::string>> depends()
       const noexcept {
-    return depends_;
+    return AsSpan(depends_);
   }
 
-  [[nodiscard]] constexpr std::optional<std::vector<std::string>> make_depends()
-      const noexcept {
-    return make_depends_;
+  [[nodiscard]] constexpr std::optional<std::span<const std::string>>
+  make_depends() const noexcept {
+    return AsSpan(make_depends_);
   }
 
-  [[nodiscard]] constexpr std::optional<std::vector<std::string>> opt_depends()
-      const noexcept {
-    return opt_depends_;
+  [[nodiscard]] constexpr std::optional<std::span<const std::string>>
+  opt_depends() const noexcept {
+    return AsSpan(opt_depends_);
   }
 
-  [[nodiscard]] constexpr std::optional<std::vector<std::string>>
+  [[nodiscard]] constexpr std::optional<std::span<const std::string>>
   check_depends() const noexcept {
-    return check_depends_;
+    return AsSpan(check_depends_);
   }
 
-  [[nodiscard]] constexpr std::optional<std::vector<std::string>> conflicts()
-      const noexcept {
-    return conflicts_;
+  [[nodiscard]] constexpr std::optional<std::span<const std::string>>
+  conflicts() const noexcept {
+    return AsSpan(conflicts_);
   }
 
-  [[nodiscard]] constexpr std::optional<std::vector<std::string>> provides()
+  [[nodiscard]] constexpr std::optional<std::span<const std::string>> provides()
       const noexcept {
-    return provides_;
+    return AsSpan(provides_);
   }
 
-  [[nodiscard]] constexpr std::optional<std::vector<std::string>> replaces()
+  [[nodiscard]] constexpr std::optional<std::span<const std::string>> replaces()
       const noexcept {
-    return replaces_;
+    return AsSpan(replaces_);
   }
 
-  [[nodiscard]] constexpr std::optional<std::vector<std::string>> groups()
+  [[nodiscard]] constexpr std::optional<std::span<const std::string>> groups()
       const noexcept {
-    return groups_;
+    return AsSpan(groups_);
   }
 
-  [[nodiscard]] constexpr std::optional<std::vector<std::string>> license()
+  [[nodiscard]] constexpr std::optional<std::span<const std::string>> license()
       const noexcept {
-    return license_;
+    return AsSpan(license_);
   }
 
-  [[nodiscard]] constexpr std::optional<std::vector<std::string>> keywords()
+  [[nodiscard]] constexpr std::optional<std::span<const std::string>> keywords()
       const noexcept {
-    return keywords_;
+    return AsSpan(keywords_);
   }
 
   constexpr void set_name(const std::string_view name) noexcept {
@@ -226,6 +231,17 @@ class AurPackage {
       std::string_view aur_base_url) const noexcept;
 
  private:
+  static constexpr std::optional<std::span<const std::string>> AsSpan(
+      const std::optional<std::vector<std::string>> &list) noexcept {
+    if (!list.has_value()) {
+      return std::nullopt;
+    }
+    return std::span<const std::string>{list.value()};
+  }
+
+  // Writes fields directly while decoding RPC responses
+  friend class detail::PackageDecoder;
+
   std::string name_;
   std::string version_;
   std::optional<std::string> description_;
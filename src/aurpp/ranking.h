@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef AURPP_RANKING_H_
+#define AURPP_RANKING_H_
+
+#include <aurpp/package.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <ranges>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace aurpp {
+
+enum class SortBy { kInvalid, kNone, kVotes, kPopularity, kModified, kName };
+
+constexpr SortBy ParseSortBy(const std::string_view sort_by) {
+  if (sort_by == "votes") {
+    return SortBy::kVotes;
+  } else if (sort_by == "popularity") {
+    return SortBy::kPopularity;
+  } else if (sort_by == "modified") {
+    return SortBy::kModified;
+  } else if (sort_by == "name") {
+    return SortBy::kName;
+  } else {
+    return SortBy::kInvalid;
+  }
+}
+
+namespace detail {
+
+// Orders the first limit (key, position) pairs by key, breaking ties by
+// position so equal keys keep the order they were received in, and returns
+// their positions. Only the selected pairs end up sorted.
+template <typename Key, typename Compare>
+std::vector<std::uint32_t> SelectTopKeys(
+    std::vector<std::pair<Key, std::uint32_t>> keys, const std::size_t limit,
+    const Compare compare) {
+  const auto before = [&compare](const auto &lhs, const auto &rhs) {
+    if (compare(lhs.first, rhs.first)) {
+      return true;
+    }
+    return !compare(rhs.first, lhs.first) && lhs.second < rhs.second;
+  };
+
+  const std::size_t count = std::min(limit, keys.size());
+  std::ranges::partial_sort(keys, keys.begin() + count, before);
+
+  std::vector<std::uint32_t> positions;
+  positions.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    positions.push_back(keys[i].second);
+  }
+  return positions;
+}
+
+template <typename Range, typename Proj, typename KeyOf, typename Compare>
+std::vector<std::uint32_t> SelectTopBy(const Range &items,
+                                       const std::size_t limit,
+                                       const Proj &proj, const KeyOf key_of,
+                                       const Compare compare) {
+  using Key = decltype(key_of(std::invoke(proj, *std::ranges::begin(items))));
+  // Keys are copied around while sorting, so they must stay small
+  static_assert(std::is_trivially_copyable_v<Key>);
+  std::vector<std::pair<Key, std::uint32_t>> keys;
+  keys.reserve(std::ranges::size(items));
+  std::uint32_t position = 0;
+  for (const auto &item : items) {
+    keys.emplace_back(key_of(std::invoke(proj, item)), position++);
+  }
+  return SelectTopKeys(std::move(keys), limit, compare);
+}
+
+}  // namespace detail
+
+// Returns the positions in items of the first limit packages when ordered by
+// sort_by: most voted, most popular and most recently modified first, names
+// alphabetically. With SortBy::kNone the order of items is kept. Rather than
+// sorting the packages themselves, only a compact array of sort keys is
+// partially sorted, so selecting a few packages out of many stays cheap. proj
+// maps an element of items to its AurPackage.
+template <std::ranges::sized_range Range, typename Proj = std::identity>
+std::vector<std::uint32_t> SelectTop(const Range &items, const SortBy sort_by,
+                                     const std::size_t limit,
+                                     const Proj proj = {}) {
+  switch (sort_by) {
+    case SortBy::kVotes:
+      return detail::SelectTopBy(
+          items, limit, proj,
+          [](const AurPackage &package) { return package.num_votes(); },
+          std::greater{});
+    case SortBy::kPopularity:
+      return detail::SelectTopBy(
+          items, limit, proj,
+          [](const AurPackage &package) { return package.popularity(); },
+          std::greater{});
+    case SortBy::kModified:
+      return detail::SelectTopBy(
+          items, limit, proj,
+          [](const AurPackage &package) { return package.last_modified(); },
+          std::greater{});
+    case SortBy::kName:
+      return detail::SelectTopBy(
+          items, limit, proj,
+          // A view, so names aren't copied into the keys
+          [](const AurPackage &package) -> std::string_view {
+            return package.name();
+          },
+          std::less{});
+    default: {
+      std::vector<std::uint32_t> positions(
+          std::min<std::size_t>(limit, std::ranges::size(items)));
+      std::iota(positions.begin(), positions.end(), 0U);
+      return positions;
+    }
+  }
+}
+
+}  // namespace aurpp
+
+#endif  // AURPP_RANKING_H_
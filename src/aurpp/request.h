@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <format>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -65,6 +66,11 @@ class RpcRequest : public HttpRequest {
     params_.emplace_back(key, value);
   }
 
+  [[nodiscard]] constexpr std::span<const QueryParameter> params()
+      const noexcept {
+    return params_;
+  }
+
  private:
   std::string endpoint_;
   std::vector<QueryParameter> params_;
@@ -78,6 +84,11 @@ class RawRequest final : public HttpRequest {
                                   detail::UrlEscape(package.package_base()))};
   }
 
+  // The bulk metadata of every package, used to build a LocalMirror
+  static RawRequest ForMetadataDump() {
+    return RawRequest{"/packages-meta-ext-v1.json.gz"};
+  }
+
   constexpr explicit RawRequest(std::string url_path)
       : HttpRequest(Command::kGet), url_path_(std::move(url_path)) {}
 
@@ -109,10 +120,29 @@ class InfoRequest final : public RpcRequest {
   constexpr explicit InfoRequest(const std::vector<AurPackage> &packages)
       : InfoRequest() {
     for (const AurPackage &package : packages) {
-      AddArg(std::string{package.name()});
+      AddArg(package.name());
     }
   }
 
+  // Splits args into requests of at most max_args arguments each, so that
+  // large lookups stay within the server's limits. Like AddArg, the requests
+  // refer to the strings in args, which must outlive them.
+  static constexpr std::vector<InfoRequest> Chunked(
+      const std::span<const std::string> args, const std::size_t max_args) {
+    const std::size_t chunk_size = std::max<std::size_t>(max_args, 1);
+    std::vector<InfoRequest> requests;
+    requests.reserve((args.size() + chunk_size - 1) / chunk_size);
+
+    for (std::size_t i = 0; i < args.size(); i += chunk_size) {
+      InfoRequest &request = requests.emplace_back();
+      for (const std::string &arg :
+           args.subspan(i, std::min(chunk_size, args.size() - i))) {
+        request.AddArg(arg);
+      }
+    }
+    return requests;
+  }
+
   constexpr InfoRequest() : RpcRequest{Command::kPost, "/rpc/v5/info"} {}
 
   InfoRequest(const InfoRequest &) = delete;
@@ -124,6 +154,16 @@ class InfoRequest final : public RpcRequest {
   constexpr void AddArg(const std::string_view arg) {
     RpcRequest::AddArg("arg[]", arg);
   }
+
+  // The package names to look up
+  [[nodiscard]] constexpr std::vector<std::string_view> args() const {
+    std::vector<std::string_view> names;
+    names.reserve(params().size());
+    for (const QueryParameter &param : params()) {
+      names.push_back(param.value);
+    }
+    return names;
+  }
 };
 
 class SearchRequest final : public RpcRequest {
@@ -179,7 +219,9 @@ class SearchRequest final : public RpcRequest {
 
   SearchRequest(const SearchBy search_by, const std::string_view arg)
       : RpcRequest(Command::kGet, std::format("/rpc/v5/search/{}?by={}", arg,
-                                              SearchByToString(search_by))) {}
+                                              SearchByToString(search_by))),
+        search_by_(search_by),
+        arg_(arg) {}
 
   SearchRequest(const SearchRequest &) = delete;
   SearchRequest &operator=(const SearchRequest &) = delete;
@@ -187,7 +229,14 @@ class SearchRequest final : public RpcRequest {
   SearchRequest(SearchRequest &&) = default;
   SearchRequest &operator=(SearchRequest &&) = default;
 
- private:
+  [[nodiscard]] constexpr SearchBy search_by() const noexcept {
+    return search_by_;
+  }
+
+  [[nodiscard]] constexpr const std::string &arg() const noexcept {
+    return arg_;
+  }
+
   static constexpr std::string SearchByToString(const SearchBy search_by) {
     switch (search_by) {
       case SearchBy::kName:
@@ -220,6 +269,10 @@ class SearchRequest final : public RpcRequest {
         return "";
     }
   }
+
+ private:
+  SearchBy search_by_;
+  std::string arg_;
 };
 
 }  // namespace aurpp
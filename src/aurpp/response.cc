@@ -2,28 +2,25 @@
 
 #include "response.h"
 
+#include <aurpp/decoder.h>
+
 namespace aurpp {
 
 std::expected<RpcResponse, std::string> RpcResponse::Parse(
-    std::string file_contents) {
-  std::istringstream file_stream{file_contents};
-  Json::CharReaderBuilder reader_builder;
-  reader_builder["collectComments"] = false;
-
-  Json::Value json;
-  std::string errors;
-
-  const bool success =
-      Json::parseFromStream(reader_builder, file_stream, &json, &errors);
-  if (!success) {
-    return std::unexpected{errors};
-  }
-
+    const std::string_view file_contents) {
   std::vector<AurPackage> packages;
-  for (const Json::Value &info : json["results"]) {
-    packages.push_back(AurPackage::FromJson(info));
+  const std::expected<std::size_t, std::string> result = RpcDecoder::Decode(
+      file_contents, [&packages](AurPackage package) {
+        packages.push_back(std::move(package));
+      });
+  if (!result.has_value()) {
+    return std::unexpected{result.error()};
   }
-  return RpcResponse{packages};
+  return RpcResponse{std::move(packages)};
+}
+
+std::expected<RawResponse, std::string> RawResponse::Parse(std::string bytes) {
+  return RawResponse{std::move(bytes)};
 }
 
 }  // namespace aurpp
\ No newline at end of file
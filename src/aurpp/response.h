@@ -8,13 +8,14 @@
 #include <expected>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace aurpp {
 
 struct RpcResponse {
   static std::expected<RpcResponse, std::string> Parse(
-      std::string file_contents);
+      std::string_view file_contents);
 
   constexpr RpcResponse() = default;
   constexpr explicit RpcResponse(std::vector<AurPackage> packages)
@@ -30,6 +31,8 @@ struct RpcResponse {
 };
 
 struct RawResponse {
+  static std::expected<RawResponse, std::string> Parse(std::string bytes);
+
   constexpr RawResponse() = default;
   constexpr explicit RawResponse(std::string bytes) : bytes(std::move(bytes)) {}
 
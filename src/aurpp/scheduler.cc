@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: MIT
+
+#include <aurpp/scheduler.h>
+
+#include <utility>
+
+namespace aurpp {
+
+TokenBucket::TokenBucket(const double rate, const double burst,
+                         const Clock::time_point now)
+    : rate_(std::max(rate, 0.001)),
+      burst_(std::max(burst, 1.0)),
+      tokens_(burst_),
+      updated_at_(now) {}
+
+TokenBucket::Clock::duration TokenBucket::TryTake(
+    const Clock::time_point now) {
+  if (now < paused_until_) {
+    return paused_until_ - now;
+  }
+
+  Refill(now);
+  if (tokens_ >= 1) {
+    tokens_ -= 1;
+    return Clock::duration::zero();
+  }
+  const std::chrono::duration<double> wait{(1 - tokens_) / rate_};
+  // Rounded up, so waiting that long always yields a token
+  return std::max(std::chrono::ceil<Clock::duration>(wait),
+                  Clock::duration{1});
+}
+
+void TokenBucket::PauseUntil(const Clock::time_point until) {
+  paused_until_ = std::max(paused_until_, until);
+}
+
+void TokenBucket::Refill(const Clock::time_point now) {
+  if (now <= updated_at_) {
+    return;
+  }
+  const std::chrono::duration<double> elapsed = now - updated_at_;
+  tokens_ = std::min(burst_, tokens_ + (elapsed.count() * rate_));
+  updated_at_ = now;
+}
+
+RequestScheduler::RequestScheduler(SchedulerOptions options)
+    : options_(options),
+      bucket_(options.requests_per_second, options.burst, Clock::now()),
+      random_(std::random_device{}()) {}
+
+RequestScheduler::Clock::duration RequestScheduler::TryStart(
+    const Clock::time_point now) {
+  std::lock_guard lock{mutex_};
+  return bucket_.TryTake(now);
+}
+
+void RequestScheduler::Throttle(const Clock::time_point until) {
+  std::lock_guard lock{mutex_};
+  bucket_.PauseUntil(until);
+}
+
+std::optional<RequestScheduler::Clock::duration> RequestScheduler::RetryDelay(
+    const int attempts, const std::optional<std::chrono::seconds> retry_after) {
+  if (attempts >= options_.max_attempts) {
+    return std::nullopt;
+  }
+  if (retry_after.has_value()) {
+    if (*retry_after > options_.max_delay) {
+      return std::nullopt;
+    }
+    return *retry_after;
+  }
+
+  // Full jitter spreads the retries of clients that failed together, so they
+  // don't all come back at the same time
+  const std::chrono::milliseconds ceiling = detail::BackoffCeiling(
+      attempts, options_.base_delay, options_.max_delay);
+  std::lock_guard lock{mutex_};
+  std::uniform_int_distribution<std::chrono::milliseconds::rep> jitter{
+      0, ceiling.count()};
+  return std::chrono::milliseconds{jitter(random_)};
+}
+
+RequestScheduler::Claim RequestScheduler::ClaimRequest(
+    const std::string &key) {
+  std::lock_guard lock{mutex_};
+  const auto [it, inserted] = in_flight_.try_emplace(key);
+  if (inserted) {
+    it->second.result = it->second.promise.get_future().share();
+  }
+  return Claim{.leader = inserted, .result = it->second.result};
+}
+
+void RequestScheduler::Publish(const std::string &key,
+                               const Result &result) {
+  std::lock_guard lock{mutex_};
+  const auto it = in_flight_.find(key);
+  if (it == in_flight_.end()) {
+    return;
+  }
+  it->second.promise.set_value(result);
+  in_flight_.erase(it);
+}
+
+}  // namespace aurpp
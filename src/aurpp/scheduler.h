@@ -0,0 +1,181 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef AURPP_SCHEDULER_H_
+#define AURPP_SCHEDULER_H_
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <expected>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace aurpp {
+
+// Limits the rate requests start at: tokens are added at a steady rate up to
+// a burst, and every request takes one
+class TokenBucket {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  TokenBucket(double rate, double burst, Clock::time_point now);
+
+  // Takes a token and returns zero if one is available at now, otherwise
+  // returns how long until one is
+  [[nodiscard]] Clock::duration TryTake(Clock::time_point now);
+
+  // Hands out no tokens before until, e.g. because the server asked to be
+  // left alone until then
+  void PauseUntil(Clock::time_point until);
+
+ private:
+  void Refill(Clock::time_point now);
+
+  double rate_;
+  double burst_;
+  double tokens_;
+  Clock::time_point updated_at_;
+  Clock::time_point paused_until_;
+};
+
+struct SchedulerOptions {
+  // How many requests may start per second on average, and how many may
+  // start at once after a quiet period. The AUR limits the requests per IP
+  // and day.
+  double requests_per_second = 5;
+  double burst = 20;
+  // Attempts per request, including the first. Only transient failures are
+  // retried, see detail::IsTransientFailure.
+  int max_attempts = 4;
+  // The backoff before the nth retry is drawn uniformly from zero to
+  // base_delay * 2^(n - 1), capped at max_delay. A server that asks for a
+  // longer pause than max_delay is not retried, so that every request
+  // finishes in bounded time.
+  std::chrono::milliseconds base_delay{250};
+  std::chrono::milliseconds max_delay{8000};
+  // Starts a second transfer for a request that is still running after
+  // this long and uses whichever finishes first. Zero disables hedging.
+  std::chrono::milliseconds hedge_after{0};
+};
+
+namespace detail {
+
+// Whether a request that failed with result and http_code may succeed when
+// tried again: dropped or refused connections, timeouts, rate limiting and
+// server errors
+constexpr bool IsTransientFailure(const CURLcode result,
+                                  const long http_code) {
+  switch (result) {
+    case CURLE_OK:
+      return http_code == 408 || http_code == 429 || http_code == 500 ||
+             http_code == 502 || http_code == 503 || http_code == 504;
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_OPERATION_TIMEDOUT:
+    case CURLE_SSL_CONNECT_ERROR:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_GOT_NOTHING:
+    case CURLE_PARTIAL_FILE:
+    case CURLE_HTTP2:
+    case CURLE_HTTP2_STREAM:
+    case CURLE_HTTP3:
+    case CURLE_QUIC_CONNECT_ERROR:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Parses a Retry-After header given in seconds. Dates are not supported and
+// yield nullopt like malformed values, so the usual backoff applies.
+constexpr std::optional<std::chrono::seconds> ParseRetryAfter(
+    const std::string_view value) {
+  long seconds = 0;
+  const auto [ptr, ec] =
+      std::from_chars(value.data(), value.data() + value.size(), seconds);
+  if (ec != std::errc{} || ptr != value.data() + value.size() ||
+      seconds < 0) {
+    return std::nullopt;
+  }
+  return std::chrono::seconds{seconds};
+}
+
+// The longest backoff before retrying a request that failed attempts times,
+// see SchedulerOptions
+constexpr std::chrono::milliseconds BackoffCeiling(
+    const int attempts, const std::chrono::milliseconds base_delay,
+    const std::chrono::milliseconds max_delay) {
+  std::chrono::milliseconds ceiling = base_delay;
+  for (int i = 1; i < attempts && ceiling < max_delay; ++i) {
+    ceiling *= 2;
+  }
+  return std::min(ceiling, max_delay);
+}
+
+}  // namespace detail
+
+// Decides when the requests of one or more Clients start, and is shared by
+// them, from any number of threads. It limits the request rate with a token
+// bucket, spaces out retries with jittered exponential backoff, and lets
+// identical requests that are in flight at the same time share one transfer.
+class RequestScheduler {
+ public:
+  using Clock = TokenBucket::Clock;
+  using Result = std::expected<std::string, std::string>;
+
+  // Either this caller performs the request and publishes its result, or it
+  // waits for the result of the caller that does
+  struct Claim {
+    bool leader = false;
+    std::shared_future<Result> result;
+  };
+
+  explicit RequestScheduler(SchedulerOptions options = {});
+
+  // Takes a token and returns zero if a request may start at now, otherwise
+  // returns how long to wait before asking again
+  [[nodiscard]] Clock::duration TryStart(Clock::time_point now);
+
+  // Starts no requests before until
+  void Throttle(Clock::time_point until);
+
+  // Returns how long to wait before retrying a request that failed attempts
+  // times, or nullopt if it should not be retried. retry_after is the
+  // server's Retry-After header, if any.
+  [[nodiscard]] std::optional<Clock::duration> RetryDelay(
+      int attempts, std::optional<std::chrono::seconds> retry_after);
+
+  // Claims the request identified by key, see ResponseCache::Key. The leader
+  // must Publish the result, which completes the future of every other
+  // claim made for the key in the meantime.
+  [[nodiscard]] Claim ClaimRequest(const std::string &key);
+
+  void Publish(const std::string &key, const Result &result);
+
+  [[nodiscard]] const SchedulerOptions &options() const noexcept {
+    return options_;
+  }
+
+ private:
+  struct InFlight {
+    std::promise<Result> promise;
+    std::shared_future<Result> result;
+  };
+
+  SchedulerOptions options_;
+  std::mutex mutex_;
+  TokenBucket bucket_;
+  std::minstd_rand random_;
+  std::unordered_map<std::string, InFlight> in_flight_;
+};
+
+}  // namespace aurpp
+
+#endif  // AURPP_SCHEDULER_H_
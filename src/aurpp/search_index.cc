@@ -0,0 +1,802 @@
+// SPDX-License-Identifier: MIT
+
+#include <aurpp/atomic_file.h>
+#include <aurpp/mirror.h>
+#include <aurpp/search_index.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+using aurpp::detail::DocRecord;
+using aurpp::detail::DocStats;
+using aurpp::detail::IndexSegment;
+using aurpp::detail::SegmentHeader;
+using aurpp::detail::StringRef;
+using aurpp::detail::TermEntry;
+using aurpp::detail::TrigramEntry;
+using SearchBy = aurpp::SearchRequest::SearchBy;
+
+constexpr std::string_view kManifestName = "manifest";
+constexpr std::string_view kManifestMagic = "yarp-index-v1";
+
+// Trigram fields, stored in the top byte of a trigram key
+constexpr std::uint32_t kNameTrigrams = 0;
+constexpr std::uint32_t kDescriptionTrigrams = 1;
+
+// The delta is merged into a new base once it holds more than this fraction
+// of the base documents, so searches never scan a large delta
+constexpr std::size_t kMaxDeltaFraction = 4;
+
+constexpr std::size_t kSectionAlignment = 8;
+
+constexpr char ToLower(const char c) {
+  return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+constexpr std::uint32_t TrigramKey(const std::uint32_t field,
+                                   const std::string_view trigram) {
+  return field << 24 |
+         static_cast<std::uint32_t>(
+             static_cast<unsigned char>(ToLower(trigram[0])))
+             << 16 |
+         static_cast<std::uint32_t>(
+             static_cast<unsigned char>(ToLower(trigram[1])))
+             << 8 |
+         static_cast<std::uint32_t>(
+             static_cast<unsigned char>(ToLower(trigram[2])));
+}
+
+// The distinct trigram keys of text, sorted
+std::vector<std::uint32_t> Trigrams(const std::uint32_t field,
+                                    const std::string_view text) {
+  std::vector<std::uint32_t> keys;
+  if (text.size() < 3) {
+    return keys;
+  }
+  keys.reserve(text.size() - 2);
+  for (std::size_t i = 0; i + 3 <= text.size(); ++i) {
+    keys.push_back(TrigramKey(field, text.substr(i, 3)));
+  }
+  std::ranges::sort(keys);
+  const auto [first, last] = std::ranges::unique(keys);
+  keys.erase(first, last);
+  return keys;
+}
+
+// FNV-1a over everything that is indexed, so that a package only needs to be
+// indexed again when the hash changes. Fields are separated by a byte that
+// can't appear in them.
+class ContentHasher {
+ public:
+  void Add(const std::string_view data) {
+    for (const char c : data) {
+      hash_ ^= static_cast<unsigned char>(c);
+      hash_ *= 0x100000001b3;
+    }
+    hash_ ^= 0xff;
+    hash_ *= 0x100000001b3;
+  }
+
+  [[nodiscard]] std::uint64_t hash() const noexcept { return hash_; }
+
+ private:
+  std::uint64_t hash_ = 0xcbf29ce484222325;
+};
+
+std::uint64_t ContentHash(const aurpp::AurPackage &package) {
+  ContentHasher hasher;
+  hasher.Add(package.name());
+  hasher.Add(package.version());
+  hasher.Add(package.description().value_or(""));
+  for (const SearchBy field : aurpp::detail::kExactSearchFields) {
+    aurpp::detail::ForEachSearchTerm(
+        package, field,
+        [&hasher](const std::string_view term) { hasher.Add(term); });
+    hasher.Add({});
+  }
+  return hasher.hash();
+}
+
+DocStats StatsOf(const aurpp::AurPackage &package) {
+  return DocStats{
+      .popularity = package.popularity(),
+      .out_of_date = package.out_of_date().value_or(0),
+      .num_votes = package.num_votes(),
+      .has_out_of_date = package.out_of_date().has_value() ? 1U : 0U,
+  };
+}
+
+// Collects documents and their postings in memory and writes them out as one
+// segment file
+class SegmentWriter {
+ public:
+  void Add(const aurpp::AurPackage &package, const std::uint64_t content_hash) {
+    const auto ordinal = static_cast<std::uint32_t>(docs_.size());
+    DocRecord &doc = docs_.emplace_back();
+    doc.content_hash = content_hash;
+    doc.stats = StatsOf(package);
+    doc.id = static_cast<std::uint32_t>(package.id());
+    doc.last_modified = package.last_modified();
+    doc.name = AddString(package.name());
+    doc.version = AddString(package.version());
+    if (const auto description = package.description()) {
+      doc.description = AddString(description.value());
+    }
+
+    AddTrigrams(kNameTrigrams, package.name(), ordinal);
+    AddTrigrams(kDescriptionTrigrams, package.description().value_or(""),
+                ordinal);
+    for (const SearchBy field : aurpp::detail::kExactSearchFields) {
+      aurpp::detail::ForEachSearchTerm(
+          package, field, [this, field, ordinal](const std::string_view term) {
+            AddTerm(static_cast<std::uint32_t>(field), term, ordinal);
+          });
+    }
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return docs_.size(); }
+
+  void set_tombstones(std::vector<std::uint32_t> tombstones) {
+    tombstones_ = std::move(tombstones);
+  }
+
+  void set_base_stats(std::vector<DocStats> base_stats) {
+    base_stats_ = std::move(base_stats);
+  }
+
+  std::expected<void, std::string> Write(
+      const std::filesystem::path &path) const;
+
+ private:
+  struct TermPostings {
+    StringRef term;
+    std::vector<std::uint32_t> postings;
+  };
+
+  StringRef AddString(const std::string_view value) {
+    const StringRef ref{static_cast<std::uint32_t>(strings_.size()),
+                        static_cast<std::uint32_t>(value.size())};
+    strings_.append(value);
+    return ref;
+  }
+
+  void AddTrigrams(const std::uint32_t field, const std::string_view text,
+                   const std::uint32_t ordinal) {
+    for (const std::uint32_t key : Trigrams(field, text)) {
+      trigrams_[key].push_back(ordinal);
+    }
+  }
+
+  void AddTerm(const std::uint32_t field, const std::string_view term,
+               const std::uint32_t ordinal) {
+    auto &field_terms = terms_[field];
+    auto it = field_terms.find(term);
+    if (it == field_terms.end()) {
+      it = field_terms.emplace(term, TermPostings{AddString(term), {}}).first;
+    }
+    // A package can list a relation more than once, e.g. with a lower and
+    // an upper version bound
+    std::vector<std::uint32_t> &postings = it->second.postings;
+    if (postings.empty() || postings.back() != ordinal) {
+      postings.push_back(ordinal);
+    }
+  }
+
+  std::string strings_;
+  std::vector<DocRecord> docs_;
+  // Ordered by field and term, the order the segment is searched in
+  std::map<std::uint32_t, std::map<std::string, TermPostings, std::less<>>>
+      terms_;
+  std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> trigrams_;
+  std::vector<std::uint32_t> tombstones_;
+  std::vector<DocStats> base_stats_;
+};
+
+std::expected<void, std::string> SegmentWriter::Write(
+    const std::filesystem::path &path) const {
+  std::vector<std::uint32_t> postings;
+  std::vector<TermEntry> terms;
+  for (const auto &[field, field_terms] : terms_) {
+    for (const auto &[text, term] : field_terms) {
+      terms.push_back(TermEntry{
+          .field = field,
+          .term = term.term,
+          .first_posting = static_cast<std::uint32_t>(postings.size()),
+          .posting_count = static_cast<std::uint32_t>(term.postings.size()),
+      });
+      postings.insert(postings.end(), term.postings.begin(),
+                      term.postings.end());
+    }
+  }
+
+  std::vector<std::uint32_t> trigram_keys;
+  trigram_keys.reserve(trigrams_.size());
+  for (const auto &[key, trigram_postings] : trigrams_) {
+    trigram_keys.push_back(key);
+  }
+  std::ranges::sort(trigram_keys);
+
+  std::vector<TrigramEntry> trigrams;
+  trigrams.reserve(trigram_keys.size());
+  for (const std::uint32_t key : trigram_keys) {
+    const std::vector<std::uint32_t> &trigram_postings = trigrams_.at(key);
+    trigrams.push_back(TrigramEntry{
+        .key = key,
+        .first_posting = static_cast<std::uint32_t>(postings.size()),
+        .posting_count = static_cast<std::uint32_t>(trigram_postings.size()),
+    });
+    postings.insert(postings.end(), trigram_postings.begin(),
+                    trigram_postings.end());
+  }
+
+  if (strings_.size() >= StringRef::kAbsent ||
+      postings.size() >= std::numeric_limits<std::uint32_t>::max()) {
+    return std::unexpected{"Search index is too large"};
+  }
+
+  SegmentHeader header{};
+  std::memcpy(header.magic, IndexSegment::kMagic, sizeof(header.magic));
+  header.doc_count = static_cast<std::uint32_t>(docs_.size());
+  header.term_count = static_cast<std::uint32_t>(terms.size());
+  header.trigram_count = static_cast<std::uint32_t>(trigrams.size());
+  header.posting_count = static_cast<std::uint32_t>(postings.size());
+  header.tombstone_count = static_cast<std::uint32_t>(tombstones_.size());
+  header.base_stats_count = static_cast<std::uint32_t>(base_stats_.size());
+  header.string_size = static_cast<std::uint32_t>(strings_.size());
+
+  // Every section starts at an aligned offset so it can be used in place
+  std::uint64_t offset = sizeof(SegmentHeader);
+  const auto place = [&offset](const std::size_t size) {
+    offset = (offset + kSectionAlignment - 1) / kSectionAlignment *
+             kSectionAlignment;
+    const std::uint64_t start = offset;
+    offset += size;
+    return start;
+  };
+  header.docs_offset = place(docs_.size() * sizeof(DocRecord));
+  header.terms_offset = place(terms.size() * sizeof(TermEntry));
+  header.trigrams_offset = place(trigrams.size() * sizeof(TrigramEntry));
+  header.postings_offset = place(postings.size() * sizeof(std::uint32_t));
+  header.tombstones_offset =
+      place(tombstones_.size() * sizeof(std::uint32_t));
+  header.base_stats_offset = place(base_stats_.size() * sizeof(DocStats));
+  header.strings_offset = place(strings_.size());
+
+  std::ofstream file{path, std::ios::binary | std::ios::trunc};
+  if (!file) {
+    return std::unexpected{
+        std::format("Could not create search index {}", path.string())};
+  }
+
+  const auto write_at = [&file](const std::uint64_t at, const void *data,
+                                const std::size_t size) {
+    static constexpr char kPadding[kSectionAlignment] = {};
+    const auto position = static_cast<std::uint64_t>(file.tellp());
+    file.write(kPadding, static_cast<std::streamsize>(at - position));
+    file.write(static_cast<const char *>(data),
+               static_cast<std::streamsize>(size));
+  };
+  write_at(0, &header, sizeof(header));
+  write_at(header.docs_offset, docs_.data(),
+           docs_.size() * sizeof(DocRecord));
+  write_at(header.terms_offset, terms.data(),
+           terms.size() * sizeof(TermEntry));
+  write_at(header.trigrams_offset, trigrams.data(),
+           trigrams.size() * sizeof(TrigramEntry));
+  write_at(header.postings_offset, postings.data(),
+           postings.size() * sizeof(std::uint32_t));
+  write_at(header.tombstones_offset, tombstones_.data(),
+           tombstones_.size() * sizeof(std::uint32_t));
+  write_at(header.base_stats_offset, base_stats_.data(),
+           base_stats_.size() * sizeof(DocStats));
+  write_at(header.strings_offset, strings_.data(), strings_.size());
+
+  if (!file.flush()) {
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    return std::unexpected{
+        std::format("Could not write search index {}", path.string())};
+  }
+  return {};
+}
+
+// Checks that count elements of T at offset lie within bytes and are
+// suitably aligned, and returns them
+template <typename T>
+std::optional<std::span<const T>> Section(
+    const std::span<const std::byte> bytes, const std::uint64_t offset,
+    const std::size_t count) {
+  if (offset % alignof(T) != 0 || offset > bytes.size() ||
+      count > (bytes.size() - offset) / sizeof(T)) {
+    return std::nullopt;
+  }
+  return std::span{reinterpret_cast<const T *>(bytes.data() + offset), count};
+}
+
+std::vector<std::uint32_t> Intersect(const std::span<const std::uint32_t> a,
+                                     const std::span<const std::uint32_t> b) {
+  std::vector<std::uint32_t> result;
+  std::ranges::set_intersection(a, b, std::back_inserter(result));
+  return result;
+}
+
+// The documents whose trigram field contains term, ignoring case
+std::vector<std::uint32_t> SubstringMatches(const IndexSegment &segment,
+                                            const std::uint32_t field,
+                                            const std::string_view term) {
+  const auto text_of = [&segment, field](const DocRecord &doc) {
+    return segment.String(field == kNameTrigrams ? doc.name : doc.description);
+  };
+
+  std::vector<std::uint32_t> matches;
+  if (term.size() < 3) {
+    // Too short for a trigram, but short terms are rare enough to scan for
+    for (std::uint32_t i = 0; i < segment.docs().size(); ++i) {
+      if (aurpp::detail::ContainsIgnoreCase(text_of(segment.docs()[i]),
+                                            term)) {
+        matches.push_back(i);
+      }
+    }
+    return matches;
+  }
+
+  // Intersecting the rarest trigrams first keeps the candidate set small
+  std::vector<std::span<const std::uint32_t>> postings;
+  for (const std::uint32_t key : Trigrams(field, term)) {
+    postings.push_back(segment.TrigramPostings(key));
+  }
+  std::ranges::sort(postings, {}, &std::span<const std::uint32_t>::size);
+
+  std::vector<std::uint32_t> candidates(postings.front().begin(),
+                                        postings.front().end());
+  for (std::size_t i = 1; i < postings.size() && !candidates.empty(); ++i) {
+    candidates = Intersect(candidates, postings[i]);
+  }
+
+  // Every trigram matching doesn't mean they are adjacent in the text
+  for (const std::uint32_t candidate : candidates) {
+    if (candidate < segment.docs().size() &&
+        aurpp::detail::ContainsIgnoreCase(text_of(segment.docs()[candidate]),
+                                          term)) {
+      matches.push_back(candidate);
+    }
+  }
+  return matches;
+}
+
+std::vector<std::uint32_t> TermMatches(const IndexSegment &segment,
+                                       const SearchBy search_by,
+                                       const std::string_view term) {
+  switch (search_by) {
+    case SearchBy::kName:
+      return SubstringMatches(segment, kNameTrigrams, term);
+    case SearchBy::kNameDesc: {
+      const std::vector<std::uint32_t> names =
+          SubstringMatches(segment, kNameTrigrams, term);
+      const std::vector<std::uint32_t> descriptions =
+          SubstringMatches(segment, kDescriptionTrigrams, term);
+      std::vector<std::uint32_t> matches;
+      std::ranges::set_union(names, descriptions, std::back_inserter(matches));
+      return matches;
+    }
+    default: {
+      const std::span<const std::uint32_t> postings =
+          segment.TermPostings(static_cast<std::uint32_t>(search_by), term);
+      return {postings.begin(), postings.end()};
+    }
+  }
+}
+
+// The sorted ordinals of the documents in segment that match every term
+std::vector<std::uint32_t> Match(
+    const IndexSegment &segment, const SearchBy search_by,
+    const std::span<const std::string_view> terms) {
+  std::vector<std::uint32_t> matches =
+      TermMatches(segment, search_by, terms.front());
+  for (const std::string_view term : terms.subspan(1)) {
+    if (matches.empty()) {
+      break;
+    }
+    matches = Intersect(matches, TermMatches(segment, search_by, term));
+  }
+  return matches;
+}
+
+aurpp::AurPackage ToPackage(const IndexSegment &segment, const DocRecord &doc,
+                            const DocStats &stats) {
+  aurpp::AurPackage package{};
+  package.set_name(segment.String(doc.name));
+  package.set_version(segment.String(doc.version));
+  if (doc.description.has_value()) {
+    package.set_description(segment.String(doc.description));
+  }
+  package.set_num_votes(stats.num_votes);
+  package.set_popularity(stats.popularity);
+  if (stats.has_out_of_date != 0) {
+    package.set_out_of_date(stats.out_of_date);
+  }
+  package.set_id(static_cast<int>(doc.id));
+  package.set_last_modified(doc.last_modified);
+  return package;
+}
+
+// A file name that no other update, in this or another process, uses
+std::string UniqueSegmentName(const std::string_view kind) {
+  static std::atomic<unsigned> counter{0};
+  return std::format(
+      "{}-{}-{}-{}.seg", kind,
+      std::chrono::system_clock::now().time_since_epoch().count(), getpid(),
+      counter++);
+}
+
+}  // namespace
+
+namespace aurpp {
+
+namespace detail {
+
+std::expected<MappedFile, std::string> MappedFile::Open(
+    const std::filesystem::path &path) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return std::unexpected{std::format("Could not open {}", path.string())};
+  }
+
+  struct stat st{};
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return std::unexpected{std::format("Could not read {}", path.string())};
+  }
+
+  MappedFile file;
+  file.size_ = static_cast<std::size_t>(st.st_size);
+  file.data_ = mmap(nullptr, file.size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after the descriptor is closed
+  close(fd);
+  if (file.data_ == MAP_FAILED) {
+    file.data_ = nullptr;
+    return std::unexpected{std::format("Could not map {}", path.string())};
+  }
+  return file;
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    if (data_ != nullptr) {
+      munmap(data_, size_);
+    }
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+std::expected<IndexSegment, std::string> IndexSegment::Open(
+    const std::filesystem::path &path) {
+  std::expected<MappedFile, std::string> file = MappedFile::Open(path);
+  if (!file.has_value()) {
+    return std::unexpected{std::move(file.error())};
+  }
+
+  const std::span<const std::byte> bytes = file->bytes();
+  SegmentHeader header;
+  if (bytes.size() < sizeof(header)) {
+    return std::unexpected{std::format("{} is truncated", path.string())};
+  }
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != SegmentHeader::kVersion) {
+    return std::unexpected{
+        std::format("{} is not a search index", path.string())};
+  }
+
+  const auto docs =
+      Section<DocRecord>(bytes, header.docs_offset, header.doc_count);
+  const auto terms =
+      Section<TermEntry>(bytes, header.terms_offset, header.term_count);
+  const auto trigrams = Section<TrigramEntry>(bytes, header.trigrams_offset,
+                                              header.trigram_count);
+  const auto postings = Section<std::uint32_t>(bytes, header.postings_offset,
+                                               header.posting_count);
+  const auto tombstones = Section<std::uint32_t>(
+      bytes, header.tombstones_offset, header.tombstone_count);
+  const auto base_stats = Section<DocStats>(bytes, header.base_stats_offset,
+                                            header.base_stats_count);
+  const auto strings =
+      Section<char>(bytes, header.strings_offset, header.string_size);
+  if (!docs || !terms || !trigrams || !postings || !tombstones ||
+      !base_stats || !strings) {
+    return std::unexpected{std::format("{} is truncated", path.string())};
+  }
+
+  IndexSegment segment;
+  segment.file_ = std::move(file.value());
+  segment.docs_ = docs.value();
+  segment.terms_ = terms.value();
+  segment.trigrams_ = trigrams.value();
+  segment.postings_ = postings.value();
+  segment.tombstones_ = tombstones.value();
+  segment.base_stats_ = base_stats.value();
+  segment.strings_ = std::string_view{strings->data(), strings->size()};
+  return segment;
+}
+
+std::string_view IndexSegment::String(const StringRef ref) const noexcept {
+  if (!ref.has_value() || ref.offset > strings_.size()) {
+    return {};
+  }
+  return strings_.substr(ref.offset, ref.size);
+}
+
+std::span<const std::uint32_t> IndexSegment::TermPostings(
+    const std::uint32_t field, const std::string_view term) const {
+  const auto it = std::ranges::lower_bound(
+      terms_, std::pair{field, term}, {}, [this](const TermEntry &entry) {
+        return std::pair{entry.field, String(entry.term)};
+      });
+  if (it == terms_.end() || it->field != field || String(it->term) != term ||
+      it->first_posting > postings_.size()) {
+    return {};
+  }
+  return postings_.subspan(it->first_posting).first(
+      std::min<std::size_t>(it->posting_count,
+                            postings_.size() - it->first_posting));
+}
+
+std::span<const std::uint32_t> IndexSegment::TrigramPostings(
+    const std::uint32_t key) const {
+  const auto it =
+      std::ranges::lower_bound(trigrams_, key, {}, &TrigramEntry::key);
+  if (it == trigrams_.end() || it->key != key ||
+      it->first_posting > postings_.size()) {
+    return {};
+  }
+  return postings_.subspan(it->first_posting).first(
+      std::min<std::size_t>(it->posting_count,
+                            postings_.size() - it->first_posting));
+}
+
+}  // namespace detail
+
+SearchIndex SearchIndex::Open(std::filesystem::path directory) {
+  SearchIndex index{std::move(directory)};
+
+  std::ifstream manifest{index.directory_ / kManifestName};
+  std::string magic;
+  std::string source;
+  std::string base_file;
+  std::string delta_file;
+  if (!std::getline(manifest, magic) || magic != kManifestMagic ||
+      !std::getline(manifest, source) || !std::getline(manifest, base_file) ||
+      !std::getline(manifest, delta_file)) {
+    return index;
+  }
+
+  std::expected<detail::IndexSegment, std::string> base =
+      detail::IndexSegment::Open(index.directory_ / base_file);
+  if (!base.has_value()) {
+    return index;
+  }
+  std::optional<detail::IndexSegment> delta;
+  if (!delta_file.empty()) {
+    std::expected<detail::IndexSegment, std::string> maybe_delta =
+        detail::IndexSegment::Open(index.directory_ / delta_file);
+    if (!maybe_delta.has_value()) {
+      return index;
+    }
+    delta = std::move(maybe_delta.value());
+  }
+
+  index.source_ = std::move(source);
+  index.base_ = std::move(base.value());
+  index.delta_ = std::move(delta);
+  index.base_file_ = std::move(base_file);
+  index.delta_file_ = std::move(delta_file);
+  return index;
+}
+
+std::expected<SearchIndex::UpdateStats, std::string> SearchIndex::Update(
+    const std::span<const AurPackage> packages, std::string source) {
+  std::error_code ec;
+  std::filesystem::create_directories(directory_, ec);
+
+  UpdateStats stats;
+  SegmentWriter delta;
+  std::vector<std::uint32_t> tombstones;
+  std::vector<DocStats> base_stats;
+
+  if (base_.has_value()) {
+    const std::span<const DocRecord> base_docs = base_->docs();
+    std::unordered_map<std::uint32_t, std::uint32_t> ordinals;
+    ordinals.reserve(base_docs.size());
+    for (std::uint32_t i = 0; i < base_docs.size(); ++i) {
+      ordinals.try_emplace(base_docs[i].id, i);
+    }
+
+    std::vector<bool> current(base_docs.size(), false);
+    base_stats.resize(base_docs.size());
+    for (const AurPackage &package : packages) {
+      const std::uint64_t hash = ContentHash(package);
+      const auto it = ordinals.find(static_cast<std::uint32_t>(package.id()));
+      if (it != ordinals.end() && !current[it->second] &&
+          base_docs[it->second].content_hash == hash) {
+        current[it->second] = true;
+        base_stats[it->second] = StatsOf(package);
+      } else {
+        delta.Add(package, hash);
+      }
+    }
+
+    for (std::uint32_t i = 0; i < base_docs.size(); ++i) {
+      if (!current[i]) {
+        tombstones.push_back(i);
+      }
+    }
+  }
+
+  const bool rebuild =
+      !base_.has_value() ||
+      (delta.size() + tombstones.size()) * kMaxDeltaFraction >
+          base_->docs().size();
+
+  std::string new_base_file = base_file_;
+  std::string new_delta_file;
+  if (rebuild) {
+    SegmentWriter base;
+    for (const AurPackage &package : packages) {
+      base.Add(package, ContentHash(package));
+    }
+    new_base_file = UniqueSegmentName("base");
+    if (auto result = base.Write(directory_ / new_base_file);
+        !result.has_value()) {
+      return std::unexpected{std::move(result.error())};
+    }
+    stats = UpdateStats{.indexed = base.size(), .removed = 0, .rebuilt = true};
+  } else {
+    stats = UpdateStats{.indexed = delta.size(),
+                        .removed = tombstones.size(),
+                        .rebuilt = false};
+    delta.set_tombstones(std::move(tombstones));
+    delta.set_base_stats(std::move(base_stats));
+    new_delta_file = UniqueSegmentName("delta");
+    if (auto result = delta.Write(directory_ / new_delta_file);
+        !result.has_value()) {
+      return std::unexpected{std::move(result.error())};
+    }
+  }
+
+  // Open the new segments before publishing them, so a segment that can't be
+  // read never replaces a working index
+  std::optional<detail::IndexSegment> new_base;
+  if (rebuild) {
+    std::expected<detail::IndexSegment, std::string> opened =
+        detail::IndexSegment::Open(directory_ / new_base_file);
+    if (!opened.has_value()) {
+      return std::unexpected{std::move(opened.error())};
+    }
+    new_base = std::move(opened.value());
+  }
+  std::optional<detail::IndexSegment> new_delta;
+  if (!rebuild) {
+    std::expected<detail::IndexSegment, std::string> opened =
+        detail::IndexSegment::Open(directory_ / new_delta_file);
+    if (!opened.has_value()) {
+      return std::unexpected{std::move(opened.error())};
+    }
+    new_delta = std::move(opened.value());
+  }
+
+  // Readers only ever see a complete manifest
+  if (auto result = WriteFileAtomically(
+          directory_ / kManifestName,
+          std::format("{}\n{}\n{}\n{}\n", kManifestMagic, source,
+                      new_base_file, new_delta_file));
+      !result.has_value()) {
+    return std::unexpected{std::format(
+        "Could not write the search index manifest: {}", result.error())};
+  }
+
+  // Segments that are still mapped, here or in another process, stay
+  // readable after they are removed
+  if (!delta_file_.empty()) {
+    std::filesystem::remove(directory_ / delta_file_, ec);
+  }
+  if (rebuild && !base_file_.empty()) {
+    std::filesystem::remove(directory_ / base_file_, ec);
+  }
+
+  source_ = std::move(source);
+  if (new_base.has_value()) {
+    base_ = std::move(new_base);
+  }
+  delta_ = std::move(new_delta);
+  base_file_ = std::move(new_base_file);
+  delta_file_ = std::move(new_delta_file);
+  return stats;
+}
+
+std::expected<RpcResponse, std::string> SearchIndex::Search(
+    const SearchBy search_by,
+    const std::span<const std::string_view> terms) const {
+  for (const std::string_view term : terms) {
+    if (std::expected<void, std::string> valid =
+            detail::ValidateSearch(search_by, term);
+        !valid.has_value()) {
+      return std::unexpected{std::move(valid.error())};
+    }
+  }
+  if (terms.empty() || !base_.has_value()) {
+    return RpcResponse{};
+  }
+
+  std::vector<AurPackage> packages;
+  const std::span<const DocRecord> base_docs = base_->docs();
+  const std::span<const std::uint32_t> tombstones =
+      delta_.has_value() ? delta_->tombstones()
+                         : std::span<const std::uint32_t>{};
+  const std::span<const DocStats> base_stats =
+      delta_.has_value() && delta_->base_stats().size() == base_docs.size()
+          ? delta_->base_stats()
+          : std::span<const DocStats>{};
+
+  for (const std::uint32_t ordinal : Match(*base_, search_by, terms)) {
+    if (ordinal >= base_docs.size() ||
+        std::ranges::binary_search(tombstones, ordinal)) {
+      continue;
+    }
+    const DocRecord &doc = base_docs[ordinal];
+    packages.push_back(ToPackage(
+        *base_, doc, base_stats.empty() ? doc.stats : base_stats[ordinal]));
+  }
+
+  if (delta_.has_value()) {
+    const std::span<const DocRecord> delta_docs = delta_->docs();
+    for (const std::uint32_t ordinal : Match(*delta_, search_by, terms)) {
+      if (ordinal < delta_docs.size()) {
+        const DocRecord &doc = delta_docs[ordinal];
+        packages.push_back(ToPackage(*delta_, doc, doc.stats));
+      }
+    }
+  }
+
+  std::ranges::sort(packages, {}, &AurPackage::name);
+  return RpcResponse{std::move(packages)};
+}
+
+std::size_t SearchIndex::size() const noexcept {
+  if (!base_.has_value()) {
+    return 0;
+  }
+  if (!delta_.has_value()) {
+    return base_->docs().size();
+  }
+  return base_->docs().size() - delta_->tombstones().size() +
+         delta_->docs().size();
+}
+
+}  // namespace aurpp
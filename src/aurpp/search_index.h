@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef AURPP_SEARCH_INDEX_H_
+#define AURPP_SEARCH_INDEX_H_
+
+#include <aurpp/compact.h>
+#include <aurpp/package.h>
+#include <aurpp/request.h>
+#include <aurpp/response.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace aurpp {
+
+namespace detail {
+
+// A read-only memory mapping of a whole file
+class MappedFile {
+ public:
+  static std::expected<MappedFile, std::string> Open(
+      const std::filesystem::path &path);
+
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  [[nodiscard]] std::span<const std::byte> bytes() const noexcept {
+    return {static_cast<const std::byte *>(data_), size_};
+  }
+
+ private:
+  void *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+// The fields of a package that change without a new upload, and so without
+// re-indexing it
+struct DocStats {
+  double popularity = 0;
+  std::uint64_t out_of_date = 0;
+  std::int32_t num_votes = 0;
+  std::uint32_t has_out_of_date = 0;
+};
+
+// A package in a segment. Only the fields needed to print search results are
+// stored, everything else is looked up in the metadata when needed.
+struct DocRecord {
+  std::uint64_t content_hash = 0;
+  DocStats stats;
+  std::uint32_t id = 0;
+  std::int32_t last_modified = 0;
+  StringRef name;
+  StringRef version;
+  StringRef description;
+};
+
+// The postings of an exact-match term, ordered by (field, term)
+struct TermEntry {
+  std::uint32_t field = 0;
+  StringRef term;
+  std::uint32_t first_posting = 0;
+  std::uint32_t posting_count = 0;
+};
+
+// The postings of a trigram, ordered by key. The key holds the field in the
+// top byte and the three lowercased characters below it.
+struct TrigramEntry {
+  std::uint32_t key = 0;
+  std::uint32_t first_posting = 0;
+  std::uint32_t posting_count = 0;
+};
+
+struct SegmentHeader {
+  static constexpr std::uint32_t kVersion = 1;
+
+  char magic[8];
+  std::uint32_t version = kVersion;
+  std::uint32_t doc_count = 0;
+  std::uint32_t term_count = 0;
+  std::uint32_t trigram_count = 0;
+  std::uint32_t posting_count = 0;
+  std::uint32_t tombstone_count = 0;
+  std::uint32_t base_stats_count = 0;
+  std::uint32_t string_size = 0;
+  std::uint64_t docs_offset = 0;
+  std::uint64_t terms_offset = 0;
+  std::uint64_t trigrams_offset = 0;
+  std::uint64_t postings_offset = 0;
+  std::uint64_t tombstones_offset = 0;
+  std::uint64_t base_stats_offset = 0;
+  std::uint64_t strings_offset = 0;
+};
+
+// An immutable index file. A delta segment additionally lists the documents
+// of the base segment it replaces or deletes, and the current stats of the
+// base documents.
+class IndexSegment {
+ public:
+  static constexpr char kMagic[8] = {'y', 'a', 'r', 'p', 'i', 'd', 'x', '1'};
+
+  static std::expected<IndexSegment, std::string> Open(
+      const std::filesystem::path &path);
+
+  [[nodiscard]] std::span<const DocRecord> docs() const noexcept {
+    return docs_;
+  }
+
+  // Sorted ordinals of base documents that are no longer current
+  [[nodiscard]] std::span<const std::uint32_t> tombstones() const noexcept {
+    return tombstones_;
+  }
+
+  // Stats of the base documents by ordinal, or empty
+  [[nodiscard]] std::span<const DocStats> base_stats() const noexcept {
+    return base_stats_;
+  }
+
+  [[nodiscard]] std::string_view String(StringRef ref) const noexcept;
+
+  [[nodiscard]] std::span<const std::uint32_t> TermPostings(
+      std::uint32_t field, std::string_view term) const;
+
+  [[nodiscard]] std::span<const std::uint32_t> TrigramPostings(
+      std::uint32_t key) const;
+
+ private:
+  MappedFile file_;
+  std::span<const DocRecord> docs_;
+  std::span<const TermEntry> terms_;
+  std::span<const TrigramEntry> trigrams_;
+  std::span<const std::uint32_t> postings_;
+  std::span<const std::uint32_t> tombstones_;
+  std::span<const DocStats> base_stats_;
+  std::string_view strings_;
+};
+
+}  // namespace detail
+
+// A persistent inverted index over AUR metadata for searching without the
+// RPC interface. Names and descriptions are searched for substrings through
+// trigram postings, the other fields through exact-term postings. The index
+// lives in a directory as a memory-mapped base segment plus a delta segment,
+// so an update only re-indexes the packages that changed since the base was
+// built.
+class SearchIndex {
+ public:
+  using SearchBy = SearchRequest::SearchBy;
+
+  struct UpdateStats {
+    // The number of packages that were (re-)indexed
+    std::size_t indexed = 0;
+    // The number of base packages that were replaced or deleted
+    std::size_t removed = 0;
+    // Whether the whole index was rebuilt
+    bool rebuilt = false;
+  };
+
+  // Opens the index in directory. A missing or unreadable index opens as an
+  // empty index that needs an Update.
+  static SearchIndex Open(std::filesystem::path directory);
+
+  SearchIndex(const SearchIndex &) = delete;
+  SearchIndex &operator=(const SearchIndex &) = delete;
+
+  SearchIndex(SearchIndex &&) = default;
+  SearchIndex &operator=(SearchIndex &&) = default;
+
+  // Brings the index up to date with packages and persists it. Packages are
+  // matched with the indexed ones by ID, and only those whose indexed fields
+  // changed are indexed again. source identifies the metadata, see source().
+  std::expected<UpdateStats, std::string> Update(
+      std::span<const AurPackage> packages, std::string source);
+
+  // Returns the packages that match every term, ordered by name. The
+  // packages only carry the name, version, description, votes, popularity,
+  // out-of-date flag, ID and last modification time.
+  [[nodiscard]] std::expected<RpcResponse, std::string> Search(
+      SearchBy search_by, std::span<const std::string_view> terms) const;
+
+  // An opaque string identifying the metadata the index was built from, so
+  // callers can tell whether it needs an update. Empty for a new index.
+  [[nodiscard]] const std::string &source() const noexcept { return source_; }
+
+  // The number of packages in the index
+  [[nodiscard]] std::size_t size() const noexcept;
+
+ private:
+  explicit SearchIndex(std::filesystem::path directory)
+      : directory_(std::move(directory)) {}
+
+  std::filesystem::path directory_;
+  std::string source_;
+  std::optional<detail::IndexSegment> base_;
+  std::optional<detail::IndexSegment> delta_;
+  std::string base_file_;
+  std::string delta_file_;
+};
+
+}  // namespace aurpp
+
+#endif  // AURPP_SEARCH_INDEX_H_
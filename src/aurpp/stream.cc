@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: MIT
+
+#include <aurpp/stream.h>
+
+#include <aurpp/decoder.h>
+
+#include <format>
+#include <utility>
+
+namespace aurpp {
+
+RpcResponseStream::RpcResponseStream(PackageCallback on_package)
+    : on_package_(std::move(on_package)) {}
+
+bool RpcResponseStream::Feed(const std::string_view bytes) {
+  if (error_.has_value()) {
+    return false;
+  }
+
+  // Offset of the element in progress within bytes, if there is one
+  std::size_t element_start = in_element_ ? 0 : std::string_view::npos;
+
+  for (std::size_t i = 0; i < bytes.size(); ++i) {
+    const char c = bytes[i];
+
+    if (in_string_) {
+      if (escaped_) {
+        escaped_ = false;
+      } else if (c == '\\') {
+        escaped_ = true;
+      } else if (c == '"') {
+        in_string_ = false;
+        if (depth_ == 1 && top_level_key_ == "error") {
+          RecordRpcError();
+        }
+        continue;
+      }
+      // Kept escaped, the string is decoded once it is known to be needed
+      if (depth_ == 1) {
+        top_level_string_.push_back(c);
+      }
+      continue;
+    }
+
+    switch (c) {
+      case '"':
+        in_string_ = true;
+        if (depth_ == 1) {
+          top_level_string_.clear();
+        }
+        break;
+      case '{':
+      case '[':
+        if (depth_ == 0) {
+          if (seen_root_) {
+            error_ = "Unexpected data after the JSON response";
+            return false;
+          }
+          seen_root_ = true;
+        } else if (depth_ == 1 && c == '[' && top_level_key_ == "results") {
+          in_results_ = true;
+        } else if (depth_ == 2 && in_results_ && c == '{') {
+          in_element_ = true;
+          element_start = i;
+        }
+        ++depth_;
+        break;
+      case '}':
+      case ']':
+        if (depth_ == 0) {
+          error_ = "Unbalanced brackets in the JSON response";
+          return false;
+        }
+        --depth_;
+        if (depth_ == 2 && in_element_) {
+          in_element_ = false;
+          const std::string_view tail =
+              bytes.substr(element_start, i + 1 - element_start);
+          element_start = std::string_view::npos;
+
+          // Elements that arrived in one piece are parsed in place
+          bool emitted = false;
+          if (element_.empty()) {
+            emitted = EmitPackage(tail);
+          } else {
+            element_.append(tail);
+            emitted = EmitPackage(element_);
+            element_.clear();
+          }
+          if (!emitted) {
+            return false;
+          }
+        } else if (depth_ == 1) {
+          in_results_ = false;
+        }
+        break;
+      case ':':
+        if (depth_ == 1) {
+          top_level_key_ = std::move(top_level_string_);
+          top_level_string_.clear();
+        }
+        break;
+      case ',':
+        if (depth_ == 1) {
+          top_level_key_.clear();
+        }
+        break;
+      case ' ':
+      case '\t':
+      case '\r':
+      case '\n':
+        break;
+      default:
+        if (depth_ == 0) {
+          error_ = "Unexpected data outside of the JSON response";
+          return false;
+        }
+        break;
+    }
+  }
+
+  if (in_element_) {
+    element_.append(bytes.substr(element_start));
+  }
+  return true;
+}
+
+std::expected<std::size_t, std::string> RpcResponseStream::Finish() const {
+  if (error_.has_value()) {
+    return std::unexpected{error_.value()};
+  }
+  if (!seen_root_ || depth_ != 0 || in_string_) {
+    return std::unexpected{"Incomplete JSON response"};
+  }
+  if (!rpc_error_.empty()) {
+    return std::unexpected{rpc_error_};
+  }
+  return package_count_;
+}
+
+void RpcResponseStream::RecordRpcError() {
+  const std::string quoted = std::format("\"{}\"", top_level_string_);
+  detail::JsonCursor cursor{quoted};
+  rpc_error_ = cursor.String().value_or(top_level_string_);
+}
+
+bool RpcResponseStream::EmitPackage(const std::string_view element) {
+  std::expected<AurPackage, std::string> package =
+      RpcDecoder::DecodePackage(element);
+  if (!package.has_value()) {
+    error_ = std::move(package.error());
+    return false;
+  }
+
+  ++package_count_;
+  on_package_(std::move(package.value()));
+  return true;
+}
+
+}  // namespace aurpp
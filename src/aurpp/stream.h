@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef AURPP_STREAM_H_
+#define AURPP_STREAM_H_
+
+#include <aurpp/package.h>
+
+#include <cstddef>
+#include <expected>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace aurpp {
+
+// Incrementally parses an RPC response as its bytes arrive. Every element of
+// the top level "results" array is turned into an AurPackage and handed to
+// the callback as soon as its closing brace has been seen, so only the bytes
+// of the element currently being received are ever buffered.
+class RpcResponseStream {
+ public:
+  using PackageCallback = std::function<void(AurPackage)>;
+
+  explicit RpcResponseStream(PackageCallback on_package);
+
+  RpcResponseStream(const RpcResponseStream &) = delete;
+  RpcResponseStream &operator=(const RpcResponseStream &) = delete;
+
+  RpcResponseStream(RpcResponseStream &&) = default;
+  RpcResponseStream &operator=(RpcResponseStream &&) = default;
+
+  // Consumes the next chunk of the response. Returns false once the response
+  // is known to be malformed, after which further input is ignored.
+  bool Feed(std::string_view bytes);
+
+  // Checks that a complete document was received and returns the number of
+  // packages that were passed to the callback, or the message of an RPC
+  // error response, which the AUR sends with a 200 status.
+  [[nodiscard]] std::expected<std::size_t, std::string> Finish() const;
+
+  [[nodiscard]] const std::optional<std::string> &error() const noexcept {
+    return error_;
+  }
+
+ private:
+  bool EmitPackage(std::string_view element);
+  void RecordRpcError();
+
+  PackageCallback on_package_;
+  std::optional<std::string> error_;
+  std::size_t package_count_ = 0;
+
+  // Tokenizer state, carried over between chunks
+  std::size_t depth_ = 0;
+  bool seen_root_ = false;
+  bool in_string_ = false;
+  bool escaped_ = false;
+  bool in_results_ = false;
+  bool in_element_ = false;
+
+  // The last string seen directly inside the root object, still escaped,
+  // and the key of the member being read
+  std::string top_level_string_;
+  std::string top_level_key_;
+
+  // The top level "error" member, which the AUR sets instead of "results"
+  std::string rpc_error_;
+
+  // Bytes of an element that started in an earlier chunk
+  std::string element_;
+};
+
+}  // namespace aurpp
+
+#endif  // AURPP_STREAM_H_
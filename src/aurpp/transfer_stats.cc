@@ -0,0 +1,234 @@
+// SPDX-License-Identifier: MIT
+
+#include <aurpp/transfer_stats.h>
+#include <json/json.h>
+
+#include <algorithm>
+#include <format>
+#include <iterator>
+#include <map>
+#include <utility>
+
+namespace {
+
+using Phase = std::chrono::microseconds aurpp::TransferPhases::*;
+
+constexpr std::array<std::pair<std::string_view, Phase>, 6> kPhases = {{
+    {"name_lookup", &aurpp::TransferPhases::name_lookup},
+    {"connect", &aurpp::TransferPhases::connect},
+    {"tls", &aurpp::TransferPhases::tls},
+    {"server", &aurpp::TransferPhases::server},
+    {"transfer", &aurpp::TransferPhases::transfer},
+    {"total", &aurpp::TransferPhases::total},
+}};
+
+double Milliseconds(const std::chrono::microseconds time) {
+  return std::chrono::duration<double, std::milli>{time}.count();
+}
+
+struct Summary {
+  std::chrono::microseconds mean{};
+  std::chrono::microseconds p50{};
+  std::chrono::microseconds p90{};
+  std::chrono::microseconds max{};
+};
+
+// Summarizes times, which must not be empty, using nearest-rank percentiles
+Summary Summarize(std::vector<std::chrono::microseconds> times) {
+  std::ranges::sort(times);
+  const auto percentile = [&times](const std::size_t percent) {
+    const std::size_t rank = ((times.size() * percent) + 99) / 100;
+    return times[std::max<std::size_t>(rank, 1) - 1];
+  };
+
+  std::chrono::microseconds sum{};
+  for (const std::chrono::microseconds time : times) {
+    sum += time;
+  }
+  return Summary{
+      .mean = sum / static_cast<std::chrono::microseconds::rep>(times.size()),
+      .p50 = percentile(50),
+      .p90 = percentile(90),
+      .max = times.back(),
+  };
+}
+
+std::size_t BucketOf(const std::chrono::microseconds time) {
+  std::size_t bucket = 0;
+  std::chrono::microseconds bound = std::chrono::milliseconds{1};
+  while (bucket + 1 < aurpp::TransferStats::kHistogramBuckets &&
+         time >= bound) {
+    ++bucket;
+    bound *= 2;
+  }
+  return bucket;
+}
+
+}  // namespace
+
+namespace aurpp {
+
+namespace detail {
+
+TransferPhases SplitPhases(const TransferInfo &info) {
+  TransferPhases phases;
+  phases.name_lookup = info.name_lookup_time;
+  phases.total = info.total_time;
+
+  // Skipped phases report zero, so each phase starts where the last one
+  // that happened ended
+  std::chrono::microseconds ready = info.name_lookup_time;
+  if (info.connect_time > ready) {
+    phases.connect = info.connect_time - ready;
+    ready = info.connect_time;
+  }
+  if (info.tls_time > ready) {
+    phases.tls = info.tls_time - ready;
+    ready = info.tls_time;
+  }
+  const std::chrono::microseconds first_byte =
+      std::max(info.start_transfer_time, ready);
+  phases.server = first_byte - ready;
+  phases.transfer = std::max(info.total_time, first_byte) - first_byte;
+  return phases;
+}
+
+}  // namespace detail
+
+void TransferStats::Record(const TransferInfo &info) {
+  std::lock_guard lock{mutex_};
+  samples_.push_back(Sample{
+      .url = info.url,
+      .http_version = info.http_version,
+      .phases = detail::SplitPhases(info),
+      .downloaded_bytes = info.downloaded_bytes,
+      .reused_connection = info.reused_connection,
+  });
+}
+
+std::size_t TransferStats::count() const {
+  std::lock_guard lock{mutex_};
+  return samples_.size();
+}
+
+std::string TransferStats::FormatText() const {
+  std::lock_guard lock{mutex_};
+
+  std::size_t reused = 0;
+  std::size_t downloaded_bytes = 0;
+  std::map<std::string_view, std::size_t> http_versions;
+  for (const Sample &sample : samples_) {
+    reused += sample.reused_connection ? 1 : 0;
+    downloaded_bytes += sample.downloaded_bytes;
+    ++http_versions[sample.http_version];
+  }
+
+  std::string result;
+  auto out = std::back_inserter(result);
+  std::format_to(out, "Transfers  : {} ({} on reused connections)\n",
+                 samples_.size(), reused);
+  std::format_to(out, "Received   : {} bytes\n", downloaded_bytes);
+  for (const auto &[http_version, count] : http_versions) {
+    std::format_to(out, "{:<11}: {}\n", http_version, count);
+  }
+  if (samples_.empty()) {
+    return result;
+  }
+
+  std::format_to(out, "\n{:<12}{:>12}{:>12}{:>12}{:>12}\n", "Phase", "Mean",
+                 "p50", "p90", "Max");
+  for (const auto &[name, phase] : kPhases) {
+    std::vector<std::chrono::microseconds> times;
+    times.reserve(samples_.size());
+    for (const Sample &sample : samples_) {
+      times.push_back(sample.phases.*phase);
+    }
+    const Summary summary = Summarize(std::move(times));
+    std::format_to(out, "{:<12}{:>9.1f} ms{:>9.1f} ms{:>9.1f} ms{:>9.1f} ms\n",
+                   name, Milliseconds(summary.mean),
+                   Milliseconds(summary.p50), Milliseconds(summary.p90),
+                   Milliseconds(summary.max));
+  }
+
+  Histogram histogram{};
+  for (const Sample &sample : samples_) {
+    ++histogram[BucketOf(sample.phases.total)];
+  }
+  // Leading and trailing empty buckets are left out
+  const auto first = std::ranges::find_if(
+      histogram, [](const std::size_t count) { return count != 0; });
+  const auto last = std::ranges::find_if(
+      histogram.rbegin(), histogram.rend(),
+      [](const std::size_t count) { return count != 0; });
+  std::format_to(out, "\nTotal time\n");
+  for (auto it = first; it != last.base(); ++it) {
+    const auto bucket = static_cast<std::size_t>(it - histogram.begin());
+    const std::string bound =
+        bucket + 1 == kHistogramBuckets
+            ? std::format(">= {} ms", 1U << (bucket - 1))
+            : std::format("< {} ms", 1U << bucket);
+    std::format_to(out, "{:>12} {:>6} {}\n", bound, *it,
+                   std::string(std::min<std::size_t>(*it, 50), '#'));
+  }
+  return result;
+}
+
+std::string TransferStats::FormatJson() const {
+  std::lock_guard lock{mutex_};
+
+  Json::Value json{Json::objectValue};
+  json["count"] = static_cast<Json::UInt64>(samples_.size());
+
+  Json::Value bounds{Json::arrayValue};
+  for (std::size_t bucket = 0; bucket + 1 < kHistogramBuckets; ++bucket) {
+    bounds.append(1U << bucket);
+  }
+  json["histogram_bounds_ms"] = bounds;
+
+  Json::Value phases{Json::objectValue};
+  for (const auto &[name, phase] : kPhases) {
+    Json::Value &summary_json = phases[std::string{name}];
+    Histogram histogram{};
+    std::vector<std::chrono::microseconds> times;
+    times.reserve(samples_.size());
+    for (const Sample &sample : samples_) {
+      times.push_back(sample.phases.*phase);
+      ++histogram[BucketOf(sample.phases.*phase)];
+    }
+    if (!times.empty()) {
+      const Summary summary = Summarize(std::move(times));
+      summary_json["mean_ms"] = Milliseconds(summary.mean);
+      summary_json["p50_ms"] = Milliseconds(summary.p50);
+      summary_json["p90_ms"] = Milliseconds(summary.p90);
+      summary_json["max_ms"] = Milliseconds(summary.max);
+    }
+    Json::Value &histogram_json = summary_json["histogram"];
+    histogram_json = Json::Value{Json::arrayValue};
+    for (const std::size_t count : histogram) {
+      histogram_json.append(static_cast<Json::UInt64>(count));
+    }
+  }
+  json["phases"] = phases;
+
+  Json::Value transfers{Json::arrayValue};
+  for (const Sample &sample : samples_) {
+    Json::Value transfer{Json::objectValue};
+    transfer["url"] = sample.url;
+    transfer["http_version"] = std::string{sample.http_version};
+    transfer["reused_connection"] = sample.reused_connection;
+    transfer["downloaded_bytes"] =
+        static_cast<Json::UInt64>(sample.downloaded_bytes);
+    for (const auto &[name, phase] : kPhases) {
+      transfer[std::format("{}_ms", name)] =
+          Milliseconds(sample.phases.*phase);
+    }
+    transfers.append(transfer);
+  }
+  json["transfers"] = transfers;
+
+  Json::StreamWriterBuilder writer_builder;
+  writer_builder["indentation"] = "";
+  return Json::writeString(writer_builder, json);
+}
+
+}  // namespace aurpp
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef AURPP_TRANSFER_STATS_H_
+#define AURPP_TRANSFER_STATS_H_
+
+#include <aurpp/client.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace aurpp {
+
+// Where the time of a transfer went
+struct TransferPhases {
+  std::chrono::microseconds name_lookup{};
+  std::chrono::microseconds connect{};
+  std::chrono::microseconds tls{};
+  // From the request being ready to send until the first byte of the
+  // response, i.e. mostly the time the server took
+  std::chrono::microseconds server{};
+  // Receiving the rest of the response
+  std::chrono::microseconds transfer{};
+  std::chrono::microseconds total{};
+};
+
+namespace detail {
+
+// Splits the cumulative times of info into phases
+TransferPhases SplitPhases(const TransferInfo &info);
+
+}  // namespace detail
+
+// Collects the TransferInfo of every transfer, e.g. from a Client's
+// transfer observer, and summarizes where the time went. Record may be
+// called from several threads, like the clients of a ClientPool do.
+class TransferStats {
+ public:
+  // Bucket i of a histogram counts the transfers whose phase took less than
+  // 2^i ms and not less than the bound of the previous bucket. The last
+  // bucket counts the rest.
+  static constexpr std::size_t kHistogramBuckets = 14;
+  using Histogram = std::array<std::size_t, kHistogramBuckets>;
+
+  void Record(const TransferInfo &info);
+
+  // A table of the mean, median, 90th percentile and maximum of every phase,
+  // followed by a histogram of the total times
+  [[nodiscard]] std::string FormatText() const;
+
+  // The same summary as a JSON object, with a histogram for every phase and
+  // the timings of every transfer
+  [[nodiscard]] std::string FormatJson() const;
+
+  [[nodiscard]] std::size_t count() const;
+
+ private:
+  struct Sample {
+    std::string url;
+    std::string_view http_version;
+    TransferPhases phases;
+    std::size_t downloaded_bytes = 0;
+    bool reused_connection = false;
+  };
+
+  mutable std::mutex mutex_;
+  std::vector<Sample> samples_;
+};
+
+}  // namespace aurpp
+
+#endif  // AURPP_TRANSFER_STATS_H_
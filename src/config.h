@@ -3,12 +3,21 @@
 #ifndef PACMANPP_CONFIG_H_
 #define PACMANPP_CONFIG_H_
 
+#include <aurpp/ranking.h>
+#include <aurpp/request.h>
+
+#include <cstddef>
 #include <filesystem>
+#include <limits>
+#include <vector>
 
 #include "pacman_conf.h"
 
 namespace yarp {
 
+// How the timings of AUR requests are reported once yarp is done
+enum class StatsFormat { kNone, kText, kJson };
+
 class Config {
  public:
   constexpr Config() = default;
@@ -68,6 +77,34 @@ class Config {
     return conf_file_;
   }
 
+  // A local copy of the AUR metadata dump that AUR lookups are answered from
+  // instead of the RPC interface, or empty to use the RPC interface
+  [[nodiscard]] constexpr const std::filesystem::path &aur_mirror()
+      const noexcept {
+    return aur_mirror_;
+  }
+
+  // The fields AUR searches match targets against. Searching several fields
+  // returns the packages that match any of them.
+  [[nodiscard]] constexpr const std::vector<aurpp::SearchRequest::SearchBy> &
+  aur_search_by() const noexcept {
+    return aur_search_by_;
+  }
+
+  // The order AUR search results are printed in
+  [[nodiscard]] constexpr aurpp::SortBy aur_sort_by() const noexcept {
+    return aur_sort_by_;
+  }
+
+  // The maximum number of AUR search results to print
+  [[nodiscard]] constexpr std::size_t aur_limit() const noexcept {
+    return aur_limit_;
+  }
+
+  [[nodiscard]] constexpr StatsFormat stats_format() const noexcept {
+    return stats_format_;
+  }
+
   std::expected<void, std::string> ParseFromConfig() {
     return pacman_conf_.ParseFromFile(conf_file_);
   }
@@ -76,6 +113,27 @@ class Config {
     conf_file_ = new_conf_file;
   }
 
+  constexpr void set_aur_mirror(const std::string_view new_aur_mirror) {
+    aur_mirror_ = new_aur_mirror;
+  }
+
+  constexpr void set_aur_search_by(
+      std::vector<aurpp::SearchRequest::SearchBy> new_aur_search_by) {
+    aur_search_by_ = std::move(new_aur_search_by);
+  }
+
+  constexpr void set_aur_sort_by(const aurpp::SortBy new_aur_sort_by) {
+    aur_sort_by_ = new_aur_sort_by;
+  }
+
+  constexpr void set_aur_limit(const std::size_t new_aur_limit) {
+    aur_limit_ = new_aur_limit;
+  }
+
+  constexpr void set_stats_format(const StatsFormat new_stats_format) {
+    stats_format_ = new_stats_format;
+  }
+
   constexpr void set_verbose(const bool new_verbose) { verbose_ = new_verbose; }
 
   constexpr void set_print_help(const bool new_print_help) {
@@ -94,6 +152,12 @@ class Config {
   bool verbose_ = false;
   bool print_help_ = false;
   std::filesystem::path conf_file_ = "/etc/pacman.conf";
+  std::filesystem::path aur_mirror_;
+  std::vector<aurpp::SearchRequest::SearchBy> aur_search_by_{
+      aurpp::SearchRequest::SearchBy::kName};
+  aurpp::SortBy aur_sort_by_ = aurpp::SortBy::kNone;
+  std::size_t aur_limit_ = std::numeric_limits<std::size_t>::max();
+  StatsFormat stats_format_ = StatsFormat::kNone;
   PacmanConf pacman_conf_;
 };
 
@@ -0,0 +1,275 @@
+// SPDX-License-Identifier: MIT
+
+#include "file_check.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <openssl/evp.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <memory>
+#include <optional>
+#include <system_error>
+
+#include "utils.h"
+
+namespace {
+
+using yarp::FileProblem;
+using yarp::MtreeEntry;
+using yarp::MtreeType;
+
+enum class FileState : std::uint8_t { kOk, kMissing, kTypeMismatch };
+
+// Files are handed to threads in chunks, so they don't contend for every one
+constexpr std::size_t kChunkSize = 256;
+
+// Large reads keep a disk streaming rather than seeking between files
+constexpr std::size_t kReadSize = 1 << 20;
+
+std::expected<int, std::string> OpenRoot(
+    const std::filesystem::path &root_dir) {
+  const int root_fd =
+      open(root_dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (root_fd < 0) {
+    return std::unexpected{
+        std::format("Error: Could not open {}: {}", root_dir.string(),
+                    std::system_category().message(errno))};
+  }
+  return root_fd;
+}
+
+FileState CheckFile(const int root_fd, const std::string_view file) {
+  // fstatat needs a terminated path, which a view doesn't promise
+  std::array<char, PATH_MAX> path;
+  if (file.size() >= path.size()) {
+    return FileState::kMissing;
+  }
+  std::memcpy(path.data(), file.data(), file.size());
+  path[file.size()] = '\0';
+
+  struct stat st {};
+  if (fstatat(root_fd, path.data(), &st, 0) != 0) {
+    return FileState::kMissing;
+  }
+
+  const bool expect_dir = file.ends_with('/');
+  const bool is_dir = S_ISDIR(st.st_mode);
+  return expect_dir == is_dir ? FileState::kOk : FileState::kTypeMismatch;
+}
+
+// Compares what lstat says about a file with its mtree entry. The contents
+// of a backup file are expected to change, so only its type is compared.
+FileProblem CheckEntry(const int root_fd, const MtreeEntry &entry,
+                       const bool backup) {
+  struct stat st {};
+  if (fstatat(root_fd, entry.path.c_str(), &st, AT_SYMLINK_NOFOLLOW) != 0) {
+    return errno == ENOENT || errno == ENOTDIR ? FileProblem::kMissing
+                                               : FileProblem::kUnreadable;
+  }
+
+  bool type_matches = false;
+  switch (entry.type) {
+    case MtreeType::kFile:
+      type_matches = S_ISREG(st.st_mode);
+      break;
+    case MtreeType::kDirectory:
+      type_matches = S_ISDIR(st.st_mode);
+      break;
+    case MtreeType::kSymlink:
+      type_matches = S_ISLNK(st.st_mode);
+      break;
+  }
+  if (!type_matches) {
+    return FileProblem::kType;
+  }
+
+  FileProblem problems = FileProblem::kNone;
+  // The permissions of a symlink are meaningless, and the modification time
+  // of a directory changes with its entries
+  if (entry.type != MtreeType::kSymlink && entry.mode.has_value() &&
+      (st.st_mode & 07777) != *entry.mode) {
+    problems |= FileProblem::kMode;
+  }
+  // Backup files are meant to be edited, so like pacman only their
+  // permissions are checked
+  if (backup) {
+    return problems;
+  }
+  if (entry.type != MtreeType::kDirectory && entry.mtime.has_value() &&
+      st.st_mtim.tv_sec != *entry.mtime) {
+    problems |= FileProblem::kMtime;
+  }
+  if (entry.type == MtreeType::kFile && entry.size.has_value() &&
+      st.st_size != *entry.size) {
+    problems |= FileProblem::kSize;
+  }
+  if (entry.type == MtreeType::kSymlink && entry.link.has_value()) {
+    std::array<char, PATH_MAX> link;
+    const ssize_t size =
+        readlinkat(root_fd, entry.path.c_str(), link.data(), link.size());
+    if (size < 0) {
+      problems |= FileProblem::kUnreadable;
+    } else if (std::string_view(link.data(), static_cast<std::size_t>(size)) !=
+               *entry.link) {
+      problems |= FileProblem::kLink;
+    }
+  }
+  return problems;
+}
+
+// Hashes with OpenSSL, which uses the SHA extensions or vector units of the
+// CPU where it has them
+std::optional<yarp::Sha256Digest> HashFile(const int root_fd,
+                                           const std::string &path) {
+  const int fd = openat(root_fd, path.c_str(),
+                        O_RDONLY | O_CLOEXEC | O_NOFOLLOW | O_NOCTTY);
+  if (fd < 0) {
+    return std::nullopt;
+  }
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  // One buffer per thread, rather than one per file
+  thread_local std::vector<unsigned char> buffer(kReadSize);
+  const std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> context{
+      EVP_MD_CTX_new(), &EVP_MD_CTX_free};
+  bool ok = context != nullptr &&
+            EVP_DigestInit_ex(context.get(), EVP_sha256(), nullptr) == 1;
+  ssize_t size = 0;
+  while (ok && (size = read(fd, buffer.data(), buffer.size())) > 0) {
+    ok = EVP_DigestUpdate(context.get(), buffer.data(),
+                          static_cast<std::size_t>(size)) == 1;
+  }
+  close(fd);
+
+  yarp::Sha256Digest digest;
+  if (!ok || size < 0 ||
+      EVP_DigestFinal_ex(context.get(), digest.data(), nullptr) != 1) {
+    return std::nullopt;
+  }
+  return digest;
+}
+
+}  // namespace
+
+namespace yarp {
+
+std::expected<std::vector<FileCheckResult>, std::string> CheckFiles(
+    const std::filesystem::path &root_dir,
+    const std::span<const FileCheckPackage> packages) {
+  const std::expected<int, std::string> root = OpenRoot(root_dir);
+  if (!root.has_value()) {
+    return std::unexpected{root.error()};
+  }
+  const int root_fd = root.value();
+
+  // The files of all packages, numbered in order
+  std::vector<std::string_view> files;
+  for (const FileCheckPackage &package : packages) {
+    files.insert(files.end(), package.files.begin(), package.files.end());
+  }
+
+  std::vector<FileState> states(files.size());
+  const std::size_t chunk_count = (files.size() + kChunkSize - 1) / kChunkSize;
+  utils::ParallelFor(chunk_count, [&](const std::size_t chunk) {
+    const std::size_t end = std::min(files.size(), (chunk + 1) * kChunkSize);
+    for (std::size_t i = chunk * kChunkSize; i < end; ++i) {
+      states[i] = CheckFile(root_fd, files[i]);
+    }
+  });
+  close(root_fd);
+
+  std::vector<FileCheckResult> results(packages.size());
+  std::size_t i = 0;
+  for (std::size_t package = 0; package < packages.size(); ++package) {
+    FileCheckResult &result = results[package];
+    result.total = packages[package].files.size();
+    for (const std::size_t end = i + result.total; i < end; ++i) {
+      if (states[i] == FileState::kTypeMismatch) {
+        result.type_mismatches.push_back(files[i]);
+      }
+      result.missing += states[i] != FileState::kOk;
+    }
+  }
+  return results;
+}
+
+std::expected<std::vector<FullCheckResult>, std::string> CheckFilesFull(
+    const std::filesystem::path &root_dir,
+    const std::span<const FullCheckPackage> packages) {
+  const std::expected<int, std::string> root = OpenRoot(root_dir);
+  if (!root.has_value()) {
+    return std::unexpected{root.error()};
+  }
+  const int root_fd = root.value();
+
+  // The entries of all packages, numbered in order
+  std::vector<const MtreeEntry *> entries;
+  std::vector<bool> backup;
+  for (const FullCheckPackage &package : packages) {
+    for (const MtreeEntry &entry : package.entries) {
+      entries.push_back(&entry);
+      backup.push_back(std::ranges::find(package.backup, entry.path) !=
+                       package.backup.end());
+    }
+  }
+
+  std::vector<FileProblem> problems(entries.size());
+  const std::size_t chunk_count =
+      (entries.size() + kChunkSize - 1) / kChunkSize;
+  utils::ParallelFor(chunk_count, [&](const std::size_t chunk) {
+    const std::size_t end = std::min(entries.size(), (chunk + 1) * kChunkSize);
+    for (std::size_t i = chunk * kChunkSize; i < end; ++i) {
+      problems[i] = CheckEntry(root_fd, *entries[i], backup[i]);
+    }
+  });
+
+  // Only files which are otherwise intact are worth reading. Starting with
+  // the largest keeps one big file from being hashed alone at the end.
+  std::vector<std::size_t> hashed;
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    if (problems[i] == FileProblem::kNone && !backup[i] &&
+        entries[i]->type == MtreeType::kFile &&
+        entries[i]->sha256.has_value()) {
+      hashed.push_back(i);
+    }
+  }
+  std::ranges::stable_sort(hashed, std::ranges::greater{},
+                           [&entries](const std::size_t i) {
+                             return entries[i]->size.value_or(0);
+                           });
+  utils::ParallelFor(hashed.size(), [&](const std::size_t j) {
+    const std::size_t i = hashed[j];
+    const std::optional<Sha256Digest> digest =
+        HashFile(root_fd, entries[i]->path);
+    if (!digest.has_value()) {
+      problems[i] = FileProblem::kUnreadable;
+    } else if (digest != entries[i]->sha256) {
+      problems[i] = FileProblem::kChecksum;
+    }
+  });
+  close(root_fd);
+
+  std::vector<FullCheckResult> results(packages.size());
+  std::size_t i = 0;
+  for (std::size_t package = 0; package < packages.size(); ++package) {
+    FullCheckResult &result = results[package];
+    result.total = packages[package].entries.size();
+    for (const std::size_t end = i + result.total; i < end; ++i) {
+      if (problems[i] != FileProblem::kNone) {
+        result.problems.emplace_back(entries[i]->path, problems[i]);
+      }
+    }
+    result.altered = result.problems.size();
+  }
+  return results;
+}
+
+}  // namespace yarp
@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef PACMANPP_FILE_CHECK_H_
+#define PACMANPP_FILE_CHECK_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "bitwise_enum.h"
+#include "mtree.h"
+
+namespace yarp {
+
+// The files of an installed package, as read from the local database
+struct FileCheckPackage {
+  std::string_view name;
+  // Relative to the root directory, like libalpm's file lists. Directories
+  // end with a slash.
+  std::vector<std::string_view> files;
+};
+
+struct FileCheckResult {
+  std::size_t total = 0;
+  // Includes the files in type_mismatches
+  std::size_t missing = 0;
+  // Files which exist, but are a directory where a file was expected or the
+  // other way around
+  std::vector<std::string_view> type_mismatches;
+};
+
+// Checks that the files of packages exist below root_dir, with one stat call
+// per file. The files of all packages are split across threads, and the
+// results are returned in the order of packages.
+std::expected<std::vector<FileCheckResult>, std::string> CheckFiles(
+    const std::filesystem::path &root_dir,
+    std::span<const FileCheckPackage> packages);
+
+// What differs between an installed file and its mtree entry
+enum class FileProblem : std::uint8_t {
+  kNone = 0,
+  kMissing = 1 << 0,
+  kUnreadable = 1 << 1,
+  kType = 1 << 2,
+  kMode = 1 << 3,
+  kMtime = 1 << 4,
+  kSize = 1 << 5,
+  kLink = 1 << 6,
+  kChecksum = 1 << 7,
+};
+
+template <>
+struct EnableEnumBitwiseOperators<FileProblem> {
+  static constexpr bool enabled = true;
+};
+
+// Every problem with how pacman describes it, in the order they're checked
+inline constexpr std::array kFileProblemNames{
+    std::pair{FileProblem::kMissing, std::string_view{"No such file"}},
+    std::pair{FileProblem::kUnreadable, std::string_view{"Could not read"}},
+    std::pair{FileProblem::kType, std::string_view{"File type mismatch"}},
+    std::pair{FileProblem::kMode, std::string_view{"Permissions mismatch"}},
+    std::pair{FileProblem::kMtime,
+              std::string_view{"Modification time mismatch"}},
+    std::pair{FileProblem::kSize, std::string_view{"Size mismatch"}},
+    std::pair{FileProblem::kLink, std::string_view{"Symlink path mismatch"}},
+    std::pair{FileProblem::kChecksum,
+              std::string_view{"SHA-256 checksum mismatch"}},
+};
+
+// An installed package and the mtree it was installed with
+struct FullCheckPackage {
+  std::string_view name;
+  std::span<const MtreeEntry> entries;
+  // Files pacman backs up on upgrade, like configuration files. They are
+  // meant to be edited, so only their type and permissions are checked.
+  std::vector<std::string_view> backup;
+};
+
+struct FullCheckResult {
+  std::size_t total = 0;
+  std::size_t altered = 0;
+  // The altered files and what differs for each, in the order of the mtree
+  std::vector<std::pair<std::string_view, FileProblem>> problems;
+};
+
+// Checks the type, permissions, modification time, size, symlink target and
+// SHA-256 digest of the files of packages below root_dir against their
+// mtrees. Every file is checked with one lstat call on one of the threads,
+// then the regular files are hashed across all threads, the largest first.
+// The results are returned in the order of packages.
+std::expected<std::vector<FullCheckResult>, std::string> CheckFilesFull(
+    const std::filesystem::path &root_dir,
+    std::span<const FullCheckPackage> packages);
+
+}  // namespace yarp
+
+#endif  // PACMANPP_FILE_CHECK_H_
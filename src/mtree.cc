@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: MIT
+
+#include "mtree.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <format>
+#include <memory>
+#include <ranges>
+#include <system_error>
+#include <utility>
+
+namespace {
+
+using yarp::MtreeEntry;
+using yarp::MtreeType;
+
+// The keywords of an entry, as well as the defaults /set gives for them
+struct Keywords {
+  std::optional<std::string> type;
+  std::optional<std::uint32_t> mode;
+  std::optional<std::int64_t> size;
+  std::optional<std::int64_t> mtime;
+  std::optional<std::string> link;
+  std::optional<yarp::Sha256Digest> sha256;
+};
+
+// Decodes the \ooo octal escapes mtree uses for unusual characters in paths
+// and link targets
+std::string Unescape(const std::string_view text) {
+  std::string result;
+  result.reserve(text.size());
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    if (text[i] == '\\' && i + 3 < text.size() &&
+        std::ranges::all_of(text.substr(i + 1, 3),
+                            [](char c) { return c >= '0' && c <= '7'; })) {
+      result.push_back(static_cast<char>((text[i + 1] - '0') * 64 +
+                                         (text[i + 2] - '0') * 8 +
+                                         (text[i + 3] - '0')));
+      i += 3;
+    } else if (text[i] == '\\' && i + 1 < text.size()) {
+      result.push_back(text[++i]);
+    } else {
+      result.push_back(text[i]);
+    }
+  }
+  return result;
+}
+
+template <typename T>
+std::optional<T> ParseNumber(const std::string_view text, const int base) {
+  T value{};
+  const auto [end, ec] =
+      std::from_chars(text.data(), text.data() + text.size(), value, base);
+  if (ec != std::errc{} || end != text.data() + text.size()) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+std::optional<yarp::Sha256Digest> ParseDigest(const std::string_view text) {
+  yarp::Sha256Digest digest;
+  if (text.size() != digest.size() * 2) {
+    return std::nullopt;
+  }
+  for (std::size_t i = 0; i < digest.size(); ++i) {
+    const std::optional<std::uint8_t> byte =
+        ParseNumber<std::uint8_t>(text.substr(i * 2, 2), 16);
+    if (!byte.has_value()) {
+      return std::nullopt;
+    }
+    digest[i] = *byte;
+  }
+  return digest;
+}
+
+// Applies keyword=value to keywords. Returns false if the value is invalid.
+bool SetKeyword(Keywords &keywords, const std::string_view keyword,
+                const std::string_view value) {
+  if (keyword == "type") {
+    keywords.type = std::string{value};
+  } else if (keyword == "mode") {
+    keywords.mode = ParseNumber<std::uint32_t>(value, 8);
+    return keywords.mode.has_value();
+  } else if (keyword == "size") {
+    keywords.size = ParseNumber<std::int64_t>(value, 10);
+    return keywords.size.has_value();
+  } else if (keyword == "time") {
+    // Seconds, then nanoseconds after a dot
+    keywords.mtime =
+        ParseNumber<std::int64_t>(value.substr(0, value.find('.')), 10);
+    return keywords.mtime.has_value();
+  } else if (keyword == "link") {
+    keywords.link = Unescape(value);
+  } else if (keyword == "sha256digest" || keyword == "sha256") {
+    keywords.sha256 = ParseDigest(value);
+    return keywords.sha256.has_value();
+  }
+  // Other keywords, like uid or md5digest, aren't checked
+  return true;
+}
+
+void UnsetKeyword(Keywords &keywords, const std::string_view keyword) {
+  if (keyword == "all") {
+    keywords = {};
+  } else if (keyword == "type") {
+    keywords.type.reset();
+  } else if (keyword == "mode") {
+    keywords.mode.reset();
+  } else if (keyword == "size") {
+    keywords.size.reset();
+  } else if (keyword == "time") {
+    keywords.mtime.reset();
+  } else if (keyword == "link") {
+    keywords.link.reset();
+  } else if (keyword == "sha256digest" || keyword == "sha256") {
+    keywords.sha256.reset();
+  }
+}
+
+std::optional<MtreeType> ToType(const std::optional<std::string> &type) {
+  if (!type.has_value() || type == "file") return MtreeType::kFile;
+  if (type == "dir") return MtreeType::kDirectory;
+  if (type == "link") return MtreeType::kSymlink;
+  // Devices, fifos and sockets
+  return std::nullopt;
+}
+
+// Splits a line into words separated by spaces or tabs
+std::vector<std::string_view> SplitWords(const std::string_view line) {
+  std::vector<std::string_view> words;
+  for (auto &&range : line | std::views::split(' ')) {
+    for (auto &&word : std::string_view(std::begin(range), std::end(range)) |
+                           std::views::split('\t')) {
+      if (!std::ranges::empty(word)) {
+        words.emplace_back(std::begin(word), std::end(word));
+      }
+    }
+  }
+  return words;
+}
+
+}  // namespace
+
+namespace yarp {
+
+std::expected<std::vector<MtreeEntry>, std::string> ParseMtree(
+    const std::string_view text) {
+  std::vector<MtreeEntry> entries;
+  Keywords defaults;
+  std::string continued;
+  std::size_t line_number = 0;
+
+  for (auto &&range : text | std::views::split('\n')) {
+    ++line_number;
+    std::string_view line(std::begin(range), std::end(range));
+
+    // A backslash at the end of a line continues it on the next one
+    if (line.ends_with('\\')) {
+      continued += line.substr(0, line.size() - 1);
+      continue;
+    }
+    if (!continued.empty()) {
+      continued += line;
+      line = continued;
+    }
+
+    const std::vector<std::string_view> words = SplitWords(line);
+    const auto error = [line_number](const std::string_view message) {
+      return std::unexpected{std::format("line {}: {}", line_number, message)};
+    };
+
+    if (words.empty() || words.front().starts_with('#')) {
+      continued.clear();
+      continue;
+    }
+
+    const bool is_set = words.front() == "/set";
+    Keywords keywords = is_set ? Keywords{} : defaults;
+    for (const std::string_view word : words | std::views::drop(1)) {
+      if (words.front() == "/unset") {
+        UnsetKeyword(defaults, word);
+        continue;
+      }
+      const std::size_t equals = word.find('=');
+      if (equals == std::string_view::npos) {
+        // Flag keywords like nochange have no value
+        continue;
+      }
+      if (!SetKeyword(keywords, word.substr(0, equals),
+                      word.substr(equals + 1))) {
+        return error(std::format("invalid keyword {}", word));
+      }
+    }
+
+    if (is_set) {
+      // Values given here override the earlier defaults
+      if (keywords.type) defaults.type = std::move(keywords.type);
+      if (keywords.mode) defaults.mode = keywords.mode;
+      if (keywords.size) defaults.size = keywords.size;
+      if (keywords.mtime) defaults.mtime = keywords.mtime;
+      if (keywords.link) defaults.link = std::move(keywords.link);
+      if (keywords.sha256) defaults.sha256 = keywords.sha256;
+    } else if (!words.front().starts_with('/')) {
+      // pacman writes full paths, so the relative form of mtree, where a
+      // bare name enters a directory and .. leaves it, isn't supported
+      std::string path = Unescape(words.front());
+      if (path != "." && !path.starts_with("./")) {
+        return error(std::format("unsupported relative path {}", path));
+      }
+      path.erase(0, std::min<std::size_t>(path.size(), 2));
+      while (path.ends_with('/')) {
+        path.pop_back();
+      }
+
+      const std::optional<MtreeType> type = ToType(keywords.type);
+      // The root itself and the package metadata, like .PKGINFO, aren't
+      // installed
+      if (!path.empty() && !(path.starts_with('.') && !path.contains('/')) &&
+          type.has_value()) {
+        entries.push_back({std::move(path), *type, keywords.mode,
+                           keywords.size, keywords.mtime,
+                           std::move(keywords.link), keywords.sha256});
+      }
+    }
+    // Other special commands are ignored
+    continued.clear();
+  }
+
+  return entries;
+}
+
+std::expected<std::vector<MtreeEntry>, std::string> ReadMtree(
+    const std::filesystem::path &path) {
+  // gzread reads uncompressed files as they are
+  const std::unique_ptr<gzFile_s, decltype(&gzclose)> file{
+      gzopen(path.c_str(), "rb"), &gzclose};
+  if (file == nullptr) {
+    return std::unexpected{std::format("Could not open {}", path.string())};
+  }
+
+  std::string text;
+  std::array<char, 65536> buffer;
+  int size;
+  while ((size = gzread(file.get(), buffer.data(), buffer.size())) > 0) {
+    text.append(buffer.data(), static_cast<std::size_t>(size));
+  }
+  if (size < 0) {
+    return std::unexpected{std::format("Could not read {}", path.string())};
+  }
+
+  std::expected<std::vector<MtreeEntry>, std::string> entries =
+      ParseMtree(text);
+  if (!entries.has_value()) {
+    return std::unexpected{
+        std::format("{}: {}", path.string(), entries.error())};
+  }
+  return entries;
+}
+
+}  // namespace yarp
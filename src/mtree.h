@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef PACMANPP_MTREE_H_
+#define PACMANPP_MTREE_H_
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace yarp {
+
+enum class MtreeType : std::uint8_t { kFile, kDirectory, kSymlink };
+
+using Sha256Digest = std::array<std::uint8_t, 32>;
+
+// What the mtree of a package records about one of its files. Keywords the
+// mtree doesn't give are empty.
+struct MtreeEntry {
+  // Relative to the root directory, without a trailing slash
+  std::string path;
+  MtreeType type = MtreeType::kFile;
+  // Permission bits
+  std::optional<std::uint32_t> mode;
+  std::optional<std::int64_t> size;
+  // In seconds since the epoch
+  std::optional<std::int64_t> mtime;
+  std::optional<std::string> link;
+  std::optional<Sha256Digest> sha256;
+};
+
+// Parses the mtree(5) text pacman stores for every installed package.
+// Entries for the package metadata, such as .PKGINFO, are left out.
+std::expected<std::vector<MtreeEntry>, std::string> ParseMtree(
+    std::string_view text);
+
+// Reads and parses an mtree file, which may be gzip-compressed like those in
+// the local database
+std::expected<std::vector<MtreeEntry>, std::string> ReadMtree(
+    const std::filesystem::path &path);
+
+}  // namespace yarp
+
+#endif  // PACMANPP_MTREE_H_
@@ -38,6 +38,8 @@ enum class QueryOptions : std::uint16_t {
   kForeign = 1 << 12,
   kNative = 1 << 13,
   kGroups = 1 << 14,
+  // -kk, which checks files against the mtrees of their packages
+  kCheckFull = 1 << 15,
 };
 
 template <>
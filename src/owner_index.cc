@@ -0,0 +1,270 @@
+// SPDX-License-Identifier: MIT
+
+#include "owner_index.h"
+
+#include <atomic_file.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <system_error>
+#include <utility>
+
+namespace {
+
+using yarp::detail::OwnerIndexHeader;
+using yarp::detail::OwnerIndexPackage;
+using yarp::detail::OwnerIndexPath;
+using yarp::detail::OwnerIndexString;
+
+constexpr std::size_t kSectionAlignment = 8;
+
+// Appends the bytes of items to data at the next aligned offset, and returns
+// that offset
+template <typename T>
+std::uint64_t AppendSection(std::vector<char> &data,
+                            const std::span<const T> items) {
+  data.resize((data.size() + kSectionAlignment - 1) / kSectionAlignment *
+              kSectionAlignment);
+  const std::uint64_t offset = data.size();
+  const auto *bytes = reinterpret_cast<const char *>(items.data());
+  data.insert(data.end(), bytes, bytes + items.size_bytes());
+  return offset;
+}
+
+// Checks that count elements of T at offset lie within data and are
+// suitably aligned, and returns them
+template <typename T>
+std::optional<std::span<const T>> Section(const std::span<const char> data,
+                                          const std::uint64_t offset,
+                                          const std::size_t count) {
+  if (offset % alignof(T) != 0 || offset > data.size() ||
+      count > (data.size() - offset) / sizeof(T)) {
+    return std::nullopt;
+  }
+  return std::span{reinterpret_cast<const T *>(data.data() + offset), count};
+}
+
+}  // namespace
+
+namespace yarp {
+
+std::expected<std::int64_t, std::string> OwnerIndex::DbStamp(
+    const std::filesystem::path &directory) {
+  std::error_code ec;
+  const std::filesystem::file_time_type time =
+      std::filesystem::last_write_time(directory, ec);
+  if (ec) {
+    return std::unexpected{
+        std::format("Could not read {}: {}", directory.string(),
+                    ec.message())};
+  }
+  return static_cast<std::int64_t>(time.time_since_epoch().count());
+}
+
+OwnerIndex OwnerIndex::Build(const std::span<const Package> packages,
+                             const std::string_view db_dir,
+                             const std::int64_t db_stamp) {
+  struct Entry {
+    std::string_view path;
+    std::uint32_t package;
+  };
+  std::vector<Entry> entries;
+  for (std::size_t i = 0; i < packages.size(); ++i) {
+    for (const std::string_view file : packages[i].files) {
+      entries.push_back({file, static_cast<std::uint32_t>(i)});
+    }
+  }
+  // Stable, so the owners of a path stay in the order of the packages
+  std::ranges::stable_sort(entries, {}, &Entry::path);
+
+  std::string strings;
+  const auto add_string = [&strings](const std::string_view string) {
+    const OwnerIndexString ref{static_cast<std::uint32_t>(strings.size()),
+                               static_cast<std::uint32_t>(string.size())};
+    strings += string;
+    return ref;
+  };
+
+  std::vector<OwnerIndexPackage> package_entries;
+  package_entries.reserve(packages.size());
+  for (const Package &package : packages) {
+    package_entries.push_back(
+        {add_string(package.name), add_string(package.version)});
+  }
+
+  std::vector<OwnerIndexPath> paths;
+  std::vector<std::uint32_t> owners;
+  owners.reserve(entries.size());
+  for (std::size_t i = 0; i < entries.size();) {
+    const std::string_view path = entries[i].path;
+    OwnerIndexPath &entry = paths.emplace_back(OwnerIndexPath{
+        .hash = detail::PathHash(path),
+        .path = add_string(path),
+        .first_owner = static_cast<std::uint32_t>(owners.size()),
+        .owner_count = 0,
+    });
+    for (; i < entries.size() && entries[i].path == path; ++i) {
+      owners.push_back(entries[i].package);
+      ++entry.owner_count;
+    }
+  }
+
+  // Open addressing with linear probing, at most half full
+  std::vector<std::uint32_t> buckets(std::bit_ceil(paths.size() * 2 + 1));
+  const std::size_t mask = buckets.size() - 1;
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    std::size_t slot = paths[i].hash & mask;
+    while (buckets[slot] != 0) {
+      slot = (slot + 1) & mask;
+    }
+    buckets[slot] = static_cast<std::uint32_t>(i + 1);
+  }
+
+  OwnerIndexHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(header.magic));
+  header.package_count = static_cast<std::uint32_t>(package_entries.size());
+  header.path_count = static_cast<std::uint32_t>(paths.size());
+  header.owner_count = static_cast<std::uint32_t>(owners.size());
+  header.bucket_count = static_cast<std::uint32_t>(buckets.size());
+  header.db_dir = add_string(db_dir);
+  header.db_stamp = db_stamp;
+  header.string_size = strings.size();
+
+  std::vector<char> data(sizeof(header));
+  header.packages_offset =
+      AppendSection(data, std::span<const OwnerIndexPackage>{package_entries});
+  header.paths_offset =
+      AppendSection(data, std::span<const OwnerIndexPath>{paths});
+  header.owners_offset =
+      AppendSection(data, std::span<const std::uint32_t>{owners});
+  header.buckets_offset =
+      AppendSection(data, std::span<const std::uint32_t>{buckets});
+  header.strings_offset =
+      AppendSection(data, std::span<const char>{strings});
+  std::memcpy(data.data(), &header, sizeof(header));
+
+  // What was just built is well-formed
+  return FromData(std::move(data)).value();
+}
+
+std::expected<OwnerIndex, std::string> OwnerIndex::Load(
+    const std::filesystem::path &path) {
+  std::ifstream file{path, std::ios::binary};
+  std::error_code ec;
+  const std::uintmax_t size = std::filesystem::file_size(path, ec);
+  if (!file || ec) {
+    return std::unexpected{std::format("Could not open {}", path.string())};
+  }
+
+  std::vector<char> data(size);
+  if (!file.read(data.data(), static_cast<std::streamsize>(size))) {
+    return std::unexpected{std::format("Could not read {}", path.string())};
+  }
+
+  std::expected<OwnerIndex, std::string> index = FromData(std::move(data));
+  if (!index.has_value()) {
+    return std::unexpected{
+        std::format("{} {}", path.string(), index.error())};
+  }
+  return index;
+}
+
+std::expected<void, std::string> OwnerIndex::Save(
+    const std::filesystem::path &path) const {
+  return aurpp::WriteFileAtomically(
+      path, std::string_view{data_.data(), data_.size()});
+}
+
+std::vector<OwnerIndex::Owner> OwnerIndex::Owners(
+    const std::string_view path) const {
+  std::vector<Owner> result;
+  const std::uint64_t hash = detail::PathHash(path);
+  const std::size_t mask = buckets_.size() - 1;
+  // Bounded, so even a corrupted table without empty buckets ends a probe
+  std::size_t slot = hash & mask;
+  for (std::size_t probe = 0; probe < buckets_.size() && buckets_[slot] != 0;
+       ++probe, slot = (slot + 1) & mask) {
+    const std::uint32_t number = buckets_[slot] - 1;
+    if (number >= paths_.size()) {
+      break;
+    }
+    const OwnerIndexPath &entry = paths_[number];
+    if (entry.hash != hash || String(entry.path) != path) {
+      continue;
+    }
+
+    if (entry.first_owner > owners_.size() ||
+        entry.owner_count > owners_.size() - entry.first_owner) {
+      break;
+    }
+    for (const std::uint32_t owner :
+         owners_.subspan(entry.first_owner, entry.owner_count)) {
+      if (owner < packages_.size()) {
+        result.push_back({String(packages_[owner].name),
+                          String(packages_[owner].version)});
+      }
+    }
+    break;
+  }
+  return result;
+}
+
+std::string_view OwnerIndex::db_dir() const noexcept {
+  return String(header_.db_dir);
+}
+
+std::expected<OwnerIndex, std::string> OwnerIndex::FromData(
+    std::vector<char> data) {
+  OwnerIndexHeader header;
+  if (data.size() < sizeof(header)) {
+    return std::unexpected{"is truncated"};
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != OwnerIndexHeader::kVersion) {
+    return std::unexpected{"is not a file owner index"};
+  }
+  // Lookups mask hashes with the bucket count
+  if (!std::has_single_bit(header.bucket_count)) {
+    return std::unexpected{"is corrupted"};
+  }
+
+  const std::span<const char> bytes{data};
+  const auto packages = Section<OwnerIndexPackage>(
+      bytes, header.packages_offset, header.package_count);
+  const auto paths =
+      Section<OwnerIndexPath>(bytes, header.paths_offset, header.path_count);
+  const auto owners = Section<std::uint32_t>(bytes, header.owners_offset,
+                                             header.owner_count);
+  const auto buckets = Section<std::uint32_t>(bytes, header.buckets_offset,
+                                              header.bucket_count);
+  const auto strings =
+      Section<char>(bytes, header.strings_offset, header.string_size);
+  if (!packages || !paths || !owners || !buckets || !strings) {
+    return std::unexpected{"is truncated"};
+  }
+
+  OwnerIndex index;
+  index.header_ = header;
+  index.packages_ = packages.value();
+  index.paths_ = paths.value();
+  index.owners_ = owners.value();
+  index.buckets_ = buckets.value();
+  index.strings_ = std::string_view{strings->data(), strings->size()};
+  index.data_ = std::move(data);
+  return index;
+}
+
+std::string_view OwnerIndex::String(
+    const OwnerIndexString string) const noexcept {
+  if (string.offset > strings_.size()) {
+    return {};
+  }
+  return strings_.substr(string.offset, string.size);
+}
+
+}  // namespace yarp
@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef PACMANPP_OWNER_INDEX_H_
+#define PACMANPP_OWNER_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace yarp {
+
+namespace detail {
+
+// A string in the string section of an index file
+struct OwnerIndexString {
+  std::uint32_t offset = 0;
+  std::uint32_t size = 0;
+};
+
+struct OwnerIndexHeader {
+  static constexpr std::uint32_t kVersion = 1;
+
+  char magic[8];
+  std::uint32_t version = kVersion;
+  std::uint32_t package_count = 0;
+  std::uint32_t path_count = 0;
+  std::uint32_t owner_count = 0;
+  std::uint32_t bucket_count = 0;
+  OwnerIndexString db_dir;
+  // Aligns db_stamp without leaving padding, whose bytes would be saved as
+  // whatever they happened to be
+  std::uint32_t reserved = 0;
+  std::int64_t db_stamp = 0;
+  std::uint64_t packages_offset = 0;
+  std::uint64_t paths_offset = 0;
+  std::uint64_t owners_offset = 0;
+  std::uint64_t buckets_offset = 0;
+  std::uint64_t strings_offset = 0;
+  std::uint64_t string_size = 0;
+};
+
+// The header is saved as it is in memory, so its layout is the file format
+static_assert(sizeof(OwnerIndexHeader) == 96);
+static_assert(std::is_trivially_copyable_v<OwnerIndexHeader>);
+
+struct OwnerIndexPackage {
+  OwnerIndexString name;
+  OwnerIndexString version;
+};
+
+// A path and the range of the owners section listing its packages
+struct OwnerIndexPath {
+  std::uint64_t hash = 0;
+  OwnerIndexString path;
+  std::uint32_t first_owner = 0;
+  std::uint32_t owner_count = 0;
+};
+
+// FNV-1a. Unlike std::hash it is the same in every build, which the hash
+// table of a persisted index relies on.
+constexpr std::uint64_t PathHash(const std::string_view path) {
+  std::uint64_t hash = 0xcbf29ce484222325;
+  for (const char c : path) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+  }
+  return hash;
+}
+
+}  // namespace detail
+
+// Maps the paths in the file lists of the installed packages to the packages
+// owning them, so a file owner query is a hash table lookup instead of a scan
+// of every file list. The index is saved as one file, tagged with the local
+// database it was built from, and rebuilt once that database changes.
+class OwnerIndex {
+ public:
+  static constexpr char kMagic[8] = {'y', 'a', 'r', 'p', 'o', 'w', 'n', '1'};
+
+  // An installed package, as read from the local database
+  struct Package {
+    std::string_view name;
+    std::string_view version;
+    // Relative to the root directory, like libalpm's file lists
+    std::vector<std::string_view> files;
+  };
+
+  struct Owner {
+    std::string_view name;
+    std::string_view version;
+
+    constexpr bool operator==(const Owner &) const = default;
+  };
+
+  // Identifies the state of the local database in directory. It changes
+  // whenever a package is installed, upgraded or removed, since each of
+  // those adds or removes an entry of the directory.
+  static std::expected<std::int64_t, std::string> DbStamp(
+      const std::filesystem::path &directory);
+
+  // Indexes packages, which were read from the local database in db_dir
+  // while its stamp was db_stamp
+  static OwnerIndex Build(std::span<const Package> packages,
+                          std::string_view db_dir, std::int64_t db_stamp);
+
+  static std::expected<OwnerIndex, std::string> Load(
+      const std::filesystem::path &path);
+
+  // Replaces the file at path atomically, so concurrent readers see either
+  // the old or the new index
+  std::expected<void, std::string> Save(
+      const std::filesystem::path &path) const;
+
+  OwnerIndex(const OwnerIndex &) = delete;
+  OwnerIndex &operator=(const OwnerIndex &) = delete;
+
+  // The sections point into data_, whose buffer moves along with it
+  OwnerIndex(OwnerIndex &&) = default;
+  OwnerIndex &operator=(OwnerIndex &&) = default;
+
+  // The packages owning path, relative to the root directory, in the order
+  // they were indexed in
+  [[nodiscard]] std::vector<Owner> Owners(std::string_view path) const;
+
+  [[nodiscard]] std::string_view db_dir() const noexcept;
+
+  [[nodiscard]] std::int64_t db_stamp() const noexcept {
+    return header_.db_stamp;
+  }
+
+  // The number of distinct paths in the index
+  [[nodiscard]] std::size_t size() const noexcept { return paths_.size(); }
+
+ private:
+  OwnerIndex() = default;
+
+  // Checks data is a well-formed index and points the sections into it
+  static std::expected<OwnerIndex, std::string> FromData(
+      std::vector<char> data);
+
+  [[nodiscard]] std::string_view String(
+      detail::OwnerIndexString string) const noexcept;
+
+  std::vector<char> data_;
+  detail::OwnerIndexHeader header_{};
+  std::span<const detail::OwnerIndexPackage> packages_;
+  std::span<const detail::OwnerIndexPath> paths_;
+  std::span<const std::uint32_t> owners_;
+  // Path numbers plus one, zero for an empty bucket. Their count is a power
+  // of two.
+  std::span<const std::uint32_t> buckets_;
+  std::string_view strings_;
+};
+
+}  // namespace yarp
+
+#endif  // PACMANPP_OWNER_INDEX_H_
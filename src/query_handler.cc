@@ -4,17 +4,32 @@
 
 #include <alpm.h>
 #include <alpmpp/file.h>
+#include <alpmpp/list.h>
 #include <alpmpp/package.h>
 #include <alpmpp/types.h>
 #include <alpmpp/util.h>
 
+#include <unistd.h>
+
 #include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <expected>
 #include <filesystem>
 #include <functional>
+#include <optional>
 #include <print>
 #include <ranges>
+#include <span>
+#include <string>
+#include <system_error>
+#include <vector>
 
+#include "file_check.h"
+#include "mtree.h"
 #include "operation.h"
 #include "utils.h"
 
@@ -32,11 +47,11 @@ int PrintHelp() {
   std::format_to(std::back_inserter(result), "  -e, --explicit\n");
   std::format_to(std::back_inserter(result), "  -g, --groups\n");
   std::format_to(std::back_inserter(result), "  -i, --info\n");
-  std::format_to(std::back_inserter(result), "  -k, --check\n");
+  std::format_to(std::back_inserter(result), "  -k, --check  (twice to check properties and checksums of files)\n");
   std::format_to(std::back_inserter(result), "  -l, --list\n");
   std::format_to(std::back_inserter(result), "  -m, --foreign\n");
   std::format_to(std::back_inserter(result), "  -n, --native\n");
-  std::format_to(std::back_inserter(result), "  -o, --owns <file>\n");
+  std::format_to(std::back_inserter(result), "  -o, --owns <file>  (- reads files from stdin)\n");
   std::format_to(std::back_inserter(result), "  -p, --file <package>\n");
   std::format_to(std::back_inserter(result), "  -r, --root <path>\n");
   std::format_to(std::back_inserter(result), "  -s, --search <regex>\n");
@@ -81,28 +96,135 @@ bool IsUnrequired(const alpmpp::AlpmPackage &pkg) {
   return pkg.ComputeRequiredBy().empty() && pkg.ComputeOptionalFor().empty();
 }
 
+// The directories listed in PATH, without trailing slashes
+std::vector<std::filesystem::path> PathDirs() {
+  const char *env_path = std::getenv("PATH");
+  if (env_path == nullptr) return {};
+
+  std::vector<std::filesystem::path> dirs;
+  for (auto &&range : std::string_view{env_path} | std::views::split(':')) {
+    std::string_view dir(std::begin(range), std::end(range));
+    // Remove trailing slashes
+    while (!dir.empty() && dir.back() == '/') {
+      dir.remove_suffix(1);
+    }
+    dirs.emplace_back(dir);
+  }
+  return dirs;
+}
+
 std::optional<std::filesystem::path> GetFromPath(
-    const std::filesystem::path &file_name) {
-  const std::string_view env_path = std::getenv("PATH");
-  if (env_path.empty()) return std::nullopt;
-
-  auto valid_paths = env_path | std::views::split(':') |
-                     std::views::transform([&file_name](auto &&range) {
-                       std::string_view dir(std::begin(range), std::end(range));
-                       // Remove trailing slashes
-                       while (!dir.empty() && dir.back() == '/') {
-                         dir.remove_suffix(1);
-                       }
-                       return std::filesystem::path(dir) / file_name;
-                     }) |
-                     std::views::filter([](const std::filesystem::path &path) {
-                       std::error_code ec;
-                       return std::filesystem::exists(path, ec) && !ec;
-                     });
-  const auto it = std::begin(valid_paths);
-  return it != std::end(valid_paths) ? std::optional(*it) : std::nullopt;
+    const std::filesystem::path &file_name,
+    const std::span<const std::filesystem::path> path_dirs) {
+  for (const std::filesystem::path &dir : path_dirs) {
+    std::filesystem::path path = dir / file_name;
+    std::error_code ec;
+    if (std::filesystem::exists(path, ec) && !ec) {
+      return path;
+    }
+  }
+  return std::nullopt;
+}
+
+// Returns the path of the file target names relative to root_dir, the way
+// libalpm lists the files of packages. A target that is not a file is
+// looked up in path_dirs, so commands can be given by name.
+std::expected<std::string, std::string> ResolveOwnsTarget(
+    const std::string_view target, const std::filesystem::path &root_dir,
+    const std::span<const std::filesystem::path> path_dirs) {
+  std::filesystem::path path{target};
+  if (path.empty()) {
+    return std::unexpected{
+        "Error: empty string passed into file owner query"};
+  }
+
+  std::error_code ec;
+  if (!std::filesystem::exists(std::filesystem::symlink_status(path, ec))) {
+    const std::optional<std::filesystem::path> resolved_path =
+        GetFromPath(path, path_dirs);
+    if (!resolved_path.has_value()) {
+      return std::unexpected{
+          std::format("Error: Could not find {} in PATH", target)};
+    }
+    path = resolved_path.value();
+  }
+
+  const std::filesystem::path canonicalized =
+      std::filesystem::weakly_canonical(path, ec);
+  if (ec) {
+    return std::unexpected{
+        std::format("Error: Could not resolve {}: {}", target, ec.message())};
+  }
+
+  // Alpm needs the relative path from the root dir
+  return std::filesystem::relative(canonicalized, root_dir).native();
 }
 
+// Reads paths separated by NUL or newline characters from a file
+// descriptor, as many as are available at a time. NUL separates them if the
+// first read contains one, since unlike a newline it can't be part of a path.
+class PathReader {
+ public:
+  explicit PathReader(const int fd) : fd_(fd) {}
+
+  // Replaces paths with at most count of the next paths, waiting for at
+  // least one. Returns false once the input is exhausted, or can't be read.
+  bool Read(std::vector<std::string> &paths, const std::size_t count) {
+    paths.clear();
+    while (true) {
+      while (paths.size() < count && delimiter_.has_value()) {
+        const std::size_t end = buffer_.find(*delimiter_, start_);
+        if (end == std::string::npos) break;
+        if (end > start_) {
+          paths.emplace_back(buffer_, start_, end - start_);
+        }
+        start_ = end + 1;
+      }
+      if (!paths.empty()) return true;
+
+      if (eof_) {
+        // The last path may have been cut short by a failed read
+        if (start_ < buffer_.size() && error_.empty()) {
+          paths.emplace_back(buffer_, start_);
+          start_ = buffer_.size();
+        }
+        return !paths.empty();
+      }
+
+      buffer_.erase(0, start_);
+      start_ = 0;
+      std::array<char, 65536> chunk;
+      const ssize_t size = read(fd_, chunk.data(), chunk.size());
+      if (size < 0 && errno == EINTR) {
+        continue;
+      }
+      if (size < 0) {
+        error_ = std::system_category().message(errno);
+      }
+      if (size <= 0) {
+        eof_ = true;
+      } else {
+        buffer_.append(chunk.data(), static_cast<std::size_t>(size));
+      }
+      if (!delimiter_.has_value() && (!buffer_.empty() || eof_)) {
+        delimiter_ = buffer_.contains('\0') ? '\0' : '\n';
+      }
+    }
+  }
+
+  // Why the input couldn't be read, or empty if it could
+  [[nodiscard]] const std::string &error() const noexcept { return error_; }
+
+ private:
+  int fd_;
+  std::string buffer_;
+  // Where the next path in buffer_ starts
+  std::size_t start_ = 0;
+  std::optional<char> delimiter_;
+  bool eof_ = false;
+  std::string error_;
+};
+
 }  // namespace
 
 namespace yarp {
@@ -130,9 +252,29 @@ int QueryHandler::Execute() const {
       return EXIT_FAILURE;
     }
   } else {
+    // The mtrees are read from the local database, so they only describe
+    // installed packages
+    if ((options_ & (QueryOptions::kCheckFull | QueryOptions::kIsFile)) ==
+        (QueryOptions::kCheckFull | QueryOptions::kIsFile)) {
+      std::println(stderr,
+                   "Error: -kk can only check installed packages, not package "
+                   "files (-p)");
+      return EXIT_FAILURE;
+    }
+
     const std::vector<alpmpp::AlpmPackage> pkg_list = GetPkgList();
     if (pkg_list.empty()) return EXIT_FAILURE;
 
+    // The files of all packages are checked at once, so they can be spread
+    // across threads
+    if ((options_ & QueryOptions::kCheck) == QueryOptions::kCheck &&
+        (options_ & (QueryOptions::kChangelog | QueryOptions::kList |
+                     QueryOptions::kInfo)) == QueryOptions{}) {
+      return (options_ & QueryOptions::kCheckFull) == QueryOptions::kCheckFull
+                 ? CheckPkgFilesFull(pkg_list)
+                 : CheckPkgFiles(pkg_list);
+    }
+
     for (const alpmpp::AlpmPackage &pkg : pkg_list) {
       if ((options_ & QueryOptions::kChangelog) == QueryOptions::kChangelog) {
         PrintPkgChangelog(pkg);
@@ -140,8 +282,6 @@ int QueryHandler::Execute() const {
         PrintPkgFileList(pkg);
       } else if ((options_ & QueryOptions::kInfo) == QueryOptions::kInfo) {
         PrintPkgInfo(pkg);
-      } else if ((options_ & QueryOptions::kCheck) == QueryOptions::kCheck) {
-        CheckPkgFiles(pkg);
       } else {
         std::print("{} {}", pkg.name(), pkg.version());
 
@@ -187,7 +327,8 @@ std::vector<alpmpp::AlpmPackage> QueryHandler::GetPkgList() const {
 
       // NB: This list is owned by the alpm library and should not be freed
       // manually
-      pkg_list = alpmpp::Alpm::DbGetPkgCache(local_db_);
+      pkg_list = alpmpp::Alpm::DbGetPkgCache(local_db_) |
+                 std::ranges::to<std::vector>();
     } else {
       for (const std::string_view target : targets_) {
         std::optional<alpmpp::AlpmPackage> pkg =
@@ -207,14 +348,11 @@ std::vector<alpmpp::AlpmPackage> QueryHandler::GetPkgList() const {
 
 int QueryHandler::HandleGroups() const {
   if (targets_.empty()) {
-    const alpm_list_t *all_groups = alpm_db_get_groupcache(local_db_);
-    for (const alpm_list_t *elem = all_groups; elem != nullptr;
-         elem = elem->next) {
-      auto *group = static_cast<alpm_group_t *>(elem->data);
-
-      for (const alpm_list_t *pkgs = group->packages; pkgs != nullptr;
-           pkgs = pkgs->next) {
-        alpmpp::AlpmPackage pkg{static_cast<alpm_pkg_t *>(pkgs->data)};
+    for (const alpm_group_t *group : alpmpp::AlpmListView<alpm_group_t *>{
+             alpm_db_get_groupcache(local_db_)}) {
+      for (const alpmpp::AlpmPackage pkg :
+           alpmpp::AlpmListView<alpmpp::AlpmPackage, alpm_pkg_t *>{
+               group->packages}) {
         std::println("{} {}", group->name, pkg.name());
       }
     }
@@ -225,9 +363,9 @@ int QueryHandler::HandleGroups() const {
         std::println(stderr, "Error: group '{}' was not found", target);
         return EXIT_SUCCESS;
       } else {
-        for (const alpm_list_t *pkgs = group->packages; pkgs != nullptr;
-             pkgs = pkgs->next) {
-          alpmpp::AlpmPackage pkg{static_cast<alpm_pkg_t *>(pkgs->data)};
+        for (const alpmpp::AlpmPackage pkg :
+             alpmpp::AlpmListView<alpmpp::AlpmPackage, alpm_pkg_t *>{
+                 group->packages}) {
           std::println("{} {}", group->name, pkg.name());
         }
       }
@@ -238,51 +376,128 @@ int QueryHandler::HandleGroups() const {
 
 int QueryHandler::HandleOwns() const {
   const std::filesystem::path root_dir = alpm_->OptionGetRoot();
-  const std::vector<alpmpp::AlpmPackage> pkg_list =
-      alpmpp::Alpm::DbGetPkgCache(local_db_);
-  std::error_code ec;
-  bool found = false;
+  const std::vector<std::filesystem::path> path_dirs = PathDirs();
+  const OwnerIndex index = LoadOwnerIndex();
 
+  if (targets_.size() == 1 && targets_.front() == "-") {
+    return HandleOwnsBatch(index, root_dir, path_dirs);
+  }
+
+  int result = EXIT_SUCCESS;
   for (const std::string_view target : targets_) {
-    std::filesystem::path path{target};
-    if (path.empty()) {
-      std::println(stderr, "Error: empty string passed into file owner query");
-      return EXIT_FAILURE;
+    const std::expected<std::string, std::string> relative_path =
+        ResolveOwnsTarget(target, root_dir, path_dirs);
+    if (!relative_path.has_value()) {
+      std::println(stderr, "{}", relative_path.error());
+      result = EXIT_FAILURE;
+      continue;
     }
 
-    if (!std::filesystem::exists(std::filesystem::symlink_status(path, ec))) {
-      const std::optional<std::filesystem::path> resolved_path =
-          GetFromPath(path);
-      if (!resolved_path.has_value()) {
-        std::println(stderr, "Error: Could not find {} in PATH", target);
-        return EXIT_FAILURE;
-      }
-      path = resolved_path.value();
+    const std::vector<OwnerIndex::Owner> owners =
+        index.Owners(relative_path.value());
+    for (const OwnerIndex::Owner &owner : owners) {
+      std::println("{} is owned by {} {}", target, owner.name, owner.version);
+    }
+    if (owners.empty()) {
+      std::println(stderr, "No package owns {}", target);
+      result = EXIT_FAILURE;
     }
+  }
 
-    const std::filesystem::path canonicalized =
-        std::filesystem::weakly_canonical(path, ec);
-    if (ec) return ec.value();
+  return result;
+}
 
-    // Alpm needs the relative path from the root dir
-    const std::filesystem::path relative_path =
-        std::filesystem::relative(canonicalized, root_dir);
+int QueryHandler::HandleOwnsBatch(
+    const OwnerIndex &index, const std::filesystem::path &root_dir,
+    const std::span<const std::filesystem::path> path_dirs) const {
+  // Paths are resolved a batch at a time, so the owners of the first ones
+  // are printed while later ones are still being read
+  constexpr std::size_t kBatchSize = 4096;
+
+  PathReader reader{STDIN_FILENO};
+  std::vector<std::string> paths;
+  std::vector<std::expected<std::string, std::string>> relative_paths;
+  std::string output;
+  int result = EXIT_SUCCESS;
+
+  while (reader.Read(paths, kBatchSize)) {
+    // Resolving a path waits on the file system, so they are resolved in
+    // parallel
+    relative_paths.resize(paths.size());
+    utils::ParallelFor(paths.size(), [&](const std::size_t i) {
+      relative_paths[i] = ResolveOwnsTarget(paths[i], root_dir, path_dirs);
+    });
+
+    output.clear();
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+      if (!relative_paths[i].has_value()) {
+        std::println(stderr, "{}", relative_paths[i].error());
+        result = EXIT_FAILURE;
+        continue;
+      }
 
-    for (const alpmpp::AlpmPackage &pkg : pkg_list) {
-      if (alpmpp::Alpm::FileListContains(pkg.files(), relative_path.c_str())) {
-        std::println("{} is owned by {} {}", target, pkg.name(), pkg.version());
-        found = true;
+      const std::vector<OwnerIndex::Owner> owners =
+          index.Owners(relative_paths[i].value());
+      for (const OwnerIndex::Owner &owner : owners) {
+        std::format_to(std::back_inserter(output), "{}\t{}\t{}\n", paths[i],
+                       owner.name, owner.version);
+      }
+      if (owners.empty()) {
+        std::println(stderr, "No package owns {}", paths[i]);
+        result = EXIT_FAILURE;
       }
     }
-    if (!found) {
-      std::println(stderr, "No package owns {}", target);
-      return 1;
-    } else {
-      return 0;
+    std::print("{}", output);
+    std::fflush(stdout);
+  }
+
+  if (!reader.error().empty()) {
+    std::println(stderr, "Error: Could not read paths from stdin: {}",
+                 reader.error());
+    result = EXIT_FAILURE;
+  }
+  return result;
+}
+
+OwnerIndex QueryHandler::LoadOwnerIndex() const {
+  const std::filesystem::path db_dir =
+      std::filesystem::path{config_->db_path()} / "local";
+  // Read before the packages, so a change to the database while they are
+  // read leaves the saved index stale rather than wrong
+  const std::expected<std::int64_t, std::string> db_stamp =
+      OwnerIndex::DbStamp(db_dir);
+  const std::expected<std::filesystem::path, std::string> cache_dir =
+      utils::UserCacheDir();
+  const bool persist = db_stamp.has_value() && cache_dir.has_value();
+
+  if (persist) {
+    std::expected<OwnerIndex, std::string> index =
+        OwnerIndex::Load(cache_dir.value() / "owners");
+    if (index.has_value() && index->db_dir() == db_dir.native() &&
+        index->db_stamp() == db_stamp.value()) {
+      return std::move(index.value());
     }
   }
 
-  return EXIT_SUCCESS;
+  std::vector<OwnerIndex::Package> packages;
+  for (const alpmpp::AlpmPackage pkg :
+       alpmpp::Alpm::DbGetPkgCache(local_db_)) {
+    packages.push_back(
+        {pkg.name(), pkg.version(),
+         pkg.files() |
+             std::views::transform(&alpmpp::AlpmFile::name) |
+             std::ranges::to<std::vector>()});
+  }
+  OwnerIndex index =
+      OwnerIndex::Build(packages, db_dir.native(), db_stamp.value_or(0));
+
+  // Failing to save only means building the index again next time
+  if (persist) {
+    std::error_code ec;
+    std::filesystem::create_directories(cache_dir.value(), ec);
+    (void)index.Save(cache_dir.value() / "owners");
+  }
+  return index;
 }
 
 int QueryHandler::HandleSearch() const {
@@ -297,36 +512,114 @@ int QueryHandler::HandleSearch() const {
   }
 }
 
-void QueryHandler::CheckPkgFiles(const alpmpp::AlpmPackage &pkg) const {
-  const std::vector<alpmpp::AlpmFile> files = pkg.files();
+int QueryHandler::CheckPkgFiles(
+    const std::span<const alpmpp::AlpmPackage> pkg_list) const {
   const std::string_view root = alpm_->OptionGetRoot();
 
-  auto errors = std::ranges::count_if(files, [&](const alpmpp::AlpmFile &file) {
-    const std::string absolute_file_name =
-        std::format("{}{}", root, file.name());
+  std::vector<FileCheckPackage> packages;
+  packages.reserve(pkg_list.size());
+  for (const alpmpp::AlpmPackage &pkg : pkg_list) {
+    packages.push_back(
+        {pkg.name(), pkg.files() |
+                         std::views::transform(&alpmpp::AlpmFile::name) |
+                         std::ranges::to<std::vector>()});
+  }
 
-    if (!std::filesystem::exists(absolute_file_name)) {
-      return true;
-    } else {
-      const bool expect_dir = absolute_file_name.back() == '/';
-      const bool is_dir = std::filesystem::is_directory(absolute_file_name);
+  const std::expected<std::vector<FileCheckResult>, std::string> results =
+      CheckFiles(root, packages);
+  if (!results.has_value()) {
+    std::println(stderr, "{}", results.error());
+    return EXIT_FAILURE;
+  }
 
-      if (expect_dir != is_dir) {
-        std::println("{}: {} (File type mismatch)", pkg.name(),
-                     absolute_file_name);
-        return true;
-      } else {
-        return false;
-      }
+  std::string output;
+  for (std::size_t i = 0; i < packages.size(); ++i) {
+    const FileCheckResult &result = results.value()[i];
+    for (const std::string_view file : result.type_mismatches) {
+      std::format_to(std::back_inserter(output),
+                     "{}: {}{} (File type mismatch)\n", packages[i].name, root,
+                     file);
     }
+    std::format_to(std::back_inserter(output),
+                   "{}: {} total files, {} missing files\n", packages[i].name,
+                   result.total, result.missing);
+  }
+  std::print("{}", output);
+
+  return EXIT_SUCCESS;
+}
+
+int QueryHandler::CheckPkgFilesFull(
+    const std::span<const alpmpp::AlpmPackage> pkg_list) const {
+  const std::string_view root = alpm_->OptionGetRoot();
+  const std::filesystem::path db_dir =
+      std::filesystem::path{config_->db_path()} / "local";
+
+  std::vector<std::filesystem::path> mtree_paths;
+  mtree_paths.reserve(pkg_list.size());
+  for (const alpmpp::AlpmPackage &pkg : pkg_list) {
+    mtree_paths.push_back(db_dir /
+                          std::format("{}-{}", pkg.name(), pkg.version()) /
+                          "mtree");
+  }
+
+  // Decompressing the mtrees takes a while of its own
+  std::vector<std::expected<std::vector<MtreeEntry>, std::string>> mtrees(
+      pkg_list.size());
+  utils::ParallelFor(pkg_list.size(), [&](const std::size_t i) {
+    mtrees[i] = ReadMtree(mtree_paths[i]);
   });
 
-  std::println("{}: {} total files, {} missing files", pkg.name(), files.size(),
-               errors);
+  std::vector<FullCheckPackage> packages;
+  packages.reserve(pkg_list.size());
+  for (std::size_t i = 0; i < pkg_list.size(); ++i) {
+    FullCheckPackage &package = packages.emplace_back(
+        FullCheckPackage{pkg_list[i].name(), {}, {}});
+    if (mtrees[i].has_value()) {
+      package.entries = mtrees[i].value();
+    }
+    for (const alpm_backup_t *backup : pkg_list[i].backup()) {
+      package.backup.emplace_back(backup->name);
+    }
+  }
+
+  const std::expected<std::vector<FullCheckResult>, std::string> results =
+      CheckFilesFull(root, packages);
+  if (!results.has_value()) {
+    std::println(stderr, "{}", results.error());
+    return EXIT_FAILURE;
+  }
+
+  int result = EXIT_SUCCESS;
+  for (std::size_t i = 0; i < packages.size(); ++i) {
+    if (!mtrees[i].has_value()) {
+      std::fflush(stdout);
+      std::println(stderr, "Error: {}: Could not read the mtree: {}",
+                   packages[i].name, mtrees[i].error());
+      result = EXIT_FAILURE;
+      continue;
+    }
+
+    std::string output;
+    for (const auto &[path, problems] : results.value()[i].problems) {
+      for (const auto &[problem, description] : kFileProblemNames) {
+        if ((problems & problem) == problem) {
+          std::format_to(std::back_inserter(output), "{}: {}{} ({})\n",
+                         packages[i].name, root, path, description);
+        }
+      }
+    }
+    std::format_to(std::back_inserter(output),
+                   "{}: {} total files, {} altered files\n", packages[i].name,
+                   results.value()[i].total, results.value()[i].altered);
+    std::print("{}", output);
+  }
+
+  return result;
 }
 
 PkgLocality QueryHandler::GetPkgLocality(const alpmpp::AlpmPackage &pkg) const {
-  const std::vector<alpm_db_t *> sync_dbs = alpm_->GetSyncDbs();
+  const alpmpp::AlpmListView<alpm_db_t *> sync_dbs = alpm_->GetSyncDbs();
   const std::string_view pkg_name = pkg.name();
 
   const bool pkg_in_sync_db =
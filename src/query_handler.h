@@ -5,8 +5,12 @@
 
 #include <alpmpp/alpm.h>
 
+#include <filesystem>
+#include <span>
+
 #include "config.h"
 #include "operation.h"
+#include "owner_index.h"
 
 namespace yarp {
 
@@ -39,10 +43,23 @@ class QueryHandler {
  private:
   [[nodiscard]] int HandleGroups() const;
   [[nodiscard]] int HandleOwns() const;
+  // Prints the owners of the files named on stdin as tab separated path,
+  // package and version records, see yarp -Qo -
+  [[nodiscard]] int HandleOwnsBatch(
+      const OwnerIndex &index, const std::filesystem::path &root_dir,
+      std::span<const std::filesystem::path> path_dirs) const;
+  // Loads the saved index of file owners, or builds and saves it if the
+  // local database changed since
+  [[nodiscard]] OwnerIndex LoadOwnerIndex() const;
   [[nodiscard]] int HandleSearch() const;
   [[nodiscard]] std::vector<alpmpp::AlpmPackage> GetPkgList() const;
   void PrintPkgFileList(const alpmpp::AlpmPackage &pkg) const;
-  void CheckPkgFiles(const alpmpp::AlpmPackage &pkg) const;
+  [[nodiscard]] int CheckPkgFiles(
+      std::span<const alpmpp::AlpmPackage> pkg_list) const;
+  // Checks the files of the packages against the mtrees in the local
+  // database, see yarp -Qkk
+  [[nodiscard]] int CheckPkgFilesFull(
+      std::span<const alpmpp::AlpmPackage> pkg_list) const;
   [[nodiscard]] PkgLocality GetPkgLocality(
       const alpmpp::AlpmPackage &pkg) const;
   [[nodiscard]] bool FilterPkg(const alpmpp::AlpmPackage &pkg) const;
@@ -2,17 +2,44 @@
 
 #include "sync_handler.h"
 
+#include <mirror.h>
+#include <ranking.h>
+#include <search_index.h>
 #include <utils.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <optional>
 #include <print>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
 
 namespace {
 
-void PrintPkgInfo(const aurpp::AurPackage &package) {
+using SearchBy = aurpp::SearchRequest::SearchBy;
+
+// Prints a search result, followed by the fields it matched when several
+// fields were searched
+void PrintPkgInfo(const aurpp::AurPackage &package,
+                  const std::span<const SearchBy> matched_fields = {}) {
   std::string result;
 
-  std::format_to(std::back_inserter(result), "aur/{} {} [+{} ~{:.2}]\n", package.name(), package.version(),
+  std::format_to(std::back_inserter(result), "aur/{} {} [+{} ~{:.2}]", package.name(), package.version(),
                package.num_votes(), package.popularity());
+  if (!matched_fields.empty()) {
+    result += " (";
+    for (std::size_t i = 0; i < matched_fields.size(); ++i) {
+      std::format_to(std::back_inserter(result), "{}{}", i == 0 ? "" : ", ",
+                     aurpp::SearchRequest::SearchByToString(matched_fields[i]));
+    }
+    result += ")";
+  }
+  result += "\n";
   if (package.description().has_value()) {
     std::format_to(std::back_inserter(result), "    {}", package.description().value());
   }
@@ -20,6 +47,72 @@ void PrintPkgInfo(const aurpp::AurPackage &package) {
   std::println("{}", result);
 }
 
+// Searches every field for every term with search(field, term), and merges
+// the results like aurpp::Client::ExecuteFieldSearch does
+template <typename Search>
+yarp::SyncHandler::AurSearchResult SearchEachField(
+    const std::span<const SearchBy> fields,
+    const std::span<const std::string> terms, Search &&search) {
+  const std::vector<SearchBy> unique_fields =
+      aurpp::detail::UniqueFields(fields);
+
+  std::vector<aurpp::RpcResponse> responses;
+  responses.reserve(terms.size() * unique_fields.size());
+  for (const std::string &term : terms) {
+    for (const SearchBy field : unique_fields) {
+      std::expected<aurpp::RpcResponse, std::string> response =
+          search(field, std::string_view{term});
+      if (!response.has_value()) {
+        return std::unexpected(std::move(response.error()));
+      }
+      responses.push_back(std::move(response.value()));
+    }
+  }
+  return aurpp::detail::MergeFieldSearches(unique_fields, responses);
+}
+
+// Opens the search index in the user cache directory, updating it first when
+// it was built from another version of the metadata dump at path
+std::expected<aurpp::SearchIndex, std::string> OpenSearchIndex(
+    const std::filesystem::path &path) {
+  const auto cache_dir = yarp::utils::UserCacheDir();
+  if (!cache_dir.has_value()) {
+    return std::unexpected(cache_dir.error());
+  }
+
+  // A dump is identified by its location, size and modification time
+  std::error_code error;
+  const std::uintmax_t size = std::filesystem::file_size(path, error);
+  if (error) {
+    return std::unexpected(std::format("Error: could not read {}: {}",
+                                       path.string(), error.message()));
+  }
+  const std::filesystem::file_time_type modified =
+      std::filesystem::last_write_time(path, error);
+  if (error) {
+    return std::unexpected(std::format("Error: could not read {}: {}",
+                                       path.string(), error.message()));
+  }
+  std::string source =
+      std::format("{}:{}:{}", std::filesystem::absolute(path).string(), size,
+                  modified.time_since_epoch().count());
+
+  aurpp::SearchIndex index =
+      aurpp::SearchIndex::Open(cache_dir.value() / "aur-index");
+  if (index.source() != source) {
+    const std::expected<aurpp::LocalMirror, std::string> mirror =
+        aurpp::LocalMirror::Load(path);
+    if (!mirror.has_value()) {
+      return std::unexpected(mirror.error());
+    }
+    const auto updated = index.Update(mirror->packages(), std::move(source));
+    if (!updated.has_value()) {
+      return std::unexpected(updated.error());
+    }
+  }
+  return index;
+}
+
 }  // namespace
 
 namespace yarp {
@@ -35,8 +128,18 @@ int SyncHandler::Execute() const {
 }
 
 int SyncHandler::HandleSearch() const {
+  // The AUR requests are in flight while the sync databases are searched, so
+  // the search takes the longer of the two rather than their sum
+  std::optional<std::future<AurSearchResult>> aur_search;
+  if (config_->aur_mirror().empty() && !targets_.empty()) {
+    aur_search = aur_client_->ExecuteFieldSearchAsync(
+        config_->aur_search_by(), targets_);
+  }
+
   const int repo_search_result = SearchRepos();
-  const int aur_search_result = SearchAur();
+  const int aur_search_result = aur_search.has_value()
+                                    ? PrintAurResults(aur_search->get())
+                                    : SearchAur();
 
   if (repo_search_result == 1 && aur_search_result == 1) {
     std::println("Error: targets not found in either official repos or AUR");
@@ -47,24 +150,83 @@ int SyncHandler::HandleSearch() const {
 }
 
 int SyncHandler::SearchAur() const {
-  for (const std::string_view target : targets_) {
-    const aurpp::SearchRequest request{aurpp::SearchRequest::SearchBy::kName,
-                                       target};
-    std::expected<aurpp::RpcResponse, std::string> maybe_response =
-        aur_client_->Execute<aurpp::SearchRequest, aurpp::RpcResponse>(request);
-    if (maybe_response.has_value()) {
-      const std::vector<aurpp::AurPackage> packages =
-          maybe_response.value().packages;
-      std::ranges::for_each(packages, PrintPkgInfo);
-      return 0;
-    } else {
-      std::println("{}", maybe_response.error());
-      return 1;
-    }
+  if (!config_->aur_mirror().empty()) {
+    return SearchAurMirror();
+  }
+
+  const std::vector<SearchBy> &fields = config_->aur_search_by();
+  if (targets_.size() != 1 || fields.size() != 1 ||
+      config_->aur_sort_by() != aurpp::SortBy::kNone) {
+    return PrintAurResults(
+        aur_client_->ExecuteFieldSearch(fields, targets_));
+  }
+
+  const aurpp::SearchRequest request{fields.front(), targets_.front()};
+  // Results are printed while the rest of the response is still arriving
+  std::size_t printed = 0;
+  const std::expected<std::size_t, std::string> maybe_count =
+      aur_client_->ExecuteStreaming(
+          request, [this, &printed](const aurpp::AurPackage &package) {
+            if (printed < config_->aur_limit()) {
+              PrintPkgInfo(package);
+              ++printed;
+            }
+          });
+  if (!maybe_count.has_value()) {
+    std::println("{}", maybe_count.error());
+    return 1;
   }
   return 0;
 }
 
+int SyncHandler::PrintAurResults(const AurSearchResult &matches) const {
+  if (!matches.has_value()) {
+    std::println("{}", matches.error());
+    return 1;
+  }
+  // Which field matched is only worth showing when there was a choice
+  const bool show_fields =
+      aurpp::detail::UniqueFields(config_->aur_search_by()).size() > 1;
+  // Only the results that are printed are ordered
+  for (const std::uint32_t position :
+       aurpp::SelectTop(matches.value(), config_->aur_sort_by(),
+                        config_->aur_limit(),
+                        &aurpp::FieldSearchMatch::package)) {
+    const aurpp::FieldSearchMatch &match = matches.value()[position];
+    PrintPkgInfo(match.package,
+                 show_fields ? std::span<const SearchBy>{match.fields}
+                             : std::span<const SearchBy>{});
+  }
+  return 0;
+}
+
+int SyncHandler::SearchAurMirror() const {
+  const std::vector<SearchBy> &fields = config_->aur_search_by();
+
+  const std::expected<aurpp::SearchIndex, std::string> index =
+      OpenSearchIndex(config_->aur_mirror());
+  if (index.has_value()) {
+    return PrintAurResults(SearchEachField(
+        fields, targets_,
+        [&index](const SearchBy field, const std::string_view term) {
+          return index->Search(field, std::span{&term, 1});
+        }));
+  }
+
+  // Without a usable index the whole dump is loaded and searched in memory
+  const std::expected<aurpp::LocalMirror, std::string> mirror =
+      aurpp::LocalMirror::Load(config_->aur_mirror());
+  if (!mirror.has_value()) {
+    std::println("{}", mirror.error());
+    return 1;
+  }
+  return PrintAurResults(SearchEachField(
+      fields, targets_,
+      [&mirror](const SearchBy field, const std::string_view term) {
+        return mirror->Search(field, term);
+      }));
+}
+
 int SyncHandler::SearchRepos() const {
   const int total_errors = std::ranges::fold_left(
              alpm_->GetSyncDbs(), 0,
@@ -6,6 +6,10 @@
 #include <alpmpp/alpm.h>
 #include <client.h>
 
+#include <expected>
+#include <string>
+#include <vector>
+
 #include "config.h"
 #include "operation.h"
 
@@ -13,6 +17,9 @@ namespace yarp {
 
 class SyncHandler {
  public:
+  using AurSearchResult =
+      std::expected<std::vector<aurpp::FieldSearchMatch>, std::string>;
+
   constexpr SyncHandler(alpmpp::Alpm *alpm, aurpp::Client *aur_client,
                         Config *config, const SyncOptions sync_options,
                         std::vector<std::string> targets)
@@ -33,6 +40,8 @@ class SyncHandler {
  private:
   [[nodiscard]] int HandleSearch() const;
   [[nodiscard]] int SearchAur() const;
+  [[nodiscard]] int SearchAurMirror() const;
+  [[nodiscard]] int PrintAurResults(const AurSearchResult &matches) const;
   [[nodiscard]] int SearchRepos() const;
 
   alpmpp::Alpm *alpm_;
@@ -4,10 +4,13 @@
 
 #include <alpmpp/util.h>
 
+#include <cstdlib>
 #include <print>
 #include <ranges>
 #include <sstream>
 
+#include "settings.h"
+
 namespace yarp::utils {
 
 std::expected<std::string, std::string> PrintPkgSearch(
@@ -22,7 +25,7 @@ std::expected<std::string, std::string> PrintPkgSearch(
   std::string result;
 
   for (const alpmpp::AlpmPackage &pkg : search_list) {
-    const std::vector<std::string_view> groups = pkg.groups();
+    const alpmpp::AlpmStringList groups = pkg.groups();
 
     std::format_to(std::back_inserter(result), "{}/{} {}", alpm_db_get_name(db),
                    pkg.name(), pkg.version());
@@ -36,4 +39,18 @@ std::expected<std::string, std::string> PrintPkgSearch(
   return result;
 }
 
-}  // namespace yarp::utils
\ No newline at end of file
+std::expected<std::filesystem::path, std::string> UserCacheDir() {
+  // Relative paths in XDG_CACHE_HOME are invalid and must be ignored
+  if (const char *xdg_cache_home = std::getenv("XDG_CACHE_HOME");
+      xdg_cache_home != nullptr && xdg_cache_home[0] == '/') {
+    return std::filesystem::path{xdg_cache_home} / kYarpName;
+  }
+
+  const char *home = std::getenv("HOME");
+  if (home == nullptr || home[0] == '\0') {
+    return std::unexpected("Error: could not determine the cache directory");
+  }
+  return std::filesystem::path{home} / ".cache" / kYarpName;
+}
+
+}  // namespace yarp::utils
@@ -5,14 +5,44 @@
 
 #include <alpmpp/alpm.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <expected>
+#include <filesystem>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace yarp::utils {
 
 std::expected<std::string, std::string> PrintPkgSearch(alpm_db_t *db, const std::vector<std::string> &targets);
 
+// Returns the per-user cache directory for yarp, following the XDG base
+// directory specification: $XDG_CACHE_HOME/yarp, or ~/.cache/yarp.
+std::expected<std::filesystem::path, std::string> UserCacheDir();
+
+// Calls function with every index below count, spread over as many threads
+// as there are cores. Returns once every call has returned.
+template <typename Function>
+void ParallelFor(const std::size_t count, Function function) {
+  const std::size_t thread_count = std::min<std::size_t>(
+      count, std::max(std::thread::hardware_concurrency(), 1U));
+  std::atomic<std::size_t> next{0};
+  const auto work = [&] {
+    for (std::size_t i = next++; i < count; i = next++) {
+      function(i);
+    }
+  };
+
+  // The calling thread works too, so a single item needs no thread
+  std::vector<std::jthread> threads;
+  for (std::size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(work);
+  }
+  work();
+}
+
 }  // namespace yarp::utils
 
 #endif  // YARP_UTIL_H_
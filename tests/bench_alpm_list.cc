@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: MIT
+
+#include <alpmpp/alpm.h>
+#include <alpmpp/depend.h>
+#include <alpmpp/file.h>
+#include <alpmpp/package.h>
+
+#include <atomic>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <print>
+#include <ranges>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+std::atomic<std::size_t> allocations{0};
+
+// Reads every list of every package the way -Qi does, copying each list into
+// a vector like the accessors did before they returned views
+std::size_t ReadCopied(alpm_db_t *db) {
+  std::size_t size = 0;
+  const std::vector<alpmpp::AlpmPackage> packages =
+      alpmpp::Alpm::DbGetPkgCache(db) | std::ranges::to<std::vector>();
+  for (const alpmpp::AlpmPackage &pkg : packages) {
+    for (const alpmpp::AlpmDependList list :
+         {pkg.depends(), pkg.opt_depends(), pkg.provides(), pkg.conflicts(),
+          pkg.replaces()}) {
+      size += (list | std::ranges::to<std::vector>()).size();
+    }
+    size += (pkg.groups() | std::ranges::to<std::vector>()).size();
+    size += (pkg.licenses() | std::ranges::to<std::vector>()).size();
+    size += (pkg.files() | std::ranges::to<std::vector>()).size();
+  }
+  return size;
+}
+
+std::size_t ReadViews(alpm_db_t *db) {
+  std::size_t size = 0;
+  for (const alpmpp::AlpmPackage pkg : alpmpp::Alpm::DbGetPkgCache(db)) {
+    for (const alpmpp::AlpmDependList list :
+         {pkg.depends(), pkg.opt_depends(), pkg.provides(), pkg.conflicts(),
+          pkg.replaces()}) {
+      size += std::ranges::distance(list);
+    }
+    size += std::ranges::distance(pkg.groups());
+    size += std::ranges::distance(pkg.licenses());
+    size += pkg.files().size();
+  }
+  return size;
+}
+
+// The number of allocations read makes once libalpm has loaded everything
+// it reads
+template <typename Read>
+std::size_t CountAllocations(Read read, alpm_db_t *db) {
+  (void)read(db);
+  const std::size_t before = allocations;
+  (void)read(db);
+  return allocations - before;
+}
+
+}  // namespace
+
+void *operator new(const std::size_t size) {
+  ++allocations;
+  if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+TEST_CASE("Reading the lists of every package", "[benchmark]") {
+  // Copied next to the benchmark along with the other test data
+  const alpmpp::Alpm alpm{"/", "test-data/db"};
+  alpm_db_t *db = alpm.GetLocalDb();
+  REQUIRE(ReadCopied(db) == ReadViews(db));
+
+  std::println("Allocations reading the test database: {} copied, {} viewed",
+               CountAllocations(ReadCopied, db),
+               CountAllocations(ReadViews, db));
+
+  BENCHMARK("Copying the lists") { return ReadCopied(db); };
+  BENCHMARK("Viewing the lists") { return ReadViews(db); };
+}
@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <print>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "aurpp/client.h"
+#include "aurpp/client_pool.h"
+#include "aurpp/request.h"
+#include "aurpp/response.h"
+#include "aurpp/scheduler.h"
+#include "mock_aur_server.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kRequests = 400;
+// Roughly what the AUR spends answering an info request, so concurrency has
+// something to overlap
+constexpr std::chrono::milliseconds kServerLatency{5};
+constexpr std::array<std::string_view, 4> kNames{"paru", "yay", "pikaur",
+                                                 "aurutils"};
+
+struct LoadResult {
+  double requests_per_second = 0;
+  Clock::duration p50{};
+  Clock::duration p99{};
+  Clock::duration max{};
+  int failures = 0;
+};
+
+// The nearest-rank percentile of sorted latencies
+Clock::duration Percentile(const std::span<const Clock::duration> sorted,
+                           const double percentile) {
+  const auto rank = static_cast<std::size_t>(
+      std::ceil(percentile / 100 * static_cast<double>(sorted.size())));
+  return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+// Makes requests info requests from threads threads, each using a client
+// leased from pool, and measures the latency of every request
+LoadResult RunLoad(aurpp::ClientPool &pool, const int threads,
+                   const int requests) {
+  std::vector<std::vector<Clock::duration>> latencies(
+      static_cast<std::size_t>(threads));
+  std::atomic<int> next{0};
+  std::atomic<int> failures{0};
+
+  const Clock::time_point start = Clock::now();
+  {
+    std::vector<std::jthread> workers;
+    for (std::vector<Clock::duration> &thread_latencies : latencies) {
+      workers.emplace_back([&] {
+        aurpp::ClientPool::Lease client = pool.Acquire();
+        for (int i = next++; i < requests; i = next++) {
+          aurpp::InfoRequest request;
+          request.AddArg(kNames[static_cast<std::size_t>(i) % kNames.size()]);
+          const Clock::time_point sent = Clock::now();
+          const auto result =
+              client->Execute<aurpp::InfoRequest, aurpp::RpcResponse>(
+                  request);
+          thread_latencies.push_back(Clock::now() - sent);
+          if (!result.has_value()) {
+            ++failures;
+          }
+        }
+      });
+    }
+  }
+  const Clock::duration elapsed = Clock::now() - start;
+
+  std::vector<Clock::duration> sorted;
+  for (const std::vector<Clock::duration> &thread_latencies : latencies) {
+    sorted.insert(sorted.end(), thread_latencies.begin(),
+                  thread_latencies.end());
+  }
+  std::ranges::sort(sorted);
+
+  return {
+      .requests_per_second =
+          requests / std::chrono::duration<double>{elapsed}.count(),
+      .p50 = Percentile(sorted, 50),
+      .p99 = Percentile(sorted, 99),
+      .max = sorted.back(),
+      .failures = failures,
+  };
+}
+
+void PrintLoad(const int threads, const LoadResult &result) {
+  const auto ms = [](const Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>{duration}.count();
+  };
+  std::println("{:>7} {:>10.0f} {:>8.2f} {:>8.2f} {:>8.2f}", threads,
+               result.requests_per_second, ms(result.p50), ms(result.p99),
+               ms(result.max));
+}
+
+}  // namespace
+
+TEST_CASE("Client throughput and tail latency", "[benchmark]") {
+  MockAurOptions options;
+  options.latency = kServerLatency;
+
+  SECTION("Concurrent clients of a healthy server") {
+    MockAurServer server{options};
+
+    std::println("{} info requests, {} ms server latency", kRequests,
+                 kServerLatency.count());
+    std::println("Threads  Requests/s  p50 ms   p99 ms   max ms");
+    for (const int threads : {1, 4, 16}) {
+      aurpp::ClientPool pool{server.url()};
+      const LoadResult result = RunLoad(pool, threads, kRequests);
+      PrintLoad(threads, result);
+      REQUIRE(result.failures == 0);
+    }
+  }
+
+  SECTION("Concurrent clients retrying a failing server") {
+    options.fail_every = 10;
+    MockAurServer server{options};
+
+    aurpp::SchedulerOptions scheduler_options;
+    scheduler_options.requests_per_second = 100'000;
+    scheduler_options.burst = 100'000;
+    scheduler_options.base_delay = std::chrono::milliseconds{10};
+    scheduler_options.max_delay = std::chrono::milliseconds{100};
+    aurpp::ClientPool pool{server.url()};
+    pool.set_scheduler(
+        std::make_shared<aurpp::RequestScheduler>(scheduler_options));
+
+    std::println("{} info requests, every 10th answered with 503",
+                 kRequests);
+    std::println("Threads  Requests/s  p50 ms   p99 ms   max ms");
+    const LoadResult result = RunLoad(pool, 16, kRequests);
+    PrintLoad(16, result);
+    REQUIRE(result.failures == 0);
+  }
+
+  SECTION("One client multiplexing a batch") {
+    MockAurServer server{options};
+    aurpp::Client client{server.url()};
+
+    std::vector<aurpp::InfoRequest> requests(64);
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+      requests[i].AddArg(kNames[i % kNames.size()]);
+    }
+
+    BENCHMARK("Batch of 64 info requests") {
+      return client.ExecuteMany<aurpp::InfoRequest, aurpp::RpcResponse>(
+          std::span<const aurpp::InfoRequest>{requests});
+    };
+  }
+}
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: MIT
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <functional>
+#include <string>
+
+#include "aurpp/compact.h"
+#include "aurpp/response.h"
+#include "bench_fixture.h"
+
+namespace {
+
+constexpr std::size_t kFixturePackages = 100000;
+
+struct LayoutCost {
+  double parse_ms = 0;
+  long peak_rss_kib = 0;
+};
+
+long PeakRssKib() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+// Parses the fixture in a forked child so every layout starts from the same
+// peak RSS. The child reports back over a pipe.
+LayoutCost MeasureLayout(const std::function<std::size_t()> &parse) {
+  int fds[2];
+  REQUIRE(pipe(fds) == 0);
+
+  const pid_t pid = fork();
+  REQUIRE(pid >= 0);
+  if (pid == 0) {
+    close(fds[0]);
+    const long baseline_kib = PeakRssKib();
+    const auto start = std::chrono::steady_clock::now();
+    const std::size_t count = parse();
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    LayoutCost cost{elapsed.count(), PeakRssKib() - baseline_kib};
+    if (count != kFixturePackages) {
+      cost.parse_ms = -1;
+    }
+    [[maybe_unused]] const auto written = write(fds[1], &cost, sizeof(cost));
+    _exit(0);
+  }
+
+  close(fds[1]);
+  LayoutCost cost{};
+  const auto bytes = read(fds[0], &cost, sizeof(cost));
+  close(fds[0]);
+  waitpid(pid, nullptr, 0);
+  REQUIRE(bytes == sizeof(cost));
+  REQUIRE(cost.parse_ms >= 0);
+  return cost;
+}
+
+}  // namespace
+
+TEST_CASE("RPC response layouts", "[benchmark]") {
+  const std::string fixture = BuildSearchFixture(kFixturePackages);
+  REQUIRE(!fixture.empty());
+
+  const LayoutCost regular = MeasureLayout([&fixture] {
+    const auto response = aurpp::RpcResponse::Parse(fixture);
+    return response.has_value() ? response->packages.size() : 0;
+  });
+  const LayoutCost compact = MeasureLayout([&fixture] {
+    const auto response = aurpp::CompactRpcResponse::Parse(fixture);
+    return response.has_value() ? response->size() : 0;
+  });
+
+  std::puts(std::format("{} packages, {} byte response", kFixturePackages,
+                        fixture.size())
+                .c_str());
+  std::puts(std::format("{:<20}{:>12}{:>16}", "layout", "parse (ms)",
+                        "peak RSS (KiB)")
+                .c_str());
+  std::puts(std::format("{:<20}{:>12.1f}{:>16}", "RpcResponse",
+                        regular.parse_ms, regular.peak_rss_kib)
+                .c_str());
+  std::puts(std::format("{:<20}{:>12.1f}{:>16}", "CompactRpcResponse",
+                        compact.parse_ms, compact.peak_rss_kib)
+                .c_str());
+
+  BENCHMARK("RpcResponse::Parse") {
+    return aurpp::RpcResponse::Parse(fixture);
+  };
+
+  BENCHMARK("CompactRpcResponse::Parse") {
+    return aurpp::CompactRpcResponse::Parse(fixture);
+  };
+}
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: MIT
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <format>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "aurpp/decoder.h"
+#include "aurpp/stream.h"
+#include "bench_fixture.h"
+
+namespace {
+
+constexpr std::size_t kFixturePackages = 5000;
+
+std::vector<aurpp::AurPackage> DecodeWithJsoncpp(const std::string &fixture) {
+  Json::CharReaderBuilder reader_builder;
+  reader_builder["collectComments"] = false;
+  Json::Value json;
+  std::string errors;
+  std::istringstream stream{fixture};
+  Json::parseFromStream(reader_builder, stream, &json, &errors);
+
+  std::vector<aurpp::AurPackage> packages;
+  for (const Json::Value &info : json["results"]) {
+    packages.push_back(aurpp::AurPackage::FromJson(info));
+  }
+  return packages;
+}
+
+std::vector<aurpp::AurPackage> DecodeWithRpcDecoder(
+    const std::string &fixture) {
+  std::vector<aurpp::AurPackage> packages;
+  const auto count = aurpp::RpcDecoder::Decode(
+      fixture, [&packages](aurpp::AurPackage package) {
+        packages.push_back(std::move(package));
+      });
+  return count.has_value() ? std::move(packages)
+                           : std::vector<aurpp::AurPackage>{};
+}
+
+std::vector<aurpp::AurPackage> DecodeWithStream(const std::string &fixture) {
+  constexpr std::size_t kChunkSize = 16 * 1024;
+
+  std::vector<aurpp::AurPackage> packages;
+  aurpp::RpcResponseStream stream{[&packages](aurpp::AurPackage package) {
+    packages.push_back(std::move(package));
+  }};
+  for (std::size_t i = 0; i < fixture.size(); i += kChunkSize) {
+    stream.Feed(std::string_view{fixture}.substr(i, kChunkSize));
+  }
+  return packages;
+}
+
+}  // namespace
+
+TEST_CASE("RPC response decoding", "[benchmark]") {
+  const std::string fixture = BuildSearchFixture(kFixturePackages);
+
+  REQUIRE(DecodeWithJsoncpp(fixture).size() == kFixturePackages);
+  REQUIRE(DecodeWithRpcDecoder(fixture).size() == kFixturePackages);
+  REQUIRE(DecodeWithStream(fixture).size() == kFixturePackages);
+
+  BENCHMARK(std::format("jsoncpp DOM ({} bytes)", fixture.size())) {
+    return DecodeWithJsoncpp(fixture);
+  };
+
+  BENCHMARK(std::format("RpcDecoder ({} bytes)", fixture.size())) {
+    return DecodeWithRpcDecoder(fixture);
+  };
+
+  BENCHMARK(std::format("RpcResponseStream ({} bytes)", fixture.size())) {
+    return DecodeWithStream(fixture);
+  };
+}
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <functional>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+
+#include "aurpp/ranking.h"
+#include "aurpp/response.h"
+#include "bench_fixture.h"
+
+namespace {
+
+constexpr std::size_t kFixturePackages = 100000;
+constexpr std::size_t kLimit = 20;
+
+}  // namespace
+
+TEST_CASE("Ranking search results", "[benchmark]") {
+  const auto response =
+      aurpp::RpcResponse::Parse(BuildSearchFixture(kFixturePackages));
+  REQUIRE(response.has_value());
+  // The fixture repeats one package, so spread the sort keys
+  std::vector<aurpp::AurPackage> packages = response->packages;
+  for (std::size_t i = 0; i < packages.size(); ++i) {
+    packages[i].set_num_votes(static_cast<int>((i * 7919) % 100003));
+  }
+
+  BENCHMARK("Copying every package") {
+    return std::vector<aurpp::AurPackage>{packages};
+  };
+
+  BENCHMARK("Sorting a copy of every package by votes") {
+    std::vector<aurpp::AurPackage> sorted = packages;
+    std::ranges::stable_sort(sorted, std::greater{},
+                             &aurpp::AurPackage::num_votes);
+    return sorted;
+  };
+
+  BENCHMARK("SelectTop by votes") {
+    return aurpp::SelectTop(packages, aurpp::SortBy::kVotes, kLimit);
+  };
+
+  BENCHMARK("SelectTop by name") {
+    return aurpp::SelectTop(packages, aurpp::SortBy::kName, kLimit);
+  };
+}
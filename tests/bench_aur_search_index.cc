@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: MIT
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "aurpp/response.h"
+#include "aurpp/search_index.h"
+#include "bench_fixture.h"
+#include "temp_dir.h"
+
+namespace {
+
+constexpr std::size_t kFixturePackages = 100000;
+
+using SearchBy = aurpp::SearchRequest::SearchBy;
+using Terms = std::vector<std::string_view>;
+
+}  // namespace
+
+TEST_CASE("Offline AUR search", "[benchmark]") {
+  const auto response =
+      aurpp::RpcResponse::Parse(BuildSearchFixture(kFixturePackages));
+  REQUIRE(response.has_value());
+  std::vector<aurpp::AurPackage> packages = response->packages;
+
+  const TempDir temp{"bench-index"};
+  const std::filesystem::path directory = temp / "index";
+
+  aurpp::SearchIndex index = aurpp::SearchIndex::Open(directory);
+  REQUIRE(index.Update(packages, "v1").has_value());
+  REQUIRE(index.Search(SearchBy::kName, Terms{"paru-4242"})->packages.size() ==
+          11);
+
+  BENCHMARK("Linear scan for a name") {
+    std::size_t matches = 0;
+    for (const aurpp::AurPackage &package : packages) {
+      matches += package.name().find("paru-4242") != std::string_view::npos;
+    }
+    return matches;
+  };
+
+  BENCHMARK("SearchIndex::Open") {
+    return aurpp::SearchIndex::Open(directory).size();
+  };
+
+  BENCHMARK("SearchIndex name search") {
+    return index.Search(SearchBy::kName, Terms{"paru-4242"});
+  };
+
+  BENCHMARK("SearchIndex two term name search") {
+    return index.Search(SearchBy::kName, Terms{"paru", "4242"});
+  };
+
+  BENCHMARK("SearchIndex exact term matching every package") {
+    return index.Search(SearchBy::kDepends, Terms{"git"});
+  };
+
+  BENCHMARK("SearchIndex::Update with 100 changed packages") {
+    for (std::size_t i = 0; i < 100; ++i) {
+      packages[i * 997].set_version(std::format("{}", i));
+    }
+    return index.Update(packages, "v2")->indexed;
+  };
+}
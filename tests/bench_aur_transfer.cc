@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: MIT
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <print>
+#include <string>
+#include <string_view>
+
+#include "aurpp/client.h"
+#include "aurpp/request.h"
+#include "aurpp/response.h"
+#include "bench_fixture.h"
+#include "loopback_server.h"
+
+namespace {
+
+constexpr std::size_t kFixturePackages = 1000;
+// A 100 Mbit/s link, so the transfers cost what they would over a network
+// rather than what a loopback copy costs
+constexpr std::size_t kLinkBytesPerSecond = 12'500'000;
+
+// Serves fixture gzipped to clients that accept it, if compress is set
+LoopbackServer::Responder ServeFixture(const std::string &fixture,
+                                       const std::string &gzipped,
+                                       const bool compress) {
+  return [&fixture, &gzipped, compress](int, const std::string_view request) {
+    Reply reply;
+    reply.bytes_per_second = kLinkBytesPerSecond;
+    if (compress && request.contains("gzip")) {
+      reply.body = gzipped;
+      reply.headers = "Content-Encoding: gzip\r\n";
+    } else {
+      reply.body = fixture;
+    }
+    return reply;
+  };
+}
+
+}  // namespace
+
+TEST_CASE("Compressed transfers", "[benchmark]") {
+  const std::string fixture = BuildSearchFixture(kFixturePackages);
+  REQUIRE_FALSE(fixture.empty());
+  const std::string gzipped = Gzip(fixture);
+
+  LoopbackServer plain_server{ServeFixture(fixture, gzipped, false)};
+  LoopbackServer gzip_server{ServeFixture(fixture, gzipped, true)};
+  aurpp::Client plain_client{plain_server.url()};
+  aurpp::Client gzip_client{gzip_server.url()};
+
+  std::size_t plain_bytes = 0;
+  std::size_t gzip_bytes = 0;
+  plain_client.set_transfer_observer(
+      [&plain_bytes](const aurpp::TransferInfo &info) {
+        plain_bytes = info.downloaded_bytes;
+      });
+  gzip_client.set_transfer_observer(
+      [&gzip_bytes](const aurpp::TransferInfo &info) {
+        gzip_bytes = info.downloaded_bytes;
+      });
+
+  const aurpp::SearchRequest request{aurpp::SearchRequest::SearchBy::kName,
+                                     "paru"};
+
+  BENCHMARK("Uncompressed search response") {
+    return plain_client.Execute<aurpp::SearchRequest, aurpp::RpcResponse>(
+        request);
+  };
+
+  BENCHMARK("Gzip search response") {
+    return gzip_client.Execute<aurpp::SearchRequest, aurpp::RpcResponse>(
+        request);
+  };
+
+  BENCHMARK("Gzip search response, streamed") {
+    return gzip_client.ExecuteStreaming(request, [](aurpp::AurPackage) {});
+  };
+
+  std::println("Bytes on the wire for {} packages: {} uncompressed, {} gzip",
+               kFixturePackages, plain_bytes, gzip_bytes);
+  REQUIRE(gzip_bytes == gzipped.size());
+  REQUIRE(plain_bytes == fixture.size());
+}
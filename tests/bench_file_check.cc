@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../src/file_check.h"
+#include "../src/mtree.h"
+#include "temp_dir.h"
+
+namespace {
+
+constexpr std::size_t kPackages = 200;
+constexpr std::size_t kFilesPerPackage = 250;
+
+// For -Qkk, which reads every byte
+constexpr std::size_t kHashedFiles = 32;
+constexpr std::size_t kHashedFileSize = 4 << 20;
+
+// How -Qk checked a package before, with a path built and two stat calls
+// made for every file
+std::size_t CheckSerially(const std::string_view root,
+                          const yarp::FileCheckPackage &package) {
+  return std::ranges::count_if(package.files, [&](const std::string_view file) {
+    const std::string absolute_file_name = std::format("{}{}", root, file);
+    if (!std::filesystem::exists(absolute_file_name)) {
+      return true;
+    }
+    const bool expect_dir = absolute_file_name.back() == '/';
+    return expect_dir != std::filesystem::is_directory(absolute_file_name);
+  });
+}
+
+}  // namespace
+
+TEST_CASE("Checking the files of every package", "[benchmark]") {
+  const TempDir temp{"bench-file-check"};
+  const std::filesystem::path &root = temp.path();
+
+  std::vector<std::string> paths;
+  paths.reserve(kPackages * (kFilesPerPackage + 1));
+  for (std::size_t i = 0; i < kPackages; ++i) {
+    const std::string directory = std::format("usr/share/package-{}/", i);
+    std::filesystem::create_directories(root / directory);
+    paths.push_back(directory);
+    for (std::size_t j = 0; j < kFilesPerPackage; ++j) {
+      paths.push_back(std::format("{}file-{}", directory, j));
+      // Every tenth file is missing
+      if (j % 10 != 0) {
+        std::ofstream{root / paths.back()};
+      }
+    }
+  }
+
+  std::vector<yarp::FileCheckPackage> packages;
+  for (std::size_t i = 0; i < kPackages; ++i) {
+    yarp::FileCheckPackage &package = packages.emplace_back(
+        yarp::FileCheckPackage{paths[i * (kFilesPerPackage + 1)], {}});
+    const auto first = paths.begin() + i * (kFilesPerPackage + 1);
+    package.files.assign(first, first + kFilesPerPackage + 1);
+  }
+
+  const std::string root_prefix = std::format("{}/", root.string());
+  const auto results = yarp::CheckFiles(root, packages);
+  REQUIRE(results.has_value());
+  std::size_t missing = 0;
+  for (const yarp::FileCheckResult &result : results.value()) {
+    missing += result.missing;
+  }
+  REQUIRE(missing == kPackages * kFilesPerPackage / 10);
+
+  BENCHMARK("Serial exists and is_directory per file") {
+    std::size_t errors = 0;
+    for (const yarp::FileCheckPackage &package : packages) {
+      errors += CheckSerially(root_prefix, package);
+    }
+    return errors;
+  };
+
+  BENCHMARK("CheckFiles") { return CheckFiles(root, packages); };
+}
+
+TEST_CASE("Hashing the files of every package", "[benchmark]") {
+  const TempDir temp{"bench-file-check-full"};
+  const std::filesystem::path &root = temp.path();
+
+  std::string contents(kHashedFileSize, '\0');
+  for (std::size_t i = 0; i < contents.size(); ++i) {
+    contents[i] = static_cast<char>(i * 2654435761U >> 24);
+  }
+
+  std::vector<yarp::MtreeEntry> entries;
+  for (std::size_t i = 0; i < kHashedFiles; ++i) {
+    const std::string path = std::format("file-{}", i);
+    std::ofstream{root / path, std::ios::binary} << contents;
+    // No digest matches, so every file is read to the end
+    entries.push_back({path, yarp::MtreeType::kFile, std::nullopt,
+                       static_cast<std::int64_t>(contents.size()),
+                       std::nullopt, std::nullopt, yarp::Sha256Digest{}});
+  }
+  const std::vector<yarp::FullCheckPackage> packages{{"package", entries, {}}};
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto results = yarp::CheckFilesFull(root, packages);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  REQUIRE(results.has_value());
+  REQUIRE(results->front().altered == kHashedFiles);
+  std::println("Hashed {} MiB from the page cache at {:.0f} MiB/s",
+               kHashedFiles * kHashedFileSize >> 20,
+               static_cast<double>(kHashedFiles * kHashedFileSize >> 20) /
+                   elapsed.count());
+
+  BENCHMARK("CheckFilesFull") { return CheckFilesFull(root, packages); };
+}
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef YARP_TESTS_BENCH_FIXTURE_H_
+#define YARP_TESTS_BENCH_FIXTURE_H_
+
+#include <json/json.h>
+
+#include <cstddef>
+#include <format>
+#include <fstream>
+#include <string>
+
+// Builds a search response with the given number of packages by repeating
+// the paru.json package under different names and IDs. Returns an empty
+// string if paru.json can't be read.
+inline std::string BuildSearchFixture(const std::size_t package_count) {
+  std::ifstream file{"paru.json"};
+  Json::CharReaderBuilder reader_builder;
+  Json::Value json;
+  std::string errors;
+  if (!Json::parseFromStream(reader_builder, file, &json, &errors)) {
+    return {};
+  }
+
+  Json::StreamWriterBuilder writer_builder;
+  writer_builder["indentation"] = "";
+
+  std::string fixture = std::format(
+      R"({{"resultcount":{},"type":"search","version":5,"results":[)",
+      package_count);
+  Json::Value package = json["results"][0];
+  for (std::size_t i = 0; i < package_count; ++i) {
+    package["Name"] = std::format("paru-{}", i);
+    package["ID"] = static_cast<Json::UInt64>(i);
+    if (i > 0) {
+      fixture.push_back(',');
+    }
+    fixture += Json::writeString(writer_builder, package);
+  }
+  fixture += "]}";
+  return fixture;
+}
+
+#endif  // YARP_TESTS_BENCH_FIXTURE_H_
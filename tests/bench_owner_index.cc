@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../src/owner_index.h"
+#include "temp_dir.h"
+
+namespace {
+
+// About what a desktop installation has
+constexpr std::size_t kPackages = 1500;
+constexpr std::size_t kFilesPerPackage = 300;
+
+}  // namespace
+
+TEST_CASE("File owner lookups", "[benchmark]") {
+  std::vector<std::string> names;
+  std::vector<std::string> paths;
+  names.reserve(kPackages);
+  paths.reserve(kPackages * kFilesPerPackage);
+  for (std::size_t i = 0; i < kPackages; ++i) {
+    names.push_back(std::format("package-{}", i));
+    for (std::size_t j = 0; j < kFilesPerPackage; ++j) {
+      paths.push_back(std::format("usr/share/package-{}/file-{}", i, j));
+    }
+  }
+
+  std::vector<yarp::OwnerIndex::Package> packages;
+  for (std::size_t i = 0; i < kPackages; ++i) {
+    yarp::OwnerIndex::Package &package =
+        packages.emplace_back(yarp::OwnerIndex::Package{names[i], "1.0-1", {}});
+    for (std::size_t j = 0; j < kFilesPerPackage; ++j) {
+      package.files.emplace_back(paths[i * kFilesPerPackage + j]);
+    }
+  }
+
+  const TempDir dir{"bench-owners"};
+  const std::filesystem::path path = dir / "owners";
+  const yarp::OwnerIndex index = yarp::OwnerIndex::Build(packages, "", 0);
+  REQUIRE(index.Save(path).has_value());
+
+  // Owned by the last package, the worst case of a scan
+  const std::string_view target = paths.back();
+  REQUIRE(index.Owners(target).size() == 1);
+
+  BENCHMARK("Linear scan of every file list") {
+    std::size_t owners = 0;
+    for (const yarp::OwnerIndex::Package &package : packages) {
+      owners += std::ranges::any_of(
+          package.files,
+          [target](const std::string_view file) { return file == target; });
+    }
+    return owners;
+  };
+
+  BENCHMARK("OwnerIndex lookup") { return index.Owners(target); };
+
+  BENCHMARK("OwnerIndex lookup of 1000 paths") {
+    std::size_t owners = 0;
+    for (std::size_t i = 0; i < 1000; ++i) {
+      owners += index.Owners(paths[i * 449]).size();
+    }
+    return owners;
+  };
+
+  BENCHMARK("OwnerIndex::Load") { return yarp::OwnerIndex::Load(path); };
+
+  BENCHMARK("OwnerIndex::Build") {
+    return yarp::OwnerIndex::Build(packages, "", 0);
+  };
+}
@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef YARP_TESTS_LIST_EQUALS_H_
+#define YARP_TESTS_LIST_EQUALS_H_
+
+#include <algorithm>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// List accessors return spans, which can't be compared with ==. A missing
+// list only equals another missing list.
+inline bool ListEquals(
+    const std::optional<std::span<const std::string>> list,
+    const std::optional<std::span<const std::string>> expected) {
+  if (!list.has_value() || !expected.has_value()) {
+    return list.has_value() == expected.has_value();
+  }
+  return std::ranges::equal(list.value(), expected.value());
+}
+
+inline bool ListEquals(const std::optional<std::span<const std::string>> list,
+                       const std::vector<std::string> &expected) {
+  return ListEquals(list, std::span<const std::string>{expected});
+}
+
+#endif  // YARP_TESTS_LIST_EQUALS_H_
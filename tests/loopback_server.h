@@ -0,0 +1,223 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef YARP_TESTS_LOOPBACK_SERVER_H_
+#define YARP_TESTS_LOOPBACK_SERVER_H_
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <format>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct Reply {
+  int status = 200;
+  std::string body;
+  // Extra header lines, each ending in \r\n
+  std::string headers;
+  std::chrono::milliseconds delay{0};
+  // Paces the response like a link of this speed. Zero sends it at once.
+  std::size_t bytes_per_second = 0;
+};
+
+inline Reply Success(std::string body,
+                     const std::chrono::milliseconds delay = {}) {
+  Reply reply;
+  reply.body = std::move(body);
+  reply.delay = delay;
+  return reply;
+}
+
+inline Reply Failure(const int status, std::string headers) {
+  Reply reply;
+  reply.status = status;
+  reply.headers = std::move(headers);
+  return reply;
+}
+
+// Compresses data like a server sending Content-Encoding: gzip
+inline std::string Gzip(const std::string_view data) {
+  z_stream stream{};
+  deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+               Z_DEFAULT_STRATEGY);
+  std::string compressed(deflateBound(&stream, data.size()), '\0');
+  stream.next_in =
+      reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  stream.next_out = reinterpret_cast<Bytef *>(compressed.data());
+  stream.avail_out = static_cast<uInt>(compressed.size());
+  deflate(&stream, Z_FINISH);
+  compressed.resize(stream.total_out);
+  deflateEnd(&stream);
+  return compressed;
+}
+
+// Answers HTTP requests on a loopback port with what respond returns for the
+// number of the request and the request itself, head and body. Connections
+// are kept alive like a real server's, so clients can reuse them.
+class LoopbackServer {
+ public:
+  using Responder = std::function<Reply(int, std::string_view)>;
+
+  explicit LoopbackServer(Responder respond) : respond_(std::move(respond)) {
+    socket_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(socket_, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+    socklen_t length = sizeof(address);
+    getsockname(socket_, reinterpret_cast<sockaddr *>(&address), &length);
+    port_ = ntohs(address.sin_port);
+    listen(socket_, 128);
+    acceptor_ = std::jthread{[this] { Accept(); }};
+  }
+
+  LoopbackServer(const LoopbackServer &) = delete;
+  LoopbackServer &operator=(const LoopbackServer &) = delete;
+
+  ~LoopbackServer() {
+    shutdown(socket_, SHUT_RDWR);
+    close(socket_);
+    // Wakes the handlers waiting for another request on an idle connection
+    const std::lock_guard lock{mutex_};
+    stopping_ = true;
+    for (const int connection : connections_) {
+      shutdown(connection, SHUT_RDWR);
+    }
+  }
+
+  [[nodiscard]] std::string url() const {
+    return std::format("http://127.0.0.1:{}", port_);
+  }
+
+  [[nodiscard]] int requests() const { return requests_; }
+
+ private:
+  void Accept() {
+    while (true) {
+      const int connection = accept(socket_, nullptr, nullptr);
+      if (connection < 0) {
+        return;
+      }
+      {
+        const std::lock_guard lock{mutex_};
+        if (stopping_) {
+          close(connection);
+          return;
+        }
+        connections_.push_back(connection);
+      }
+      handlers_.emplace_back([this, connection] { Serve(connection); });
+    }
+  }
+
+  void Serve(const int connection) {
+    std::string buffer;
+    std::string request;
+    while (ReadRequest(connection, buffer, request) &&
+           Respond(connection, requests_++, request)) {
+    }
+    {
+      const std::lock_guard lock{mutex_};
+      std::erase(connections_, connection);
+    }
+    close(connection);
+  }
+
+  // Moves the next request on connection out of buffer into request, reading
+  // more as needed. Returns false once the client closes the connection.
+  static bool ReadRequest(const int connection, std::string &buffer,
+                          std::string &request) {
+    std::size_t head_end = std::string::npos;
+    std::size_t length = 0;
+    while (true) {
+      if (head_end == std::string::npos) {
+        head_end = buffer.find("\r\n\r\n");
+        if (head_end != std::string::npos) {
+          head_end += 4;
+          length = head_end + ContentLength(buffer.substr(0, head_end));
+        }
+      }
+      if (head_end != std::string::npos && buffer.size() >= length) {
+        request = buffer.substr(0, length);
+        buffer.erase(0, length);
+        return true;
+      }
+      char chunk[4096];
+      const ssize_t size = read(connection, chunk, sizeof(chunk));
+      if (size <= 0) {
+        return false;
+      }
+      buffer.append(chunk, static_cast<std::size_t>(size));
+    }
+  }
+
+  static std::size_t ContentLength(std::string head) {
+    std::ranges::transform(head, head.begin(), [](const unsigned char c) {
+      return static_cast<char>(std::tolower(c));
+    });
+    constexpr std::string_view kHeader = "\r\ncontent-length:";
+    const std::size_t position = head.find(kHeader);
+    if (position == std::string::npos) {
+      return 0;
+    }
+    return std::strtoull(head.c_str() + position + kHeader.size(), nullptr,
+                         10);
+  }
+
+  // Returns false if the response couldn't be sent
+  bool Respond(const int connection, const int number,
+               const std::string_view request) {
+    const Reply reply = respond_(number, request);
+    std::this_thread::sleep_for(reply.delay);
+    const std::string response =
+        std::format("HTTP/1.1 {} Status\r\nContent-Length: {}\r\n{}\r\n{}",
+                    reply.status, reply.body.size(), reply.headers, reply.body);
+
+    // Sent in slices of a hundredth of a second's worth when paced
+    const std::size_t slice =
+        reply.bytes_per_second == 0
+            ? response.size()
+            : std::max<std::size_t>(reply.bytes_per_second / 100, 1);
+    for (std::size_t sent = 0; sent < response.size(); sent += slice) {
+      const std::size_t size = std::min(slice, response.size() - sent);
+      // Without MSG_NOSIGNAL, writing to a connection the client has given
+      // up on would kill the test with SIGPIPE
+      if (send(connection, response.data() + sent, size, MSG_NOSIGNAL) < 0) {
+        return false;
+      }
+      if (reply.bytes_per_second != 0 && sent + size < response.size()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+      }
+    }
+    return true;
+  }
+
+  Responder respond_;
+  int socket_ = -1;
+  int port_ = 0;
+  std::atomic<int> requests_{0};
+  std::mutex mutex_;
+  // Open connections and whether the server is stopping, guarded by mutex_
+  std::vector<int> connections_;
+  bool stopping_ = false;
+  // Declared before the acceptor, which is joined first and so no longer
+  // adds handlers by the time they are joined
+  std::vector<std::jthread> handlers_;
+  std::jthread acceptor_;
+};
+
+#endif  // YARP_TESTS_LOOPBACK_SERVER_H_
@@ -0,0 +1,312 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef YARP_TESTS_MOCK_AUR_SERVER_H_
+#define YARP_TESTS_MOCK_AUR_SERVER_H_
+
+#include <curl/curl.h>
+#include <json/json.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "loopback_server.h"
+
+struct MockAurOptions {
+  // Added to every response, like the time the AUR takes to answer
+  std::chrono::milliseconds latency{0};
+  // Every nth request fails with error_status. Zero never fails.
+  int fail_every = 0;
+  int error_status = 503;
+};
+
+// The packages a MockAurServer serves: the package in paru.json, and copies
+// of it named after other AUR helpers. Empty if paru.json can't be read.
+inline std::vector<Json::Value> MockAurPackages() {
+  std::ifstream file{"paru.json"};
+  Json::CharReaderBuilder reader_builder;
+  Json::Value json;
+  std::string errors;
+  if (!Json::parseFromStream(reader_builder, file, &json, &errors)) {
+    return {};
+  }
+
+  struct Variant {
+    std::string_view name;
+    std::string_view description;
+    // What the package provides and conflicts with, if not empty
+    std::string_view provides;
+  };
+  constexpr std::array<Variant, 7> kVariants{{
+      {"paru", "", ""},
+      {"paru-bin", "", "paru"},
+      {"paru-git", "", "paru"},
+      {"yay", "Yet another yogurt. Pacman wrapper and AUR helper.", ""},
+      {"yay-bin", "Yet another yogurt. Pacman wrapper and AUR helper.",
+       "yay"},
+      {"pikaur", "AUR helper which asks all questions before building", ""},
+      {"aurutils", "helper tools for the arch user repository", ""},
+  }};
+
+  const Json::Value &paru = json["results"][0];
+  std::vector<Json::Value> packages;
+  for (std::size_t index = 0; index < kVariants.size(); ++index) {
+    const Variant &variant = kVariants[index];
+    Json::Value &package = packages.emplace_back(paru);
+    package["Name"] = std::string{variant.name};
+    package["PackageBase"] = std::string{variant.name};
+    package["ID"] = paru["ID"].asUInt64() + static_cast<Json::UInt64>(index);
+    if (!variant.description.empty()) {
+      package["Description"] = std::string{variant.description};
+    }
+    if (!variant.provides.empty()) {
+      package["Provides"].append(std::string{variant.provides});
+      package["Conflicts"].append(std::string{variant.provides});
+    }
+  }
+  return packages;
+}
+
+// Stands in for the AUR on a loopback port. Serves the RPC info and search
+// endpoints and the cgit source files of MockAurPackages, answering like the
+// AUR does for the requests aurpp::Client makes.
+class MockAurServer {
+ public:
+  explicit MockAurServer(const MockAurOptions options = {})
+      : options_(options),
+        packages_(MockAurPackages()),
+        server_{[this](const int number, const std::string_view request) {
+          return Respond(number, request);
+        }} {}
+
+  [[nodiscard]] std::string url() const { return server_.url(); }
+
+  [[nodiscard]] int requests() const { return server_.requests(); }
+
+ private:
+  using Parameters = std::vector<std::pair<std::string, std::string>>;
+
+  static std::string Unescape(const std::string_view sv) {
+    int length = 0;
+    char *ptr = curl_easy_unescape(nullptr, sv.data(),
+                                   static_cast<int>(sv.size()), &length);
+    std::string unescaped{ptr, static_cast<std::size_t>(length)};
+    curl_free(ptr);
+    return unescaped;
+  }
+
+  // The key=value pairs of a query string or form body
+  static Parameters ParseParameters(const std::string_view sv) {
+    Parameters parameters;
+    for (const auto part : std::views::split(sv, '&')) {
+      const std::string_view pair{part.begin(), part.end()};
+      const std::size_t equals = pair.find('=');
+      if (equals != std::string_view::npos) {
+        parameters.emplace_back(Unescape(pair.substr(0, equals)),
+                                Unescape(pair.substr(equals + 1)));
+      }
+    }
+    return parameters;
+  }
+
+  static std::string RpcBody(const std::string_view type,
+                             const Json::Value &results,
+                             const std::string_view error = {}) {
+    Json::Value json;
+    if (!error.empty()) {
+      json["error"] = std::string{error};
+    }
+    json["resultcount"] = results.size();
+    json["results"] = results;
+    json["type"] = std::string{type};
+    json["version"] = 5;
+    Json::StreamWriterBuilder writer_builder;
+    writer_builder["indentation"] = "";
+    return Json::writeString(writer_builder, json);
+  }
+
+  // The name of the package field a search by field looks in, nullopt if the
+  // AUR doesn't support searching by it
+  static std::optional<std::string_view> SearchField(
+      const std::string_view by) {
+    constexpr std::array<std::pair<std::string_view, std::string_view>, 13>
+        kFields{{{"name", "Name"},
+                 {"name-desc", "Name"},
+                 {"maintainer", "Maintainer"},
+                 {"submitter", "Submitter"},
+                 {"depends", "Depends"},
+                 {"makedepends", "MakeDepends"},
+                 {"checkdepends", "CheckDepends"},
+                 {"optdepends", "OptDepends"},
+                 {"provides", "Provides"},
+                 {"conflicts", "Conflicts"},
+                 {"replaces", "Replaces"},
+                 {"keywords", "Keywords"},
+                 {"groups", "Groups"}}};
+    const auto *field = std::ranges::find(
+        kFields, by, &std::pair<std::string_view, std::string_view>::first);
+    if (field == kFields.end()) {
+      return std::nullopt;
+    }
+    return field->second;
+  }
+
+  // Names match on a substring, like the AUR. Every other field matches on
+  // a whole entry, ignoring version constraints.
+  static bool Matches(const Json::Value &package, const std::string_view by,
+                      const std::string_view field,
+                      const std::string_view term) {
+    const Json::Value &value = package[std::string{field}];
+    if (by == "name" || by == "name-desc") {
+      return value.asString().contains(term) ||
+             (by == "name-desc" &&
+              package["Description"].asString().contains(term));
+    }
+    if (value.isString()) {
+      return value.asString() == term;
+    }
+    for (const Json::Value &entry : value) {
+      const std::string name = entry.asString();
+      if (std::string_view{name}.substr(0, name.find_first_of("<>=:")) ==
+          term) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::string Info(const Parameters &parameters) const {
+    Json::Value results{Json::arrayValue};
+    for (const auto &[key, name] : parameters) {
+      if (key != "arg[]" && key != "arg") {
+        continue;
+      }
+      const auto package =
+          std::ranges::find_if(packages_, [&name](const Json::Value &p) {
+            return p["Name"].asString() == name;
+          });
+      if (package != packages_.end()) {
+        results.append(*package);
+      }
+    }
+    return RpcBody("multiinfo", results);
+  }
+
+  std::string Search(const std::string_view term,
+                     const Parameters &parameters) const {
+    std::string by = "name-desc";
+    for (const auto &[key, value] : parameters) {
+      if (key == "by") {
+        by = value;
+      }
+    }
+    const std::optional<std::string_view> field = SearchField(by);
+    if (!field.has_value()) {
+      return RpcBody("error", Json::Value{Json::arrayValue},
+                     "Incorrect by field specified.");
+    }
+
+    Json::Value results{Json::arrayValue};
+    for (const Json::Value &package : packages_) {
+      if (Matches(package, by, *field, term)) {
+        results.append(package);
+      }
+    }
+    return RpcBody("search", results);
+  }
+
+  // A PKGBUILD or .SRCINFO for the package base in parameters
+  std::optional<std::string> SourceFile(const std::string_view file,
+                                        const Parameters &parameters) const {
+    const auto base = std::ranges::find(
+        parameters, "h", &std::pair<std::string, std::string>::first);
+    if (base == parameters.end()) {
+      return std::nullopt;
+    }
+    const auto package =
+        std::ranges::find_if(packages_, [&base](const Json::Value &p) {
+          return p["PackageBase"].asString() == base->second;
+        });
+    if (package == packages_.end()) {
+      return std::nullopt;
+    }
+
+    const std::string name = (*package)["Name"].asString();
+    const std::string version = (*package)["Version"].asString();
+    const std::string_view pkgver =
+        std::string_view{version}.substr(0, version.rfind('-'));
+    const std::string_view pkgrel =
+        std::string_view{version}.substr(version.rfind('-') + 1);
+    const std::string description = (*package)["Description"].asString();
+    if (file == "PKGBUILD") {
+      return std::format("pkgname={}\npkgver={}\npkgrel={}\npkgdesc=\"{}\"\n",
+                         name, pkgver, pkgrel, description);
+    }
+    if (file == ".SRCINFO") {
+      return std::format(
+          "pkgbase = {}\n\tpkgdesc = {}\n\tpkgver = {}\n\tpkgrel = {}\n\n"
+          "pkgname = {}\n",
+          base->second, description, pkgver, pkgrel, name);
+    }
+    return std::nullopt;
+  }
+
+  Reply Respond(const int number, const std::string_view request) const {
+    Reply reply;
+    reply.delay = options_.latency;
+    if (options_.fail_every > 0 && (number + 1) % options_.fail_every == 0) {
+      reply.status = options_.error_status;
+      return reply;
+    }
+
+    // The request line is "METHOD target HTTP/1.1"
+    const std::string_view line = request.substr(0, request.find("\r\n"));
+    const std::size_t target_start = line.find(' ') + 1;
+    const std::string_view target =
+        line.substr(target_start, line.rfind(' ') - target_start);
+    const std::size_t query_start = target.find('?');
+    const std::string_view path = target.substr(0, query_start);
+    const std::string_view query = query_start == std::string_view::npos
+                                       ? std::string_view{}
+                                       : target.substr(query_start + 1);
+    const std::size_t body_start = request.find("\r\n\r\n") + 4;
+    const std::string_view body = request.substr(body_start);
+
+    constexpr std::string_view kSearchPath = "/rpc/v5/search/";
+    constexpr std::string_view kSourcePath = "/cgit/aur.git/plain/";
+    if (path == "/rpc/v5/info") {
+      reply.body = Info(ParseParameters(body.empty() ? query : body));
+    } else if (path.starts_with(kSearchPath)) {
+      reply.body = Search(Unescape(path.substr(kSearchPath.size())),
+                          ParseParameters(query));
+    } else if (path.starts_with(kSourcePath)) {
+      std::optional<std::string> file = SourceFile(
+          path.substr(kSourcePath.size()), ParseParameters(query));
+      if (file.has_value()) {
+        reply.body = std::move(file.value());
+      } else {
+        reply.status = 404;
+      }
+    } else {
+      reply.status = 404;
+    }
+    return reply;
+  }
+
+  MockAurOptions options_;
+  std::vector<Json::Value> packages_;
+  // Declared last, so it stops answering before what it answers from is
+  // destroyed
+  LoopbackServer server_;
+};
+
+#endif  // YARP_TESTS_MOCK_AUR_SERVER_H_
@@ -3,6 +3,7 @@
 import os
 import subprocess
 import sys
+import tempfile
 from pathlib import Path
 from typing import Any, Dict, List, Optional
 
@@ -28,18 +29,23 @@ class Test:
 
         self.mock_db_args = ["--root", "/var/empty", "--dbpath", str(self.db_path)]
 
-    def run(self, args: List[str], env: Optional[Dict[str, str]] = None) -> TestResult:
-        return self.run_raw(self.yarp, self.mock_db_args + args, env)
+        # yarp keeps its owner index, response cache and connection state
+        # under XDG_CACHE_HOME, which must not be the user's own cache
+        self._cache_dir = tempfile.TemporaryDirectory()
+        os.environ["XDG_CACHE_HOME"] = self._cache_dir.name
+
+    def run(self, args: List[str], env: Optional[Dict[str, str]] = None, input: Optional[str] = None) -> TestResult:
+        return self.run_raw(self.yarp, self.mock_db_args + args, env, input)
 
     def run_pacman(self, args: List[str], env: Optional[Dict[str, str]] = None) -> TestResult:
         return self.run_raw("pacman", self.mock_db_args + args, env)
 
-    def run_raw(self, command: str, args: List[str], env: Optional[Dict[str, str]] = None) -> TestResult:
+    def run_raw(self, command: str, args: List[str], env: Optional[Dict[str, str]] = None, input: Optional[str] = None, stdin: Optional[int] = None) -> TestResult:
         """Run pacman or yarp without mock database arguments (for args tests)"""
         cmd = [command] + args
 
         result = subprocess.run(
-            cmd, capture_output=True, text=True, env=env or os.environ.copy()
+            cmd, capture_output=True, text=True, env=env or os.environ.copy(), input=input, stdin=stdin
         )
 
         return TestResult(
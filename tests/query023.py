@@ -0,0 +1,14 @@
+# SPDX-License-Identifier: MIT
+
+import pptest
+import sys
+
+test = pptest.Test(sys.argv[1])
+
+result = test.run_raw(test.yarp, ["--dbpath", str(test.db_path), "-Qo", "cmake", "bar"])
+
+test.assert_returncode(result, 1)
+test.assert_contains(result.stdout, "cmake is owned by cmake 3.20.0-1")
+test.assert_contains(result.stderr, "Error: Could not find bar in PATH")
+
+test.exit_with_result()
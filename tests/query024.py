@@ -0,0 +1,28 @@
+# SPDX-License-Identifier: MIT
+
+import os
+import pptest
+import sys
+
+test = pptest.Test(sys.argv[1])
+
+result = test.run_raw(test.yarp, ["--dbpath", str(test.db_path), "-Qo", "-"], input="cmake\nbar\n")
+
+test.assert_returncode(result, 1)
+test.assert_equals(result.stdout, "cmake\tcmake\t3.20.0-1\n")
+test.assert_contains(result.stderr, "Error: Could not find bar in PATH")
+
+result = test.run_raw(test.yarp, ["--dbpath", str(test.db_path), "-Qo", "-"], input="cmake\0cmake")
+
+test.assert_returncode(result, 0)
+test.assert_equals(result.stdout, "cmake\tcmake\t3.20.0-1\ncmake\tcmake\t3.20.0-1\n")
+
+# Reading a directory fails, which must not pass for the end of the input
+stdin = os.open(".", os.O_RDONLY)
+result = test.run_raw(test.yarp, ["--dbpath", str(test.db_path), "-Qo", "-"], stdin=stdin)
+os.close(stdin)
+
+test.assert_returncode(result, 1)
+test.assert_contains(result.stderr, "Error: Could not read paths from stdin")
+
+test.exit_with_result()
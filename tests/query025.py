@@ -0,0 +1,22 @@
+# SPDX-License-Identifier: MIT
+
+import pptest
+import sys
+
+test = pptest.Test(sys.argv[1])
+
+result = test.run(["-Qkk", "alsa-lib"])
+
+test.assert_returncode(result, 0)
+test.assert_contains(result.stdout, "alsa-lib: /var/empty/usr/bin/aserver (No such file)")
+test.assert_contains(result.stdout, "total files")
+test.assert_contains(result.stdout, "altered files")
+
+# Package files have no mtree in the local database to check against
+result = test.run(["-Qkkp", "yay-12.5.0-1-x86_64.pkg.tar.zst"])
+
+test.assert_returncode(result, 1)
+test.assert_equals(result.stdout, "")
+test.assert_contains(result.stderr, "Error: -kk can only check installed packages")
+
+test.exit_with_result()
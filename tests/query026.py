@@ -0,0 +1,38 @@
+# SPDX-License-Identifier: MIT
+
+import os
+import pptest
+import shutil
+import sys
+import tempfile
+from pathlib import Path
+
+test = pptest.Test(sys.argv[1])
+
+with tempfile.TemporaryDirectory() as tmp:
+    db_path = Path(tmp) / "db"
+    shutil.copytree(test.db_path, db_path, symlinks=True)
+    local = db_path / "local"
+    package = local / "cmake-3.20.0-1"
+    stash = Path(tmp) / package.name
+
+    # Saves an index of a database without cmake
+    shutil.move(package, stash)
+    os.utime(local, (1000000000, 1000000000))
+    result = test.run_raw(test.yarp, ["--dbpath", str(db_path), "-Qo", "cmake"])
+
+    test.assert_returncode(result, 1)
+    test.assert_contains(result.stderr, "No package owns")
+    owners = Path(os.environ["XDG_CACHE_HOME"]) / "yarp" / "owners"
+    test.assert_equals(owners.exists(), True, "The owner index was not saved")
+
+    # Installing cmake changes the stamp of the database, so the saved index
+    # is stale and must be rebuilt rather than answer from the old packages
+    shutil.move(stash, package)
+    os.utime(local, (1000000100, 1000000100))
+    result = test.run_raw(test.yarp, ["--dbpath", str(db_path), "-Qo", "cmake"])
+
+    test.assert_returncode(result, 0)
+    test.assert_contains(result.stdout, "cmake is owned by cmake 3.20.0-1")
+
+test.exit_with_result()
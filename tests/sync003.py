@@ -0,0 +1,57 @@
+# SPDX-License-Identifier: MIT
+
+import gzip
+import os
+import pptest
+import sys
+import tempfile
+from pathlib import Path
+
+test = pptest.Test(sys.argv[1])
+
+dump = b"""[
+  {"ID":1,"Name":"paru","PackageBase":"paru","Version":"2.1.0-1",
+   "Description":"Feature packed AUR helper","NumVotes":1068,"Popularity":22},
+  {"ID":2,"Name":"yay","PackageBase":"yay","Version":"12.5.0-1",
+   "Description":"Yet another yogurt","NumVotes":2000,"Popularity":30}
+]"""
+
+with tempfile.TemporaryDirectory() as tmp:
+    mirror = Path(tmp) / "packages-meta-ext-v1.json.gz"
+    mirror.write_bytes(gzip.compress(dump))
+
+    # Keep the search index out of the user's cache
+    env = os.environ.copy()
+    env["XDG_CACHE_HOME"] = str(Path(tmp) / "cache")
+
+    result = test.run(["-Sa", "--aur-mirror", str(mirror), "paru"], env)
+
+    test.assert_returncode(result, 0)
+    test.assert_contains(result.stdout, "aur/paru 2.1.0-1 [+1068 ~22]\n    Feature packed AUR helper\n")
+    test.assert_not_contains(result.stdout, "aur/yay")
+
+    # Every target must match
+    result = test.run(["-Sa", "--aur-mirror", str(mirror), "pa", "ru"], env)
+
+    test.assert_returncode(result, 0)
+    test.assert_contains(result.stdout, "aur/paru")
+
+    result = test.run(["-Sa", "--aur-mirror", str(mirror), "pa", "ya"], env)
+
+    test.assert_returncode(result, 0)
+    test.assert_not_contains(result.stdout, "aur/")
+
+    # A new dump updates the index
+    mirror.write_bytes(gzip.compress(dump.replace(b"2.1.0-1", b"2.2.0-1")))
+    modified = mirror.stat().st_mtime + 10
+    os.utime(mirror, (modified, modified))
+    result = test.run(["-Sa", "--aur-mirror", str(mirror), "paru"], env)
+
+    test.assert_returncode(result, 0)
+    test.assert_contains(result.stdout, "aur/paru 2.2.0-1")
+
+    result = test.run(["-Sa", "--aur-mirror", str(Path(tmp) / "missing.json.gz"), "paru"], env)
+
+    test.assert_returncode(result, 1)
+
+test.exit_with_result()
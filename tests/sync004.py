@@ -0,0 +1,29 @@
+# SPDX-License-Identifier: MIT
+
+import gzip
+import pptest
+import sys
+import tempfile
+from pathlib import Path
+
+test = pptest.Test(sys.argv[1])
+
+dump = b"""[
+  {"ID":1,"Name":"paru","PackageBase":"paru","Version":"2.1.0-1",
+   "Description":"Feature packed AUR helper","NumVotes":1068,"Popularity":22},
+  {"ID":2,"Name":"paru-bin","PackageBase":"paru-bin","Version":"2.1.0-1",
+   "Description":"Feature packed AUR helper","NumVotes":105,"Popularity":3}
+]"""
+
+with tempfile.TemporaryDirectory() as tmp:
+    mirror = Path(tmp) / "packages-meta-ext-v1.json.gz"
+    mirror.write_bytes(gzip.compress(dump))
+
+    # Every target must match
+    result = test.run(["-Sa", "--aur-mirror", str(mirror), "paru", "bin"])
+
+    test.assert_returncode(result, 0)
+    test.assert_contains(result.stdout, "aur/paru-bin ")
+    test.assert_not_contains(result.stdout, "aur/paru ")
+
+test.exit_with_result()
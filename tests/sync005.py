@@ -0,0 +1,50 @@
+# SPDX-License-Identifier: MIT
+
+import gzip
+import os
+import pptest
+import sys
+import tempfile
+from pathlib import Path
+
+test = pptest.Test(sys.argv[1])
+
+dump = b"""[
+  {"ID":1,"Name":"paru","PackageBase":"paru","Version":"2.1.0-1",
+   "Description":"Feature packed AUR helper","NumVotes":1068,"Popularity":22,
+   "Depends":["git"]},
+  {"ID":2,"Name":"git-git","PackageBase":"git-git","Version":"2.45.0-1",
+   "Description":"the fast distributed version control system",
+   "NumVotes":20,"Popularity":1,"Provides":["git"],"Depends":["curl"]},
+  {"ID":3,"Name":"yay","PackageBase":"yay","Version":"12.5.0-1",
+   "Description":"Yet another yogurt","NumVotes":2000,"Popularity":30}
+]"""
+
+with tempfile.TemporaryDirectory() as tmp:
+    mirror = Path(tmp) / "packages-meta-ext-v1.json.gz"
+    mirror.write_bytes(gzip.compress(dump))
+
+    # Keep the search index out of the user's cache
+    env = os.environ.copy()
+    env["XDG_CACHE_HOME"] = str(Path(tmp) / "cache")
+
+    result = test.run(["-Sa", "--aur-mirror", str(mirror), "--searchby", "provides,depends", "git"], env)
+
+    test.assert_returncode(result, 0)
+    test.assert_contains(result.stdout, "aur/git-git 2.45.0-1 [+20 ~1] (provides)\n")
+    test.assert_contains(result.stdout, "aur/paru 2.1.0-1 [+1068 ~22] (depends)\n")
+    test.assert_not_contains(result.stdout, "aur/yay")
+
+    # A single field is not annotated
+    result = test.run(["-Sa", "--aur-mirror", str(mirror), "--searchby", "provides", "git"], env)
+
+    test.assert_returncode(result, 0)
+    test.assert_contains(result.stdout, "aur/git-git 2.45.0-1 [+20 ~1]\n")
+    test.assert_not_contains(result.stdout, "aur/paru")
+
+    result = test.run(["-Sa", "--aur-mirror", str(mirror), "--searchby", "provides,bogus", "git"], env)
+
+    test.assert_returncode(result, 1)
+    test.assert_contains(result.stderr, "invalid field for --searchby: 'bogus'")
+
+test.exit_with_result()
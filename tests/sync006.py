@@ -0,0 +1,51 @@
+# SPDX-License-Identifier: MIT
+
+import gzip
+import os
+import pptest
+import sys
+import tempfile
+from pathlib import Path
+
+test = pptest.Test(sys.argv[1])
+
+dump = b"""[
+  {"ID":1,"Name":"paru","PackageBase":"paru","Version":"2.1.0-1",
+   "Description":"Feature packed AUR helper","NumVotes":1068,"Popularity":22,
+   "LastModified":300},
+  {"ID":2,"Name":"yay","PackageBase":"yay","Version":"12.5.0-1",
+   "Description":"Yet another AUR helper","NumVotes":2000,"Popularity":30,
+   "LastModified":100},
+  {"ID":3,"Name":"pikaur","PackageBase":"pikaur","Version":"1.29-1",
+   "Description":"AUR helper with minimal dependencies","NumVotes":300,
+   "Popularity":2.5,"LastModified":200}
+]"""
+
+with tempfile.TemporaryDirectory() as tmp:
+    mirror = Path(tmp) / "packages-meta-ext-v1.json.gz"
+    mirror.write_bytes(gzip.compress(dump))
+
+    # Keep the search index out of the user's cache
+    env = os.environ.copy()
+    env["XDG_CACHE_HOME"] = str(Path(tmp) / "cache")
+
+    search = ["-Sa", "--aur-mirror", str(mirror), "--searchby", "name-desc"]
+
+    result = test.run(search + ["--sortby", "votes", "helper"], env)
+
+    test.assert_returncode(result, 0)
+    names = [line.split()[0] for line in result.stdout.splitlines() if line.startswith("aur/")]
+    test.assert_equals(names, ["aur/yay", "aur/paru", "aur/pikaur"])
+
+    result = test.run(search + ["--sortby", "modified", "--limit", "2", "helper"], env)
+
+    test.assert_returncode(result, 0)
+    names = [line.split()[0] for line in result.stdout.splitlines() if line.startswith("aur/")]
+    test.assert_equals(names, ["aur/paru", "aur/pikaur"])
+
+    result = test.run(search + ["--limit", "ten", "helper"], env)
+
+    test.assert_returncode(result, 1)
+    test.assert_contains(result.stderr, "invalid number for --limit: 'ten'")
+
+test.exit_with_result()
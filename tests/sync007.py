@@ -0,0 +1,50 @@
+# SPDX-License-Identifier: MIT
+
+import gzip
+import json
+import os
+import pptest
+import sys
+import tempfile
+from pathlib import Path
+
+test = pptest.Test(sys.argv[1])
+
+dump = b"""[
+  {"ID":1,"Name":"paru","PackageBase":"paru","Version":"2.1.0-1",
+   "Description":"Feature packed AUR helper"}
+]"""
+
+with tempfile.TemporaryDirectory() as tmp:
+    mirror = Path(tmp) / "packages-meta-ext-v1.json.gz"
+    mirror.write_bytes(gzip.compress(dump))
+
+    # Keep the search index out of the user's cache
+    env = os.environ.copy()
+    env["XDG_CACHE_HOME"] = str(Path(tmp) / "cache")
+
+    search = ["-Sa", "--aur-mirror", str(mirror)]
+
+    # Searching the mirror makes no transfers, but the summary is still
+    # printed, after the results and on stderr
+    result = test.run(search + ["--stats=json", "paru"], env)
+
+    test.assert_returncode(result, 0)
+    test.assert_contains(result.stdout, "aur/paru")
+    stats = json.loads(result.stderr.strip().splitlines()[-1])
+    test.assert_equals(stats["count"], 0)
+    test.assert_equals(stats["transfers"], [])
+    test.assert_equals(sorted(stats["phases"]),
+                       ["connect", "name_lookup", "server", "tls", "total", "transfer"])
+
+    result = test.run(search + ["--stats", "paru"], env)
+
+    test.assert_returncode(result, 0)
+    test.assert_contains(result.stderr, "Transfers  : 0")
+
+    result = test.run(search + ["--stats=xml", "paru"], env)
+
+    test.assert_returncode(result, 1)
+    test.assert_contains(result.stderr, "invalid format for --stats: 'xml'")
+
+test.exit_with_result()
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: MIT
+
+#ifndef YARP_TESTS_TEMP_DIR_H_
+#define YARP_TESTS_TEMP_DIR_H_
+
+#include <stdlib.h>
+
+#include <cerrno>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+// A fresh directory under the system's temporary directory, removed with
+// everything in it when the TempDir goes out of scope. That includes a
+// failed REQUIRE unwinding the test.
+class TempDir {
+ public:
+  explicit TempDir(const std::string_view name) {
+    std::string pattern =
+        (std::filesystem::temp_directory_path() /
+         std::format("yarp-test-{}-XXXXXX", name))
+            .string();
+    if (mkdtemp(pattern.data()) == nullptr) {
+      throw std::filesystem::filesystem_error{
+          "Could not create a temporary directory", pattern,
+          std::error_code{errno, std::system_category()}};
+    }
+    path_ = std::move(pattern);
+  }
+
+  TempDir(const TempDir &) = delete;
+  TempDir &operator=(const TempDir &) = delete;
+
+  ~TempDir() {
+    std::error_code ec;
+    std::filesystem::remove_all(path_, ec);
+  }
+
+  const std::filesystem::path &path() const noexcept { return path_; }
+
+  std::filesystem::path operator/(const std::filesystem::path &name) const {
+    return path_ / name;
+  }
+
+ private:
+  std::filesystem::path path_;
+};
+
+#endif  // YARP_TESTS_TEMP_DIR_H_
@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: MIT
+
+#include <alpm.h>
+#include <alpm_list.h>
+#include <alpmpp/depend.h>
+#include <alpmpp/file.h>
+#include <alpmpp/list.h>
+
+#include <algorithm>
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <iterator>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static_assert(std::ranges::forward_range<alpmpp::AlpmListView<alpm_db_t *>>);
+static_assert(std::ranges::view<alpmpp::AlpmListView<alpm_db_t *>>);
+static_assert(std::ranges::random_access_range<alpmpp::AlpmFileListView>);
+static_assert(std::ranges::sized_range<alpmpp::AlpmFileListView>);
+
+SCENARIO("AlpmListView behavior", "[AlpmListView]") {
+  GIVEN("A list of strings") {
+    std::array<std::string, 3> strings{"base", "base-devel", "xorg"};
+    alpm_list_t *list = nullptr;
+    for (std::string &string : strings) {
+      list = alpm_list_add(list, string.data());
+    }
+    const alpmpp::AlpmListView<std::string_view, const char *> view{list};
+
+    THEN("It yields the elements in order") {
+      REQUIRE_FALSE(view.empty());
+      REQUIRE(std::ranges::equal(view, strings));
+      REQUIRE(std::ranges::distance(view) == 3);
+    }
+
+    THEN("It can be walked more than once") {
+      REQUIRE(std::ranges::find(view, "xorg") != view.end());
+      REQUIRE(std::ranges::find(view, "base") == view.begin());
+    }
+
+    THEN("It composes with other views") {
+      auto long_names = view | std::views::filter([](std::string_view name) {
+                          return name.size() > 4;
+                        });
+      REQUIRE(std::ranges::equal(long_names, std::array{"base-devel"}));
+    }
+
+    alpm_list_free(list);
+  }
+
+  GIVEN("A list of dependencies") {
+    std::string name{"pacman"};
+    alpm_depend_t depend{};
+    depend.name = name.data();
+    alpm_list_t *list = alpm_list_add(nullptr, &depend);
+    const alpmpp::AlpmListView<alpmpp::AlpmDepend, alpm_depend_t *> view{
+        list};
+
+    THEN("Each element is wrapped") {
+      REQUIRE(view.front().name() == "pacman");
+    }
+
+    alpm_list_free(list);
+  }
+
+  GIVEN("An empty list") {
+    const alpmpp::AlpmListView<std::string_view, const char *> view{nullptr};
+
+    THEN("It has no elements") {
+      REQUIRE(view.empty());
+      REQUIRE(view.begin() == view.end());
+    }
+  }
+}
+
+SCENARIO("AlpmFileListView behavior", "[AlpmFileListView]") {
+  GIVEN("A file list") {
+    std::array<std::string, 2> names{"usr/", "usr/bin/"};
+    std::array<alpm_file_t, 2> files{};
+    for (std::size_t i = 0; i < files.size(); ++i) {
+      files[i].name = names[i].data();
+    }
+    const alpm_filelist_t file_list{files.size(), files.data()};
+    const alpmpp::AlpmFileListView view = alpmpp::MakeFileListView(&file_list);
+
+    THEN("It yields the files in order") {
+      REQUIRE(view.size() == 2);
+      REQUIRE(view[1].name() == "usr/bin/");
+      REQUIRE(std::ranges::equal(
+          view | std::views::transform(&alpmpp::AlpmFile::name), names));
+    }
+  }
+
+  GIVEN("No file list") {
+    THEN("It is empty") { REQUIRE(alpmpp::MakeFileListView(nullptr).empty()); }
+  }
+}
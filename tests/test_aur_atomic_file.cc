@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: MIT
+
+#include <aurpp/atomic_file.h>
+#include <sys/stat.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "temp_dir.h"
+
+namespace {
+
+std::string ReadFile(const std::filesystem::path &path) {
+  std::ifstream file{path, std::ios::binary};
+  return {std::istreambuf_iterator<char>{file}, {}};
+}
+
+}  // namespace
+
+SCENARIO("WriteFileAtomically behavior", "[WriteFileAtomically]") {
+  const TempDir dir{"atomic-file"};
+  const std::filesystem::path path = dir / "file";
+
+  GIVEN("A file written atomically") {
+    REQUIRE(aurpp::WriteFileAtomically(path, "first").has_value());
+
+    THEN("It holds the bytes, and no temporary file is left") {
+      REQUIRE(ReadFile(path) == "first");
+      REQUIRE(std::distance(std::filesystem::directory_iterator{dir.path()},
+                            std::filesystem::directory_iterator{}) == 1);
+    }
+
+    WHEN("It is written again") {
+      REQUIRE(aurpp::WriteFileAtomically(path, "second").has_value());
+
+      THEN("It is replaced") { REQUIRE(ReadFile(path) == "second"); }
+    }
+  }
+
+  GIVEN("A file written with a private mode") {
+    REQUIRE(aurpp::WriteFileAtomically(path, "secret", 0600).has_value());
+
+    THEN("Only its owner can read it") {
+      struct stat st {};
+      REQUIRE(stat(path.c_str(), &st) == 0);
+      REQUIRE((st.st_mode & 0777) == 0600);
+    }
+  }
+
+  GIVEN("A directory that doesn't exist") {
+    THEN("Writing fails") {
+      REQUIRE_FALSE(
+          aurpp::WriteFileAtomically(dir / "nonexistent" / "file", "bytes")
+              .has_value());
+    }
+  }
+}
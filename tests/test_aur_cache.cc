@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: MIT
+
+#include <aurpp/cache.h>
+#include <aurpp/request.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include "temp_dir.h"
+
+SCENARIO("ResponseCache behavior", "[ResponseCache]") {
+  const TempDir temp{"cache"};
+  const std::filesystem::path dir = temp / "cache";
+  const aurpp::ResponseCache cache{dir};
+  const auto now = aurpp::ResponseCache::Clock::now();
+
+  GIVEN("An empty cache") {
+    THEN("The cache directory is created") {
+      REQUIRE(std::filesystem::is_directory(dir));
+    }
+
+    THEN("Lookups miss") { REQUIRE_FALSE(cache.Lookup("foo").has_value()); }
+  }
+
+  GIVEN("A stored entry") {
+    aurpp::ResponseCache::Entry entry;
+    entry.body = "{\"results\": []}\n";
+    entry.etag = "\"abc\"";
+    entry.last_modified = "Wed, 21 Oct 2015 07:28:00 GMT";
+    entry.expires_at = now + std::chrono::minutes{5};
+    REQUIRE(cache.Store("foo", entry));
+
+    THEN("The entry can be read back") {
+      const auto cached = cache.Lookup("foo");
+      REQUIRE(cached.has_value());
+      REQUIRE(cached->body == entry.body);
+      REQUIRE(cached->etag == entry.etag);
+      REQUIRE(cached->last_modified == entry.last_modified);
+      REQUIRE(cached->IsFresh(now));
+      REQUIRE(cached->CanRevalidate());
+    }
+
+    THEN("The entry is stale once it expires") {
+      const auto cached = cache.Lookup("foo");
+      REQUIRE(cached.has_value());
+      REQUIRE_FALSE(cached->IsFresh(now + std::chrono::minutes{10}));
+    }
+
+    THEN("Other keys still miss") {
+      REQUIRE_FALSE(cache.Lookup("bar").has_value());
+    }
+
+    THEN("A second cache on the same directory sees the entry") {
+      const aurpp::ResponseCache other{dir};
+      REQUIRE(other.Lookup("foo").has_value());
+    }
+
+    WHEN("The entry is overwritten") {
+      entry.body = "new";
+      REQUIRE(cache.Store("foo", entry));
+
+      THEN("The latest entry is returned") {
+        REQUIRE(cache.Lookup("foo")->body == "new");
+      }
+    }
+
+    WHEN("The entry file is truncated") {
+      for (const auto &file : std::filesystem::directory_iterator{dir}) {
+        std::filesystem::resize_file(file.path(), 20);
+      }
+
+      THEN("The lookup misses instead of returning a partial body") {
+        REQUIRE_FALSE(cache.Lookup("foo").has_value());
+      }
+    }
+  }
+
+  GIVEN("Two requests that only differ in their payload") {
+    aurpp::InfoRequest foo;
+    foo.AddArg("foo");
+    aurpp::InfoRequest bar;
+    bar.AddArg("bar");
+
+    THEN("Their keys differ") {
+      REQUIRE(aurpp::ResponseCache::Key(foo, "https://aur.archlinux.org") !=
+              aurpp::ResponseCache::Key(bar, "https://aur.archlinux.org"));
+    }
+  }
+
+  GIVEN("Per-endpoint TTLs") {
+    aurpp::ResponseCache ttl_cache{dir};
+    ttl_cache.set_ttl("/rpc/v5/search", std::chrono::seconds{60});
+    ttl_cache.set_ttl("/rpc/v5/search/paru", std::chrono::seconds{10});
+
+    THEN("The longest matching prefix wins") {
+      REQUIRE(ttl_cache.TtlFor("/rpc/v5/search/yay?by=name") ==
+              std::chrono::seconds{60});
+      REQUIRE(ttl_cache.TtlFor("/rpc/v5/search/paru?by=name") ==
+              std::chrono::seconds{10});
+    }
+
+    THEN("Unmatched endpoints use the default TTL") {
+      REQUIRE(ttl_cache.TtlFor("/rpc/v5/info") ==
+              aurpp::ResponseCache::kDefaultTtl);
+    }
+  }
+}
+
+SCENARIO("ResponseCache pruning", "[ResponseCache]") {
+  const TempDir temp{"cache-prune"};
+  const std::filesystem::path dir = temp / "cache";
+  const aurpp::ResponseCache cache{dir};
+  const auto now = aurpp::ResponseCache::Clock::now();
+
+  aurpp::ResponseCache::Entry entry;
+  entry.body = "{}";
+  entry.expires_at = now + std::chrono::minutes{5};
+  REQUIRE(cache.Store("fresh", entry));
+  entry.expires_at = now - std::chrono::minutes{5};
+  REQUIRE(cache.Store("expired", entry));
+  entry.etag = "\"abc\"";
+  REQUIRE(cache.Store("revalidatable", entry));
+  entry.expires_at = now - aurpp::ResponseCache::kStaleLifetime -
+                     std::chrono::minutes{5};
+  REQUIRE(cache.Store("revalidatable long ago", entry));
+
+  GIVEN("A directory with entries in every state") {
+    const std::filesystem::path temp_file = dir / "0123456789abcdef.1.2.tmp";
+    std::ofstream{temp_file} << "partial";
+    std::filesystem::last_write_time(
+        temp_file,
+        std::filesystem::file_time_type::clock::now() - std::chrono::hours{2});
+    std::ofstream{dir / "0123456789abcdef.3.4.tmp"} << "in progress";
+
+    WHEN("It is pruned") {
+      REQUIRE(cache.Prune(now) == 3);
+
+      THEN("Only what is still of use is left") {
+        REQUIRE(cache.Lookup("fresh").has_value());
+        REQUIRE(cache.Lookup("revalidatable").has_value());
+        REQUIRE_FALSE(cache.Lookup("expired").has_value());
+        REQUIRE_FALSE(cache.Lookup("revalidatable long ago").has_value());
+        REQUIRE_FALSE(std::filesystem::exists(temp_file));
+        REQUIRE(std::filesystem::exists(dir / "0123456789abcdef.3.4.tmp"));
+      }
+    }
+  }
+
+  GIVEN("A directory the first Store swept") {
+    entry.expires_at = now + std::chrono::minutes{5};
+
+    WHEN("More entries are stored within the interval") {
+      REQUIRE(cache.Store("another", entry));
+
+      THEN("Expired entries are left until the next sweep") {
+        REQUIRE(cache.Prune(now) == 2);
+      }
+    }
+
+    WHEN("An entry is stored once the interval has passed") {
+      std::filesystem::last_write_time(
+          dir / ".pruned", std::filesystem::file_time_type::clock::now() -
+                               aurpp::ResponseCache::kPruneInterval -
+                               std::chrono::minutes{5});
+      REQUIRE(cache.Store("another", entry));
+
+      THEN("Expired entries are swept") {
+        REQUIRE_FALSE(cache.Lookup("expired").has_value());
+        REQUIRE(cache.Lookup("another").has_value());
+        REQUIRE(cache.Prune(now) == 0);
+      }
+    }
+  }
+}
@@ -1,15 +1,27 @@
 // SPDX-License-Identifier: MIT
 
+#include <algorithm>
 #include <catch2/catch_test_macros.hpp>
+#include <chrono>
 #include <expected>
+#include <fstream>
+#include <ranges>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "aurpp/client.h"
 #include "aurpp/request.h"
 #include "aurpp/response.h"
+#include "loopback_server.h"
+#include "mock_aur_server.h"
+#include "temp_dir.h"
 
 SCENARIO("Client HTTP request functionality", "[Client]") {
-  GIVEN("A Client instance") {
-    aurpp::Client client;
+  GIVEN("A Client of a mock AUR") {
+    MockAurServer server;
+    aurpp::Client client{server.url()};
 
     WHEN("Making an InfoRequest for a known package") {
       aurpp::InfoRequest request;
@@ -58,6 +70,19 @@ SCENARIO("Client HTTP request functionality", "[Client]") {
         REQUIRE(url.find("PKGBUILD") != std::string::npos);
       }
     }
+
+    WHEN("Fetching a source file of a package") {
+      aurpp::AurPackage package;
+      package.set_package_base("paru");
+
+      auto result = client.Execute<aurpp::RawRequest, aurpp::RawResponse>(
+          aurpp::RawRequest::ForSourceFile(package, "PKGBUILD"));
+
+      THEN("The file is returned") {
+        REQUIRE(result.has_value());
+        REQUIRE(result.value().bytes.contains("pkgname=paru\n"));
+      }
+    }
   }
 
   GIVEN("A Client with custom base URL") {
@@ -74,7 +99,426 @@ SCENARIO("Client HTTP request functionality", "[Client]") {
   }
 }
 
+SCENARIO("Client connection strategy", "[Client]") {
+  GIVEN("The features curl was built with") {
+    THEN("The most capable HTTP version is preferred") {
+      REQUIRE(aurpp::detail::PreferredHttpVersion(CURL_VERSION_HTTP3 |
+                                                  CURL_VERSION_HTTP2) ==
+              CURL_HTTP_VERSION_3);
+      REQUIRE(aurpp::detail::PreferredHttpVersion(CURL_VERSION_HTTP2) ==
+              CURL_HTTP_VERSION_2TLS);
+      REQUIRE(aurpp::detail::PreferredHttpVersion(0) ==
+              CURL_HTTP_VERSION_1_1);
+    }
+
+    THEN("Negotiated versions are named") {
+      REQUIRE(aurpp::detail::HttpVersionName(CURL_HTTP_VERSION_1_1) ==
+              "HTTP/1.1");
+      REQUIRE(aurpp::detail::HttpVersionName(CURL_HTTP_VERSION_2_0) ==
+              "HTTP/2");
+      REQUIRE(aurpp::detail::HttpVersionName(CURL_HTTP_VERSION_3) ==
+              "HTTP/3");
+    }
+  }
+
+  GIVEN("A Client of a mock AUR with a transfer observer") {
+    MockAurServer server;
+    aurpp::Client client{server.url()};
+    std::vector<aurpp::TransferInfo> transfers;
+    client.set_transfer_observer(
+        [&transfers](const aurpp::TransferInfo &info) {
+          transfers.push_back(info);
+        });
+
+    WHEN("Making a request and then a batch of requests") {
+      aurpp::InfoRequest single;
+      single.AddArg("paru");
+      REQUIRE(client.Execute<aurpp::InfoRequest, aurpp::RpcResponse>(single)
+                  .has_value());
+
+      std::vector<aurpp::InfoRequest> batch(3);
+      batch[0].AddArg("yay");
+      batch[1].AddArg("pikaur");
+      batch[2].AddArg("aurutils");
+      client.ExecuteMany<aurpp::InfoRequest, aurpp::RpcResponse>(batch);
+
+      THEN("Every transfer is reported") {
+        REQUIRE(transfers.size() == 4);
+        REQUIRE(transfers[0].url.starts_with(server.url()));
+        REQUIRE(transfers[0].http_version != "unknown");
+        REQUIRE(transfers[0].total_time.count() > 0);
+      }
+
+      THEN("The batch reuses the connection of the first request") {
+        REQUIRE(std::ranges::any_of(
+            transfers | std::views::drop(1),
+            &aurpp::TransferInfo::reused_connection));
+      }
+    }
+  }
+}
+
+SCENARIO("Client chunked info lookups", "[Client]") {
+  GIVEN("A Client of a mock AUR with a small info chunk size") {
+    MockAurServer server;
+    aurpp::Client client{server.url()};
+    client.set_info_chunk_size(1);
+
+    WHEN("Looking up several packages") {
+      const std::vector<std::string> names{"yay", "paru", "pikaur"};
+
+      auto result = client.ExecuteInfo(names);
+
+      THEN("The chunks are merged in the order the names were given") {
+        REQUIRE(result.has_value());
+        const std::vector<aurpp::AurPackage> &packages =
+            result.value().packages;
+        REQUIRE(packages.size() == names.size());
+        REQUIRE(packages[0].name() == "yay");
+        REQUIRE(packages[1].name() == "paru");
+        REQUIRE(packages[2].name() == "pikaur");
+      }
+    }
+  }
+}
+
+SCENARIO("Client field search", "[Client]") {
+  using SearchBy = aurpp::SearchRequest::SearchBy;
+
+  GIVEN("Responses for two terms searched in two fields") {
+    const auto make_response = [](const std::vector<int> &ids) {
+      aurpp::RpcResponse response;
+      for (const int id : ids) {
+        aurpp::AurPackage &package = response.packages.emplace_back();
+        package.set_id(id);
+      }
+      return response;
+    };
+    const std::vector<SearchBy> fields{SearchBy::kProvides,
+                                       SearchBy::kDepends};
+    // Term by term, one response per field
+    const std::vector<aurpp::RpcResponse> responses{
+        make_response({1, 2}), make_response({2, 3, 4}),
+        make_response({4}), make_response({3, 1, 5})};
+
+    WHEN("They are merged") {
+      const std::vector<aurpp::FieldSearchMatch> matches =
+          aurpp::detail::MergeFieldSearches(fields, responses);
+
+      THEN("Packages matching every term in some field are kept") {
+        REQUIRE(matches.size() == 3);
+        REQUIRE(matches[0].package.id() == 1);
+        REQUIRE(matches[0].fields ==
+                std::vector<SearchBy>{SearchBy::kProvides,
+                                      SearchBy::kDepends});
+        REQUIRE(matches[1].package.id() == 3);
+        REQUIRE(matches[1].fields == std::vector<SearchBy>{SearchBy::kDepends});
+        REQUIRE(matches[2].package.id() == 4);
+        REQUIRE(matches[2].fields ==
+                std::vector<SearchBy>{SearchBy::kProvides,
+                                      SearchBy::kDepends});
+      }
+    }
+  }
+
+  GIVEN("Fields with duplicates") {
+    const std::vector<SearchBy> fields{SearchBy::kDepends, SearchBy::kName,
+                                       SearchBy::kDepends};
+
+    THEN("Only the first occurrence of each is kept") {
+      REQUIRE(aurpp::detail::UniqueFields(fields) ==
+              std::vector<SearchBy>{SearchBy::kDepends, SearchBy::kName});
+    }
+  }
+
+  GIVEN("A Client of a mock AUR") {
+    MockAurServer server;
+    aurpp::Client client{server.url()};
+
+    WHEN("Searching several fields for a term") {
+      const std::vector<SearchBy> fields{SearchBy::kName,
+                                         SearchBy::kProvides};
+      const std::vector<std::string> terms{"paru"};
+
+      auto result = client.ExecuteFieldSearch(fields, terms);
+
+      THEN("The fields each package matched are reported") {
+        REQUIRE(result.has_value());
+        REQUIRE(std::ranges::any_of(
+            result.value(), [](const aurpp::FieldSearchMatch &match) {
+              return match.package.name() == "paru-bin" &&
+                     match.fields == std::vector<SearchBy>{SearchBy::kName,
+                                                           SearchBy::kProvides};
+            }));
+      }
+    }
+
+    WHEN("Searching asynchronously") {
+      auto future = client.ExecuteFieldSearchAsync({SearchBy::kName}, {"paru"});
+      const auto result = future.get();
+
+      THEN("The future holds the same matches as a blocking search") {
+        const std::vector<SearchBy> fields{SearchBy::kName};
+        const std::vector<std::string> terms{"paru"};
+        const auto expected = client.ExecuteFieldSearch(fields, terms);
+        REQUIRE(result.has_value());
+        REQUIRE(expected.has_value());
+        REQUIRE(result->size() == expected->size());
+        REQUIRE(std::ranges::equal(
+            *result, *expected,
+            [](const aurpp::FieldSearchMatch &lhs,
+               const aurpp::FieldSearchMatch &rhs) {
+              return lhs.package.name() == rhs.package.name();
+            }));
+      }
+    }
+  }
+}
+
+SCENARIO("Client response caching", "[Client]") {
+  GIVEN("A Client with a cache and an unreachable server") {
+    const TempDir dir{"client"};
+
+    constexpr std::string_view kBaseUrl =
+        "https://invalid.server.that.does.not.exist";
+    aurpp::Client client{std::string{kBaseUrl}};
+    client.EnableCache(dir.path());
+
+    aurpp::InfoRequest request;
+    request.AddArg("paru");
+
+    WHEN("A fresh response for the request is cached") {
+      std::ifstream file{"paru.json"};
+      std::ostringstream ss;
+      ss << file.rdbuf();
+
+      aurpp::ResponseCache::Entry entry;
+      entry.body = ss.str();
+      entry.expires_at =
+          aurpp::ResponseCache::Clock::now() + std::chrono::minutes{5};
+      REQUIRE(client.cache()->Store(
+          aurpp::ResponseCache::Key(request, kBaseUrl), entry));
+
+      auto result =
+          client.Execute<aurpp::InfoRequest, aurpp::RpcResponse>(request);
+
+      THEN("The request is answered without contacting the server") {
+        REQUIRE(result.has_value());
+        REQUIRE(result.value().packages[0].name() == "paru");
+      }
+    }
+
+    WHEN("A cached response is streamed") {
+      std::ifstream file{"paru.json"};
+      std::ostringstream ss;
+      ss << file.rdbuf();
+
+      aurpp::ResponseCache::Entry entry;
+      entry.body = ss.str();
+      entry.expires_at =
+          aurpp::ResponseCache::Clock::now() + std::chrono::minutes{5};
+      REQUIRE(client.cache()->Store(
+          aurpp::ResponseCache::Key(request, kBaseUrl), entry));
+
+      std::vector<std::string> names;
+      auto count = client.ExecuteStreaming(
+          request, [&names](const aurpp::AurPackage &package) {
+            names.emplace_back(package.name());
+          });
+
+      THEN("The cached packages are passed to the callback") {
+        REQUIRE(count == 1);
+        REQUIRE(names == std::vector<std::string>{"paru"});
+      }
+    }
+
+    WHEN("The cached response has expired") {
+      aurpp::ResponseCache::Entry entry;
+      entry.body = "{}";
+      entry.expires_at =
+          aurpp::ResponseCache::Clock::now() - std::chrono::minutes{5};
+      REQUIRE(client.cache()->Store(
+          aurpp::ResponseCache::Key(request, kBaseUrl), entry));
+
+      auto result =
+          client.Execute<aurpp::InfoRequest, aurpp::RpcResponse>(request);
+
+      THEN("The server is contacted again") {
+        REQUIRE_FALSE(result.has_value());
+      }
+    }
+  }
+}
+
+SCENARIO("Client streaming with a cache", "[Client]") {
+  GIVEN("A cached Client of a server") {
+    const TempDir dir{"client-stream"};
+
+    std::ifstream file{"paru.json"};
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    const std::string body = ss.str();
+
+    LoopbackServer server{[&body](int, std::string_view) {
+      Reply reply = Success(body);
+      reply.headers = "ETag: \"paru\"\r\n";
+      return reply;
+    }};
+    aurpp::Client client{server.url()};
+    client.EnableCache(dir.path());
+
+    aurpp::InfoRequest request;
+    request.AddArg("paru");
+
+    WHEN("The same request is streamed twice") {
+      std::vector<std::string> names;
+      const auto on_package = [&names](const aurpp::AurPackage &package) {
+        names.emplace_back(package.name());
+      };
+      REQUIRE(client.ExecuteStreaming(request, on_package) == 1);
+      REQUIRE(client.ExecuteStreaming(request, on_package) == 1);
+
+      THEN("The streamed body isn't kept for the cache") {
+        REQUIRE(names == std::vector<std::string>{"paru", "paru"});
+        REQUIRE(server.requests() == 2);
+        REQUIRE_FALSE(client.cache()
+                          ->Lookup(aurpp::ResponseCache::Key(
+                              request, server.url()))
+                          .has_value());
+      }
+    }
+
+    WHEN("The request is executed and then streamed") {
+      REQUIRE(client.Execute<aurpp::InfoRequest, aurpp::RpcResponse>(request)
+                  .has_value());
+      std::size_t packages = 0;
+      const auto count = client.ExecuteStreaming(
+          request, [&packages](const aurpp::AurPackage &) { ++packages; });
+
+      THEN("The stream is answered from the cache") {
+        REQUIRE(count == 1);
+        REQUIRE(packages == 1);
+        REQUIRE(server.requests() == 1);
+      }
+    }
+  }
+}
+
+SCENARIO("Client compressed responses", "[Client]") {
+  GIVEN("A server that gzips responses for clients accepting it") {
+    std::ifstream file{"paru.json"};
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    const std::string body = ss.str();
+    const std::string gzipped = Gzip(body);
+
+    LoopbackServer server{[&](int, const std::string_view request) {
+      if (!request.contains("gzip")) {
+        return Success(body);
+      }
+      Reply reply = Success(gzipped);
+      reply.headers = "Content-Encoding: gzip\r\n";
+      return reply;
+    }};
+    aurpp::Client client{server.url()};
+    std::size_t downloaded_bytes = 0;
+    client.set_transfer_observer(
+        [&downloaded_bytes](const aurpp::TransferInfo &info) {
+          downloaded_bytes = info.downloaded_bytes;
+        });
+
+    aurpp::InfoRequest request;
+    request.AddArg("paru");
+
+    WHEN("A request is made") {
+      auto result =
+          client.Execute<aurpp::InfoRequest, aurpp::RpcResponse>(request);
+
+      THEN("The compressed response is received and decoded") {
+        REQUIRE(result.has_value());
+        REQUIRE(result.value().packages[0].name() == "paru");
+        REQUIRE(downloaded_bytes == gzipped.size());
+      }
+    }
+
+    WHEN("A response is streamed") {
+      std::vector<std::string> names;
+      auto count = client.ExecuteStreaming(
+          request, [&names](const aurpp::AurPackage &package) {
+            names.emplace_back(package.name());
+          });
+
+      THEN("The packages are decoded as they arrive") {
+        REQUIRE(count == 1);
+        REQUIRE(names == std::vector<std::string>{"paru"});
+      }
+    }
+  }
+}
+
 SCENARIO("Client error handling", "[Client]") {
+  GIVEN("A Client of a mock AUR failing every second request") {
+    MockAurOptions options;
+    options.fail_every = 2;
+    MockAurServer server{options};
+    aurpp::Client client{server.url()};
+
+    aurpp::InfoRequest request;
+    request.AddArg("paru");
+
+    WHEN("Making two requests") {
+      auto first =
+          client.Execute<aurpp::InfoRequest, aurpp::RpcResponse>(request);
+      auto second =
+          client.Execute<aurpp::InfoRequest, aurpp::RpcResponse>(request);
+
+      THEN("The injected failure is reported") {
+        REQUIRE(first.has_value());
+        REQUIRE_FALSE(second.has_value());
+        REQUIRE(second.error() == "HTTP error: 503");
+      }
+    }
+  }
+
+  GIVEN("A cached Client of a server replying with an RPC error") {
+    const TempDir dir{"client-error"};
+
+    LoopbackServer server{[](int, std::string_view) {
+      return Success(
+          R"({"error":"Too many package results.","resultcount":0,)"
+          R"("results":[],"type":"error","version":5})");
+    }};
+    aurpp::Client client{server.url()};
+    client.EnableCache(dir.path());
+
+    const aurpp::SearchRequest request{aurpp::SearchRequest::SearchBy::kName,
+                                       "a"};
+
+    WHEN("Making the same request twice") {
+      auto first =
+          client.Execute<aurpp::SearchRequest, aurpp::RpcResponse>(request);
+      auto second =
+          client.Execute<aurpp::SearchRequest, aurpp::RpcResponse>(request);
+
+      THEN("The error isn't answered from the cache") {
+        REQUIRE(first == std::unexpected{"Too many package results."});
+        REQUIRE(second == std::unexpected{"Too many package results."});
+        REQUIRE(server.requests() == 2);
+      }
+    }
+
+    WHEN("Streaming the request") {
+      std::size_t packages = 0;
+      const auto result = client.ExecuteStreaming(
+          request, [&packages](const aurpp::AurPackage &) { ++packages; });
+
+      THEN("The error is reported instead of an empty result") {
+        REQUIRE(result == std::unexpected{"Too many package results."});
+        REQUIRE(packages == 0);
+      }
+    }
+  }
+
   GIVEN("A Client with invalid server") {
     aurpp::Client client("https://invalid.server.that.does.not.exist");
 
@@ -93,4 +537,78 @@ SCENARIO("Client error handling", "[Client]") {
       }
     }
   }
-}
\ No newline at end of file
+}
+
+SCENARIO("Client batch request functionality", "[Client]") {
+  GIVEN("A Client of a mock AUR") {
+    MockAurServer server;
+    aurpp::Client client{server.url()};
+
+    WHEN("Executing several SearchRequests at once") {
+      std::vector<aurpp::SearchRequest> requests;
+      requests.emplace_back(aurpp::SearchRequest::SearchBy::kName, "paru");
+      requests.emplace_back(aurpp::SearchRequest::SearchBy::kName, "yay");
+
+      auto results =
+          client.ExecuteMany<aurpp::SearchRequest, aurpp::RpcResponse>(
+              requests);
+
+      THEN("There is one result per request, in request order") {
+        REQUIRE(results.size() == requests.size());
+        REQUIRE(results[0].has_value());
+        REQUIRE(results[1].has_value());
+        REQUIRE(std::ranges::any_of(
+            results[0].value().packages,
+            [](const aurpp::AurPackage &pkg) { return pkg.name() == "paru"; }));
+        REQUIRE(std::ranges::any_of(
+            results[1].value().packages,
+            [](const aurpp::AurPackage &pkg) { return pkg.name() == "yay"; }));
+      }
+    }
+
+    WHEN("There are more requests than the concurrency limit") {
+      client.set_max_concurrent_requests(1);
+
+      std::vector<aurpp::InfoRequest> requests(3);
+      requests[0].AddArg("paru");
+      requests[1].AddArg("yay");
+      requests[2].AddArg("pikaur");
+
+      auto results =
+          client.ExecuteMany<aurpp::InfoRequest, aurpp::RpcResponse>(requests);
+
+      THEN("Every request is still executed") {
+        REQUIRE(results.size() == requests.size());
+        REQUIRE(std::ranges::all_of(
+            results, [](const auto &result) { return result.has_value(); }));
+        REQUIRE(results[2].value().packages[0].name() == "pikaur");
+      }
+    }
+
+    WHEN("Executing an empty batch") {
+      auto results =
+          client.ExecuteMany<aurpp::InfoRequest, aurpp::RpcResponse>({});
+
+      THEN("No results are returned") { REQUIRE(results.empty()); }
+    }
+  }
+
+  GIVEN("A Client with invalid server") {
+    aurpp::Client client("https://invalid.server.that.does.not.exist");
+
+    WHEN("Executing a batch of requests") {
+      std::vector<aurpp::InfoRequest> requests(2);
+      requests[0].AddArg("foo");
+      requests[1].AddArg("bar");
+
+      auto results =
+          client.ExecuteMany<aurpp::InfoRequest, aurpp::RpcResponse>(requests);
+
+      THEN("Every request fails with an error") {
+        REQUIRE(results.size() == requests.size());
+        REQUIRE(std::ranges::none_of(
+            results, [](const auto &result) { return result.has_value(); }));
+      }
+    }
+  }
+}
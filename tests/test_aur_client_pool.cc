@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "aurpp/client.h"
+#include "aurpp/client_pool.h"
+#include "aurpp/request.h"
+#include "aurpp/response.h"
+#include "mock_aur_server.h"
+
+SCENARIO("ClientPool leases", "[ClientPool]") {
+  GIVEN("A ClientPool") {
+    aurpp::ClientPool pool;
+
+    WHEN("Two clients are acquired at once") {
+      aurpp::ClientPool::Lease first = pool.Acquire();
+      aurpp::ClientPool::Lease second = pool.Acquire();
+
+      THEN("They are different clients") {
+        REQUIRE(&*first != &*second);
+        REQUIRE(pool.size() == 2);
+      }
+    }
+
+    WHEN("A client is acquired after another was returned") {
+      const aurpp::Client *returned = nullptr;
+      {
+        aurpp::ClientPool::Lease lease = pool.Acquire();
+        returned = &*lease;
+      }
+      aurpp::ClientPool::Lease lease = pool.Acquire();
+
+      THEN("The returned client is reused with its connections") {
+        REQUIRE(&*lease == returned);
+        REQUIRE(pool.size() == 1);
+      }
+    }
+
+    WHEN("A lease is moved") {
+      aurpp::ClientPool::Lease lease = pool.Acquire();
+      const aurpp::Client *client = &*lease;
+      aurpp::ClientPool::Lease moved = std::move(lease);
+
+      THEN("The client moves with it") { REQUIRE(&*moved == client); }
+    }
+  }
+}
+
+SCENARIO("ClientPool requests from several threads", "[ClientPool]") {
+  GIVEN("A ClientPool of a mock AUR") {
+    // Slow enough that the transfers of the threads overlap
+    MockAurOptions options;
+    options.latency = std::chrono::milliseconds{5};
+    MockAurServer server{options};
+    aurpp::ClientPool pool{server.url()};
+
+    WHEN("Every thread executes requests with its own lease") {
+      constexpr std::size_t kThreads = 8;
+      constexpr std::size_t kRounds = 10;
+      std::vector<std::vector<std::string>> names(kThreads);
+      {
+        std::vector<std::jthread> threads;
+        for (std::size_t i = 0; i < kThreads; ++i) {
+          threads.emplace_back([&pool, &names, i] {
+            for (std::size_t round = 0; round < kRounds; ++round) {
+              // Each transfer looks up the shared DNS cache and connects
+              // or reuses a connection while the other threads do the same
+              aurpp::ClientPool::Lease client = pool.Acquire();
+              aurpp::InfoRequest request;
+              request.AddArg(round % 2 == 0 ? "paru" : "yay");
+              const auto result =
+                  client->Execute<aurpp::InfoRequest, aurpp::RpcResponse>(
+                      request);
+              names[i].emplace_back(
+                  result.has_value() && result->packages.size() == 1
+                      ? result->packages[0].name()
+                      : "failed");
+            }
+          });
+        }
+      }
+
+      THEN("Every request is a transfer, and answered") {
+        REQUIRE(server.requests() == static_cast<int>(kThreads * kRounds));
+        for (const std::vector<std::string> &thread_names : names) {
+          REQUIRE(thread_names.size() == kRounds);
+          for (std::size_t round = 0; round < kRounds; ++round) {
+            REQUIRE(thread_names[round] == (round % 2 == 0 ? "paru" : "yay"));
+          }
+        }
+        REQUIRE(pool.size() <= kThreads);
+      }
+    }
+  }
+}
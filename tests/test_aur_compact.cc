@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <expected>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "aurpp/compact.h"
+#include "aurpp/response.h"
+
+SCENARIO("CompactRpcResponse parsing behavior", "[CompactRpcResponse]") {
+  GIVEN("The paru.json response") {
+    std::ifstream file{"paru.json"};
+    std::ostringstream ss;
+    ss << file.rdbuf();
+
+    std::expected<aurpp::CompactRpcResponse, std::string> maybe_compact =
+        aurpp::CompactRpcResponse::Parse(ss.str());
+    std::expected<aurpp::RpcResponse, std::string> maybe_response =
+        aurpp::RpcResponse::Parse(ss.str());
+
+    THEN("The packages match the regular layout") {
+      REQUIRE(maybe_compact.has_value());
+      REQUIRE(maybe_response.has_value());
+      REQUIRE(maybe_compact->size() == 1);
+
+      const aurpp::CompactPackage pkg = (*maybe_compact)[0];
+      const aurpp::AurPackage &expected = maybe_response->packages[0];
+      REQUIRE(pkg.name() == expected.name());
+      REQUIRE(pkg.version() == expected.version());
+      REQUIRE(pkg.description() == expected.description());
+      REQUIRE(pkg.maintainer() == expected.maintainer());
+      REQUIRE(pkg.url() == expected.url());
+      REQUIRE(pkg.num_votes() == expected.num_votes());
+      REQUIRE(pkg.popularity() == expected.popularity());
+      REQUIRE(pkg.out_of_date() == expected.out_of_date());
+      REQUIRE(pkg.package_base() == expected.package_base());
+      REQUIRE(pkg.url_path() == expected.url_path());
+      REQUIRE(pkg.id() == expected.id());
+      REQUIRE(std::ranges::equal(pkg.depends().value(),
+                                 expected.depends().value()));
+      REQUIRE(std::ranges::equal(pkg.keywords().value(),
+                                 expected.keywords().value()));
+      REQUIRE(pkg.check_depends().has_value() == false);
+      REQUIRE(pkg.conflicts().has_value() == false);
+
+      AND_THEN("It converts back to an AurPackage") {
+        const aurpp::AurPackage copy = pkg.ToAurPackage();
+        REQUIRE(copy.name() == expected.name());
+        REQUIRE(std::ranges::equal(copy.opt_depends().value(),
+                                   expected.opt_depends().value()));
+        REQUIRE(copy.conflicts().has_value() == false);
+      }
+    }
+
+    THEN("Package views stay valid when the response is moved") {
+      REQUIRE(maybe_compact.has_value());
+      const aurpp::CompactPackage pkg = (*maybe_compact)[0];
+      const aurpp::CompactRpcResponse moved = std::move(maybe_compact.value());
+      REQUIRE(pkg.name() == "paru");
+      REQUIRE(moved[0].name() == "paru");
+    }
+  }
+
+  GIVEN("Packages that share strings") {
+    const std::string response = R"({"results":[
+      {"Name":"foo","Version":"1","License":["MIT"],"Depends":["glibc"]},
+      {"Name":"bar","Version":"1","License":["MIT"],"Depends":["glibc"]},
+      {"Name":"baz","Maintainer":null,"OutOfDate":null}
+    ]})";
+    const auto compact = aurpp::CompactRpcResponse::Parse(response);
+
+    THEN("Every package is decoded") {
+      REQUIRE(compact.has_value());
+      std::vector<std::string_view> names;
+      for (const aurpp::CompactPackage pkg : compact->packages()) {
+        names.push_back(pkg.name());
+      }
+      REQUIRE(names == std::vector<std::string_view>{"foo", "bar", "baz"});
+
+      const aurpp::CompactPackage baz = (*compact)[2];
+      REQUIRE(baz.version().empty());
+      REQUIRE(baz.maintainer() == std::nullopt);
+      REQUIRE(baz.out_of_date() == std::nullopt);
+      REQUIRE(baz.license().has_value() == false);
+    }
+
+    THEN("Identical strings are stored once") {
+      REQUIRE(compact.has_value());
+      REQUIRE((*compact)[0].version().data() ==
+              (*compact)[1].version().data());
+      REQUIRE((*compact)[0].depends().value()[0].data() ==
+              (*compact)[1].depends().value()[0].data());
+    }
+  }
+
+  GIVEN("A malformed response") {
+    THEN("The error is reported") {
+      REQUIRE(aurpp::CompactRpcResponse::Parse(R"({"results":[{"ID":"x"}]})")
+                  .has_value() == false);
+    }
+  }
+}
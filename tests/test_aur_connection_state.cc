@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "aurpp/client.h"
+#include "aurpp/connection_state.h"
+#include "temp_dir.h"
+
+namespace {
+
+using Clock = aurpp::ConnectionState::Clock;
+
+const Clock::time_point kNow =
+    Clock::time_point{std::chrono::seconds{1'700'000'000}};
+
+}  // namespace
+
+SCENARIO("ConnectionState behavior", "[ConnectionState]") {
+  const TempDir dir{"connection-state"};
+  const std::filesystem::path path = dir / "connections";
+
+  GIVEN("A state with addresses and TLS sessions") {
+    aurpp::ConnectionState state;
+    state.RecordAddress("aur.archlinux.org", 443, "95.216.144.15", kNow);
+    state.RecordAddress("example.org", 443, "2001:db8::1", kNow);
+    state.RecordTlsSession({"aur.archlinux.org:443", "mac",
+                            std::string{"ti\0cket", 7},
+                            kNow + std::chrono::hours{1}});
+    state.RecordTlsSession(
+        {"old.example.org:443", "mac", "ticket", kNow - std::chrono::hours{1}});
+
+    THEN("Fresh addresses become resolve entries") {
+      REQUIRE(state.ResolveEntries(kNow) ==
+              std::vector<std::string>{"+aur.archlinux.org:443:95.216.144.15",
+                                       "+example.org:443:[2001:db8::1]"});
+      REQUIRE(state.ResolveEntries(kNow + aurpp::ConnectionState::kAddressTtl)
+                  .empty());
+    }
+
+    THEN("Reaching a known address again does not refresh it") {
+      state.RecordAddress("aur.archlinux.org", 443, "95.216.144.15",
+                          kNow + std::chrono::minutes{5});
+      REQUIRE(state.addresses()[0].resolved_at == kNow);
+
+      state.RecordAddress("aur.archlinux.org", 443, "95.216.144.16",
+                          kNow + std::chrono::minutes{5});
+      REQUIRE(state.addresses()[0].ip == "95.216.144.16");
+      REQUIRE(state.addresses()[0].resolved_at ==
+              kNow + std::chrono::minutes{5});
+    }
+
+    THEN("A session replaces the one with the same key") {
+      state.RecordTlsSession({"aur.archlinux.org:443", "mac2", "ticket2",
+                              kNow + std::chrono::hours{2}});
+      REQUIRE(state.tls_sessions().size() == 2);
+      REQUIRE(state.tls_sessions()[0].data == "ticket2");
+    }
+
+    WHEN("It is saved and loaded") {
+      REQUIRE(state.Save(path));
+      const aurpp::ConnectionState loaded =
+          aurpp::ConnectionState::Load(path, kNow);
+
+      THEN("Addresses and unexpired sessions are restored") {
+        REQUIRE(loaded.addresses().size() == 2);
+        REQUIRE(loaded.addresses()[1].host == "example.org");
+        REQUIRE(loaded.addresses()[1].ip == "2001:db8::1");
+        REQUIRE(loaded.addresses()[1].resolved_at == kNow);
+        REQUIRE(loaded.tls_sessions().size() == 1);
+        REQUIRE(loaded.tls_sessions()[0].key == "aur.archlinux.org:443");
+        REQUIRE(loaded.tls_sessions()[0].data == std::string{"ti\0cket", 7});
+      }
+
+      THEN("Only its owner can read the file") {
+        REQUIRE(std::filesystem::status(path).permissions() ==
+                (std::filesystem::perms::owner_read |
+                 std::filesystem::perms::owner_write));
+      }
+    }
+  }
+
+  GIVEN("A damaged state file") {
+    std::ofstream{path} << "yarp-connections-v1\n1 0\naur.archlinux.org";
+
+    THEN("It loads as an empty state") {
+      const aurpp::ConnectionState loaded =
+          aurpp::ConnectionState::Load(path, kNow);
+      REQUIRE(loaded.addresses().empty());
+      REQUIRE(loaded.tls_sessions().empty());
+    }
+  }
+
+  GIVEN("A client keeping its connection state") {
+    {
+      aurpp::Client client;
+      client.EnableConnectionState(dir / "client");
+    }
+
+    THEN("The state is saved when the client is destroyed") {
+      REQUIRE(std::filesystem::exists(dir / "client" / "connections"));
+    }
+
+    THEN("Only its owner can enter the state directory") {
+      REQUIRE(std::filesystem::status(dir / "client").permissions() ==
+              std::filesystem::perms::owner_all);
+    }
+  }
+
+  GIVEN("URLs") {
+    THEN("Their host is extracted") {
+      REQUIRE(aurpp::detail::UrlHost("https://aur.archlinux.org/rpc/v5") ==
+              "aur.archlinux.org");
+      REQUIRE(aurpp::detail::UrlHost("http://localhost:8080") == "localhost");
+      REQUIRE(aurpp::detail::UrlHost("http://[::1]:8080/").empty());
+      REQUIRE(aurpp::detail::UrlHost("aur.archlinux.org").empty());
+    }
+  }
+}
@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <expected>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "aurpp/decoder.h"
+#include "list_equals.h"
+
+SCENARIO("RpcDecoder decoding behavior", "[RpcDecoder]") {
+  GIVEN("The paru.json response") {
+    std::ifstream file{"paru.json"};
+    std::ostringstream ss;
+    ss << file.rdbuf();
+
+    Json::CharReaderBuilder reader_builder;
+    Json::Value json;
+    std::string errors;
+    std::istringstream json_stream{ss.str()};
+    REQUIRE(Json::parseFromStream(reader_builder, json_stream, &json, &errors));
+    const aurpp::AurPackage expected =
+        aurpp::AurPackage::FromJson(json["results"][0]);
+
+    std::vector<aurpp::AurPackage> packages;
+    const auto count = aurpp::RpcDecoder::Decode(
+        ss.str(), [&packages](aurpp::AurPackage package) {
+          packages.push_back(std::move(package));
+        });
+
+    THEN("Every field matches the jsoncpp based decoding") {
+      REQUIRE(count == 1);
+      const aurpp::AurPackage &pkg = packages[0];
+      REQUIRE(pkg.name() == expected.name());
+      REQUIRE(pkg.version() == expected.version());
+      REQUIRE(pkg.description() == expected.description());
+      REQUIRE(pkg.maintainer() == expected.maintainer());
+      REQUIRE(pkg.url() == expected.url());
+      REQUIRE(pkg.num_votes() == expected.num_votes());
+      REQUIRE(pkg.popularity() == expected.popularity());
+      REQUIRE(pkg.out_of_date() == expected.out_of_date());
+      REQUIRE(pkg.package_base() == expected.package_base());
+      REQUIRE(pkg.package_base_id() == expected.package_base_id());
+      REQUIRE(pkg.first_submitted() == expected.first_submitted());
+      REQUIRE(pkg.last_modified() == expected.last_modified());
+      REQUIRE(pkg.url_path() == expected.url_path());
+      REQUIRE(pkg.id() == expected.id());
+      REQUIRE(ListEquals(pkg.depends(), expected.depends()));
+      REQUIRE(ListEquals(pkg.make_depends(), expected.make_depends()));
+      REQUIRE(ListEquals(pkg.opt_depends(), expected.opt_depends()));
+      REQUIRE(ListEquals(pkg.check_depends(), expected.check_depends()));
+      REQUIRE(ListEquals(pkg.conflicts(), expected.conflicts()));
+      REQUIRE(ListEquals(pkg.provides(), expected.provides()));
+      REQUIRE(ListEquals(pkg.replaces(), expected.replaces()));
+      REQUIRE(ListEquals(pkg.groups(), expected.groups()));
+      REQUIRE(ListEquals(pkg.license(), expected.license()));
+      REQUIRE(ListEquals(pkg.keywords(), expected.keywords()));
+    }
+  }
+
+  GIVEN("A package with escapes, nulls and unknown fields") {
+    const auto pkg = aurpp::RpcDecoder::DecodePackage(R"({
+      "Name": "foo-bar",
+      "Description": "tab\there \"quoted\" 😀",
+      "Maintainer": null,
+      "Submitter": "someone",
+      "CoMaintainers": ["a", {"nested": [1, 2.5e3, true]}],
+      "OutOfDate": 1700000000,
+      "Popularity": 1.5e-05,
+      "Depends": ["libalpm.so>=14"],
+      "CheckDepends": null
+    })");
+
+    THEN("The known fields are decoded") {
+      REQUIRE(pkg.has_value());
+      REQUIRE(pkg->name() == "foo-bar");
+      REQUIRE(pkg->description() == "tab\there \"quoted\" \xF0\x9F\x98\x80");
+      REQUIRE(pkg->maintainer() == std::nullopt);
+      REQUIRE(pkg->out_of_date() == 1700000000);
+      REQUIRE(pkg->popularity() == 1.5e-05);
+      REQUIRE(std::ranges::equal(pkg->depends().value(),
+                                 std::vector<std::string>{"libalpm.so>=14"}));
+      REQUIRE(pkg->check_depends() == std::nullopt);
+    }
+  }
+
+  GIVEN("Malformed input") {
+    THEN("A field with the wrong type is reported") {
+      const auto pkg = aurpp::RpcDecoder::DecodePackage(R"({"NumVotes":"1"})");
+      REQUIRE(pkg.has_value() == false);
+      REQUIRE(pkg.error().starts_with("Invalid value for NumVotes"));
+    }
+
+    THEN("A truncated response is reported") {
+      const auto count = aurpp::RpcDecoder::Decode(
+          R"({"results":[{"Name":"foo"})", [](aurpp::AurPackage) {});
+      REQUIRE(count.has_value() == false);
+    }
+  }
+
+  GIVEN("An error response from the RPC interface") {
+    const auto count = aurpp::RpcDecoder::Decode(
+        R"({"error":"Too many package results.","resultcount":0,)"
+        R"("results":[],"type":"error","version":5})",
+        [](aurpp::AurPackage) {});
+
+    THEN("The error message is returned") {
+      REQUIRE(count == std::unexpected{"Too many package results."});
+    }
+
+    THEN("It is recognized as an error response") {
+      REQUIRE(aurpp::detail::IsErrorResponse(
+          R"({"error":"Too many package results.","resultcount":0,)"
+          R"("results":[],"type":"error","version":5})"));
+    }
+  }
+
+  GIVEN("Responses that aren't errors") {
+    THEN("They aren't recognized as error responses") {
+      REQUIRE_FALSE(aurpp::detail::IsErrorResponse(
+          R"({"resultcount":0,"results":[],"type":"search","version":5})"));
+      REQUIRE_FALSE(aurpp::detail::IsErrorResponse(R"({"results":[]})"));
+      REQUIRE_FALSE(aurpp::detail::IsErrorResponse("pkgname=paru\n"));
+    }
+  }
+}
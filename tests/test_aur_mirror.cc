@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: MIT
+
+#include <zlib.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <expected>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "aurpp/mirror.h"
+#include "aurpp/request.h"
+
+namespace {
+
+using SearchBy = aurpp::SearchRequest::SearchBy;
+
+constexpr std::string_view kDump = R"([
+  {"ID":1,"Name":"paru","PackageBase":"paru","Version":"2.1.0-1",
+   "Description":"Feature packed AUR helper","Maintainer":"Morganamilo",
+   "Depends":["git","pacman>6.1"],"MakeDepends":["cargo"],
+   "OptDepends":["bat: colored pkgbuild printing"],
+   "Keywords":["AUR","helper"],"Submitter":"Morganamilo"},
+  {"ID":2,"Name":"yay","PackageBase":"yay","Version":"12.5.0-1",
+   "Description":"Yet another yogurt","Maintainer":"jguer",
+   "Depends":["pacman>6.1","pacman<7","git"],"Keywords":["aur"]},
+  {"ID":3,"Name":"orphaned-PARU-fork","PackageBase":"orphaned","Version":"1",
+   "Description":null,"Maintainer":null,"Provides":["paru=2.0"]}
+])";
+
+std::string Gzip(const std::string_view data) {
+  z_stream stream{};
+  deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8,
+               Z_DEFAULT_STRATEGY);
+  std::string output(deflateBound(&stream, data.size()), '\0');
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  stream.next_out = reinterpret_cast<Bytef *>(output.data());
+  stream.avail_out = static_cast<uInt>(output.size());
+  deflate(&stream, Z_FINISH);
+  output.resize(stream.total_out);
+  deflateEnd(&stream);
+  return output;
+}
+
+std::vector<std::string_view> Names(
+    const std::expected<aurpp::RpcResponse, std::string> &response) {
+  std::vector<std::string_view> names;
+  for (const aurpp::AurPackage &package : response->packages) {
+    names.push_back(package.name());
+  }
+  return names;
+}
+
+}  // namespace
+
+SCENARIO("LocalMirror lookups", "[LocalMirror]") {
+  GIVEN("A mirror built from a metadata dump") {
+    std::expected<aurpp::LocalMirror, std::string> mirror =
+        aurpp::LocalMirror::Parse(kDump);
+    REQUIRE(mirror.has_value());
+    REQUIRE(mirror->size() == 3);
+
+    THEN("Info requests return the named packages in order") {
+      const std::vector<std::string> names{"yay", "missing", "paru"};
+      const auto response = mirror->Execute(aurpp::InfoRequest{names});
+
+      REQUIRE(response.has_value());
+      REQUIRE(Names(response) == std::vector<std::string_view>{"yay", "paru"});
+      REQUIRE(response->packages[1].version() == "2.1.0-1");
+    }
+
+    THEN("Name searches match substrings regardless of case") {
+      const auto response =
+          mirror->Execute(aurpp::SearchRequest{SearchBy::kName, "paru"});
+
+      REQUIRE(response.has_value());
+      REQUIRE(Names(response) ==
+              std::vector<std::string_view>{"paru", "orphaned-PARU-fork"});
+    }
+
+    THEN("Name and description searches also match descriptions") {
+      const auto response = mirror->Search(SearchBy::kNameDesc, "yogurt");
+
+      REQUIRE(response.has_value());
+      REQUIRE(Names(response) == std::vector<std::string_view>{"yay"});
+    }
+
+    THEN("Relation searches ignore version constraints") {
+      const auto depends = mirror->Search(SearchBy::kDepends, "pacman");
+      REQUIRE(depends.has_value());
+      REQUIRE(Names(depends) == std::vector<std::string_view>{"paru", "yay"});
+
+      const auto provides = mirror->Search(SearchBy::kProvides, "paru");
+      REQUIRE(provides.has_value());
+      REQUIRE(Names(provides) ==
+              std::vector<std::string_view>{"orphaned-PARU-fork"});
+
+      REQUIRE(mirror->Search(SearchBy::kDepends, "pacman>6.1")
+                  ->packages.empty());
+    }
+
+    THEN("Exact fields only match whole values") {
+      const auto keywords = mirror->Search(SearchBy::kKeywords, "aur");
+      REQUIRE(keywords.has_value());
+      REQUIRE(Names(keywords) == std::vector<std::string_view>{"yay"});
+
+      const auto maintainer = mirror->Search(SearchBy::kMaintainer, "jguer");
+      REQUIRE(maintainer.has_value());
+      REQUIRE(Names(maintainer) == std::vector<std::string_view>{"yay"});
+    }
+
+    THEN("An empty maintainer finds orphans") {
+      const auto response = mirror->Search(SearchBy::kMaintainer, "");
+
+      REQUIRE(response.has_value());
+      REQUIRE(Names(response) ==
+              std::vector<std::string_view>{"orphaned-PARU-fork"});
+    }
+
+    THEN("Unsupported searches are reported") {
+      REQUIRE(mirror->Search(SearchBy::kName, "p").error() ==
+              "Query arg too small.");
+      REQUIRE(mirror->Search(SearchBy::kSubmitter, "Morganamilo")
+                  .has_value() == false);
+    }
+  }
+
+  GIVEN("A gzip compressed metadata dump") {
+    const std::string compressed = Gzip(kDump);
+
+    THEN("It is decompressed before parsing") {
+      const auto mirror = aurpp::LocalMirror::Parse(compressed);
+
+      REQUIRE(mirror.has_value());
+      REQUIRE(mirror->size() == 3);
+    }
+
+    THEN("A truncated dump is an error") {
+      const auto mirror = aurpp::LocalMirror::Parse(
+          std::string_view{compressed}.substr(0, compressed.size() / 2));
+
+      REQUIRE(mirror.has_value() == false);
+    }
+  }
+
+  GIVEN("A malformed metadata dump") {
+    THEN("The error is reported") {
+      REQUIRE(aurpp::LocalMirror::Parse(R"({"results":[]})").has_value() ==
+              false);
+      REQUIRE(aurpp::LocalMirror::Parse(R"([{"Name":"foo"}] [])").has_value() ==
+              false);
+      REQUIRE(aurpp::LocalMirror::Load("does-not-exist.json").has_value() ==
+              false);
+    }
+  }
+}
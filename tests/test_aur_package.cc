@@ -1,11 +1,15 @@
 // SPDX-License-Identifier: MIT
 
+#include <algorithm>
 #include <catch2/catch_test_macros.hpp>
 #include <expected>
 #include <fstream>
 #include <optional>
+#include <span>
+#include <vector>
 
 #include "aurpp/package.h"
+#include "list_equals.h"
 
 std::expected<Json::Value, std::string> ReadFromFile(const std::string &path) {
   std::ifstream json_file(path);
@@ -79,17 +83,17 @@ SCENARIO("AurPackage behavior", "[AurPackage]") {
       REQUIRE(pkg.last_modified() == 1751964728);
       REQUIRE(pkg.url_path() == "/cgit/aur.git/snapshot/paru.tar.gz");
       REQUIRE(pkg.id() == 1772991);
-      REQUIRE(pkg.depends() == std::vector<std::string>{"git", "pacman", "libalpm.so>=14"});
-      REQUIRE(pkg.make_depends() == std::vector<std::string>{"cargo"});
-      REQUIRE(pkg.opt_depends() == std::vector<std::string>{"bat", "devtools"});
+      REQUIRE(ListEquals(pkg.depends(), {"git", "pacman", "libalpm.so>=14"}));
+      REQUIRE(ListEquals(pkg.make_depends(), {"cargo"}));
+      REQUIRE(ListEquals(pkg.opt_depends(), {"bat", "devtools"}));
       // TODO: check_depends is made into a vector when parsing a null value instead of remaining a std::nullopt
       REQUIRE(pkg.check_depends() == std::nullopt);
       REQUIRE(pkg.conflicts() == std::nullopt);
       REQUIRE(pkg.provides() == std::nullopt);
       REQUIRE(pkg.replaces() == std::nullopt);
       REQUIRE(pkg.groups() == std::nullopt);
-      REQUIRE(pkg.license() == std::vector<std::string>{"GPL-3.0-or-later"});
-      REQUIRE(pkg.keywords() == std::vector<std::string>{"AUR", "helper", "pacman", "rust", "wrapper", "yay"});
+      REQUIRE(ListEquals(pkg.license(), {"GPL-3.0-or-later"}));
+      REQUIRE(ListEquals(pkg.keywords(), {"AUR", "helper", "pacman", "rust", "wrapper", "yay"}));
     }
   }
 }
\ No newline at end of file
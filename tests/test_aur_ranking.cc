@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "aurpp/client.h"
+#include "aurpp/ranking.h"
+
+namespace {
+
+using Positions = std::vector<std::uint32_t>;
+
+aurpp::AurPackage MakePackage(const std::string &name, const int votes,
+                              const double popularity,
+                              const int last_modified) {
+  aurpp::AurPackage package{};
+  package.set_name(name);
+  package.set_num_votes(votes);
+  package.set_popularity(popularity);
+  package.set_last_modified(last_modified);
+  return package;
+}
+
+constexpr std::size_t kNoLimit = std::numeric_limits<std::size_t>::max();
+
+}  // namespace
+
+SCENARIO("Sort field parsing", "[Ranking]") {
+  REQUIRE(aurpp::ParseSortBy("votes") == aurpp::SortBy::kVotes);
+  REQUIRE(aurpp::ParseSortBy("popularity") == aurpp::SortBy::kPopularity);
+  REQUIRE(aurpp::ParseSortBy("modified") == aurpp::SortBy::kModified);
+  REQUIRE(aurpp::ParseSortBy("name") == aurpp::SortBy::kName);
+  REQUIRE(aurpp::ParseSortBy("size") == aurpp::SortBy::kInvalid);
+}
+
+SCENARIO("Top-K selection of packages", "[Ranking]") {
+  GIVEN("Packages in server order") {
+    const std::vector<aurpp::AurPackage> packages{
+        MakePackage("yay", 2000, 30.0, 100),
+        MakePackage("paru", 1068, 22.0, 300),
+        MakePackage("pikaur", 300, 2.5, 200),
+        MakePackage("aurutils", 1068, 8.0, 50)};
+
+    THEN("Packages are ordered by the requested key") {
+      REQUIRE(aurpp::SelectTop(packages, aurpp::SortBy::kVotes, kNoLimit) ==
+              Positions{0, 1, 3, 2});
+      REQUIRE(aurpp::SelectTop(packages, aurpp::SortBy::kPopularity,
+                               kNoLimit) == Positions{0, 1, 3, 2});
+      REQUIRE(aurpp::SelectTop(packages, aurpp::SortBy::kModified,
+                               kNoLimit) == Positions{1, 2, 0, 3});
+      REQUIRE(aurpp::SelectTop(packages, aurpp::SortBy::kName, kNoLimit) ==
+              Positions{3, 1, 2, 0});
+    }
+
+    THEN("Only the top packages are selected") {
+      REQUIRE(aurpp::SelectTop(packages, aurpp::SortBy::kVotes, 2) ==
+              Positions{0, 1});
+      REQUIRE(aurpp::SelectTop(packages, aurpp::SortBy::kName, 1) ==
+              Positions{3});
+      REQUIRE(aurpp::SelectTop(packages, aurpp::SortBy::kVotes, 0).empty());
+    }
+
+    THEN("Without a sort key the server order is kept") {
+      REQUIRE(aurpp::SelectTop(packages, aurpp::SortBy::kNone, 3) ==
+              Positions{0, 1, 2});
+      REQUIRE(aurpp::SelectTop(packages, aurpp::SortBy::kNone, kNoLimit) ==
+              Positions{0, 1, 2, 3});
+    }
+  }
+
+  GIVEN("Search matches") {
+    std::vector<aurpp::FieldSearchMatch> matches(2);
+    matches[0].package = MakePackage("paru", 1068, 22.0, 300);
+    matches[1].package = MakePackage("yay", 2000, 30.0, 100);
+
+    THEN("They are ranked through a projection") {
+      REQUIRE(aurpp::SelectTop(matches, aurpp::SortBy::kVotes, kNoLimit,
+                               &aurpp::FieldSearchMatch::package) ==
+              Positions{1, 0});
+    }
+  }
+
+  GIVEN("No packages") {
+    const std::vector<aurpp::AurPackage> packages;
+
+    THEN("Nothing is selected") {
+      REQUIRE(aurpp::SelectTop(packages, aurpp::SortBy::kName, 10).empty());
+      REQUIRE(aurpp::SelectTop(packages, aurpp::SortBy::kNone, 10).empty());
+    }
+  }
+}
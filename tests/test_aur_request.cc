@@ -23,6 +23,7 @@ SCENARIO("AUR Request behavior", "[AURRequest]") {
 
       const std::string payload = request.Payload();
       REQUIRE(payload == "arg[]=foo");
+      REQUIRE(request.args() == std::vector<std::string_view>{"foo"});
     }
 
     THEN("Parameter values are encoded correctly") {
@@ -35,6 +36,31 @@ SCENARIO("AUR Request behavior", "[AURRequest]") {
     }
   }
 
+  GIVEN("A large list of InfoRequest arguments") {
+    const std::vector<std::string> args{"foo", "bar", "baz", "qux", "quux"};
+
+    THEN("The arguments are split into chunks of the requested size") {
+      const std::vector<aurpp::InfoRequest> requests =
+          aurpp::InfoRequest::Chunked(args, 2);
+
+      REQUIRE(requests.size() == 3);
+      REQUIRE(requests[0].Payload() == "arg[]=foo&arg[]=bar");
+      REQUIRE(requests[1].Payload() == "arg[]=baz&arg[]=qux");
+      REQUIRE(requests[2].Payload() == "arg[]=quux");
+    }
+
+    THEN("A chunk size of zero is treated as one argument per request") {
+      const std::vector<aurpp::InfoRequest> requests =
+          aurpp::InfoRequest::Chunked(args, 0);
+
+      REQUIRE(requests.size() == args.size());
+    }
+
+    THEN("No requests are built for an empty list") {
+      REQUIRE(aurpp::InfoRequest::Chunked({}, 2).empty());
+    }
+  }
+
   GIVEN("A SearchRequest") {
     THEN("The URL is built correctly.") {
       aurpp::SearchRequest request{aurpp::SearchRequest::SearchBy::kName,
@@ -42,6 +68,8 @@ SCENARIO("AUR Request behavior", "[AURRequest]") {
 
       const std::string url = request.Url(kBaseUrl);
       REQUIRE_THAT(url, EndsWith("/rpc/v5/search/foo?by=name"));
+      REQUIRE(request.search_by() == aurpp::SearchRequest::SearchBy::kName);
+      REQUIRE(request.arg() == "foo");
     }
   }
 
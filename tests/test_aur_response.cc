@@ -1,10 +1,18 @@
 // SPDX-License-Identifier: MIT
 
+#include <algorithm>
 #include <catch2/catch_test_macros.hpp>
 #include <expected>
 #include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "aurpp/response.h"
+#include "aurpp/stream.h"
+#include "list_equals.h"
 
 SCENARIO("AurResponse parsing behavior", "[AurResponse]") {
   GIVEN("A JSON file representing a response") {
@@ -30,10 +38,9 @@ SCENARIO("AurResponse parsing behavior", "[AurResponse]") {
       REQUIRE(pkg.last_modified() == 1751964728);
       REQUIRE(pkg.url_path() == "/cgit/aur.git/snapshot/paru.tar.gz");
       REQUIRE(pkg.id() == 1772991);
-      REQUIRE(pkg.depends() ==
-              std::vector<std::string>{"git", "pacman", "libalpm.so>=14"});
-      REQUIRE(pkg.make_depends() == std::vector<std::string>{"cargo"});
-      REQUIRE(pkg.opt_depends() == std::vector<std::string>{"bat", "devtools"});
+      REQUIRE(ListEquals(pkg.depends(), {"git", "pacman", "libalpm.so>=14"}));
+      REQUIRE(ListEquals(pkg.make_depends(), {"cargo"}));
+      REQUIRE(ListEquals(pkg.opt_depends(), {"bat", "devtools"}));
       // TODO: check_depends is made into a vector when parsing a null value
       // instead of remaining a std::nullopt
       REQUIRE(pkg.check_depends() == std::nullopt);
@@ -41,10 +48,118 @@ SCENARIO("AurResponse parsing behavior", "[AurResponse]") {
       REQUIRE(pkg.provides() == std::nullopt);
       REQUIRE(pkg.replaces() == std::nullopt);
       REQUIRE(pkg.groups() == std::nullopt);
-      REQUIRE(pkg.license() == std::vector<std::string>{"GPL-3.0-or-later"});
-      REQUIRE(pkg.keywords() == std::vector<std::string>{"AUR", "helper",
-                                                         "pacman", "rust",
-                                                         "wrapper", "yay"});
+      REQUIRE(ListEquals(pkg.license(), {"GPL-3.0-or-later"}));
+      REQUIRE(ListEquals(pkg.keywords(), {"AUR", "helper", "pacman", "rust",
+                                          "wrapper", "yay"}));
     }
   }
 }
+
+SCENARIO("RpcResponseStream incremental parsing", "[AurResponse]") {
+  GIVEN("A response whose results contain brackets and quotes in strings") {
+    const std::string response =
+        R"({"resultcount":2,"results":[)"
+        R"({"Name":"foo","Description":"has } and ] and \"{\" in it"},)"
+        R"({"Name":"bar","Depends":["baz"]}],"type":"search","version":5})";
+
+    std::vector<std::string> names;
+    aurpp::RpcResponseStream stream{[&names](const aurpp::AurPackage &pkg) {
+      names.emplace_back(pkg.name());
+    }};
+
+    WHEN("The response is fed one byte at a time") {
+      for (const char c : response) {
+        REQUIRE(stream.Feed(std::string_view{&c, 1}));
+      }
+
+      THEN("Every package is emitted in order") {
+        REQUIRE(names == std::vector<std::string>{"foo", "bar"});
+        REQUIRE(stream.Finish() == 2);
+      }
+    }
+
+    WHEN("Only the first package has arrived") {
+      const std::size_t second = response.find(R"({"Name":"bar")");
+      REQUIRE(stream.Feed(std::string_view{response}.substr(0, second)));
+
+      THEN("It is emitted before the response is complete") {
+        REQUIRE(names == std::vector<std::string>{"foo"});
+        REQUIRE(stream.Finish().has_value() == false);
+      }
+    }
+  }
+
+  GIVEN("The paru.json response split into chunks") {
+    std::ifstream file{"paru.json"};
+    std::ostringstream ss;
+    ss << file.rdbuf();
+    const std::string contents = ss.str();
+
+    std::vector<aurpp::AurPackage> packages;
+    aurpp::RpcResponseStream stream{[&packages](aurpp::AurPackage pkg) {
+      packages.push_back(std::move(pkg));
+    }};
+    for (std::size_t i = 0; i < contents.size(); i += 7) {
+      REQUIRE(stream.Feed(std::string_view{contents}.substr(i, 7)));
+    }
+
+    THEN("The package matches the one parsed from the whole response") {
+      const std::expected<aurpp::RpcResponse, std::string> maybe_response =
+          aurpp::RpcResponse::Parse(contents);
+      REQUIRE(maybe_response.has_value() == true);
+      REQUIRE(stream.Finish() == 1);
+      REQUIRE(packages.size() == 1);
+      REQUIRE(packages[0].name() == maybe_response.value().packages[0].name());
+      REQUIRE(std::ranges::equal(
+          packages[0].depends().value(),
+          maybe_response.value().packages[0].depends().value()));
+    }
+  }
+
+  GIVEN("A malformed response") {
+    aurpp::RpcResponseStream stream{[](const aurpp::AurPackage &) {}};
+
+    THEN("An invalid element is reported as an error") {
+      REQUIRE(stream.Feed(R"({"results":[{"Name":}]})") == false);
+      REQUIRE(stream.error().has_value() == true);
+      REQUIRE(stream.Finish().has_value() == false);
+    }
+
+    THEN("Data outside of the document is reported as an error") {
+      REQUIRE(stream.Feed(R"({"results":[]} trailing)") == false);
+      REQUIRE(stream.Finish().has_value() == false);
+    }
+
+    THEN("An empty response is reported as an error") {
+      REQUIRE(aurpp::RpcResponse::Parse("").has_value() == false);
+    }
+  }
+
+  GIVEN("An RPC error response") {
+    const std::string response =
+        R"({"error":"Query arg \"a\" too small.","resultcount":0,)"
+        R"("results":[],"type":"error","version":5})";
+    aurpp::RpcResponseStream stream{[](const aurpp::AurPackage &) {}};
+
+    WHEN("It is fed one byte at a time") {
+      for (const char c : response) {
+        REQUIRE(stream.Feed(std::string_view{&c, 1}));
+      }
+
+      THEN("Its error message is reported like RpcResponse::Parse does") {
+        REQUIRE(stream.Finish() ==
+                std::unexpected{"Query arg \"a\" too small."});
+        REQUIRE(aurpp::RpcResponse::Parse(response).error() ==
+                stream.Finish().error());
+      }
+    }
+  }
+
+  GIVEN("A response with an empty error and a key named error in a package") {
+    aurpp::RpcResponseStream stream{[](const aurpp::AurPackage &) {}};
+    REQUIRE(stream.Feed(R"({"error":"","results":[{"Name":"error"}],)"
+                        R"("type":"search"})"));
+
+    THEN("It is not an error") { REQUIRE(stream.Finish() == 1); }
+  }
+}
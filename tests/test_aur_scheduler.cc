@@ -0,0 +1,274 @@
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <expected>
+#include <fstream>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "aurpp/client.h"
+#include "aurpp/request.h"
+#include "aurpp/response.h"
+#include "aurpp/scheduler.h"
+#include "loopback_server.h"
+
+namespace {
+
+using Clock = aurpp::TokenBucket::Clock;
+
+const Clock::time_point kStart = Clock::time_point{std::chrono::hours{1}};
+
+std::string ReadFile(const std::string &path) {
+  std::ifstream file{path};
+  std::ostringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+aurpp::SchedulerOptions FastOptions() {
+  aurpp::SchedulerOptions options;
+  options.requests_per_second = 1000;
+  options.base_delay = std::chrono::milliseconds{10};
+  options.max_delay = std::chrono::milliseconds{100};
+  return options;
+}
+
+}  // namespace
+
+SCENARIO("TokenBucket behavior", "[Scheduler]") {
+  GIVEN("A bucket of 2 requests per second with a burst of 3") {
+    aurpp::TokenBucket bucket{2, 3, kStart};
+
+    THEN("The burst is available at once") {
+      REQUIRE(bucket.TryTake(kStart) == Clock::duration::zero());
+      REQUIRE(bucket.TryTake(kStart) == Clock::duration::zero());
+      REQUIRE(bucket.TryTake(kStart) == Clock::duration::zero());
+
+      AND_THEN("The next token comes after half a second") {
+        const Clock::duration wait = bucket.TryTake(kStart);
+        REQUIRE(wait == std::chrono::milliseconds{500});
+        REQUIRE(bucket.TryTake(kStart + wait) == Clock::duration::zero());
+      }
+    }
+
+    WHEN("The bucket is paused") {
+      bucket.PauseUntil(kStart + std::chrono::seconds{5});
+
+      THEN("No token is handed out until the pause ends") {
+        REQUIRE(bucket.TryTake(kStart + std::chrono::seconds{1}) ==
+                std::chrono::seconds{4});
+        REQUIRE(bucket.TryTake(kStart + std::chrono::seconds{5}) ==
+                Clock::duration::zero());
+      }
+    }
+
+    WHEN("The bucket is left alone for a long time") {
+      REQUIRE(bucket.TryTake(kStart) == Clock::duration::zero());
+      const Clock::time_point later = kStart + std::chrono::hours{1};
+
+      THEN("It holds no more than the burst") {
+        for (int i = 0; i < 3; ++i) {
+          REQUIRE(bucket.TryTake(later) == Clock::duration::zero());
+        }
+        REQUIRE(bucket.TryTake(later) != Clock::duration::zero());
+      }
+    }
+  }
+}
+
+SCENARIO("Retry decisions", "[Scheduler]") {
+  GIVEN("Failed transfers") {
+    THEN("Only transient failures are retried") {
+      REQUIRE(aurpp::detail::IsTransientFailure(CURLE_OK, 429));
+      REQUIRE(aurpp::detail::IsTransientFailure(CURLE_OK, 503));
+      REQUIRE(aurpp::detail::IsTransientFailure(CURLE_COULDNT_CONNECT, 0));
+      REQUIRE(aurpp::detail::IsTransientFailure(CURLE_OPERATION_TIMEDOUT, 0));
+      REQUIRE_FALSE(aurpp::detail::IsTransientFailure(CURLE_OK, 200));
+      REQUIRE_FALSE(aurpp::detail::IsTransientFailure(CURLE_OK, 404));
+      REQUIRE_FALSE(
+          aurpp::detail::IsTransientFailure(CURLE_COULDNT_RESOLVE_HOST, 0));
+    }
+
+    THEN("Retry-After is read in seconds") {
+      REQUIRE(aurpp::detail::ParseRetryAfter("120") ==
+              std::chrono::seconds{120});
+      REQUIRE_FALSE(aurpp::detail::ParseRetryAfter("").has_value());
+      REQUIRE_FALSE(aurpp::detail::ParseRetryAfter("-1").has_value());
+      REQUIRE_FALSE(aurpp::detail::ParseRetryAfter(
+                        "Wed, 21 Oct 2015 07:28:00 GMT")
+                        .has_value());
+    }
+
+    THEN("The backoff doubles up to the maximum") {
+      constexpr std::chrono::milliseconds kBase{100};
+      constexpr std::chrono::milliseconds kMax{1000};
+      REQUIRE(aurpp::detail::BackoffCeiling(1, kBase, kMax) == kBase);
+      REQUIRE(aurpp::detail::BackoffCeiling(2, kBase, kMax) == 2 * kBase);
+      REQUIRE(aurpp::detail::BackoffCeiling(4, kBase, kMax) == 8 * kBase);
+      REQUIRE(aurpp::detail::BackoffCeiling(5, kBase, kMax) == kMax);
+      REQUIRE(aurpp::detail::BackoffCeiling(100, kBase, kMax) == kMax);
+    }
+  }
+
+  GIVEN("A scheduler allowing 3 attempts") {
+    aurpp::SchedulerOptions options;
+    options.max_attempts = 3;
+    options.base_delay = std::chrono::milliseconds{100};
+    options.max_delay = std::chrono::seconds{1};
+    aurpp::RequestScheduler scheduler{options};
+
+    THEN("Retries wait at most the backoff ceiling") {
+      for (int i = 0; i < 100; ++i) {
+        const auto delay = scheduler.RetryDelay(2, std::nullopt);
+        REQUIRE(delay.has_value());
+        REQUIRE(*delay <= std::chrono::milliseconds{200});
+      }
+    }
+
+    THEN("The server's Retry-After is honoured") {
+      REQUIRE(scheduler.RetryDelay(1, std::chrono::seconds{1}) ==
+              std::chrono::seconds{1});
+    }
+
+    THEN("Retries stop after the last attempt or a long Retry-After") {
+      REQUIRE_FALSE(scheduler.RetryDelay(3, std::nullopt).has_value());
+      REQUIRE_FALSE(
+          scheduler.RetryDelay(1, std::chrono::seconds{60}).has_value());
+    }
+  }
+}
+
+SCENARIO("Coalescing identical requests", "[Scheduler]") {
+  GIVEN("A scheduler") {
+    aurpp::RequestScheduler scheduler;
+
+    WHEN("A request is claimed twice before its result is published") {
+      const aurpp::RequestScheduler::Claim first =
+          scheduler.ClaimRequest("key");
+      const aurpp::RequestScheduler::Claim second =
+          scheduler.ClaimRequest("key");
+      scheduler.Publish("key", std::string{"body"});
+
+      THEN("Only the first performs it and both get the result") {
+        REQUIRE(first.leader);
+        REQUIRE_FALSE(second.leader);
+        REQUIRE(second.result.get() == "body");
+      }
+
+      AND_WHEN("It is claimed again") {
+        THEN("The claim leads a new request") {
+          REQUIRE(scheduler.ClaimRequest("key").leader);
+        }
+      }
+    }
+  }
+}
+
+SCENARIO("Client with a scheduler", "[Scheduler]") {
+  const std::string body = ReadFile("paru.json");
+  aurpp::InfoRequest request;
+  request.AddArg("paru");
+
+  GIVEN("A server that is overloaded for the first two requests") {
+    LoopbackServer server{[&body](const int number, std::string_view) {
+      if (number < 2) {
+        return Failure(503, "Retry-After: 0\r\n");
+      }
+      return Success(body);
+    }};
+
+    WHEN("A client without a scheduler makes a request") {
+      aurpp::Client client{server.url()};
+      auto result =
+          client.Execute<aurpp::InfoRequest, aurpp::RpcResponse>(request);
+
+      THEN("The failure is returned") {
+        REQUIRE_FALSE(result.has_value());
+        REQUIRE(result.error() == "HTTP error: 503");
+      }
+    }
+
+    WHEN("A client with a scheduler makes a request") {
+      aurpp::Client client{server.url()};
+      client.set_scheduler(
+          std::make_shared<aurpp::RequestScheduler>(FastOptions()));
+      auto result =
+          client.Execute<aurpp::InfoRequest, aurpp::RpcResponse>(request);
+
+      THEN("It is retried until it succeeds") {
+        REQUIRE(result.has_value());
+        REQUIRE(result.value().packages[0].name() == "paru");
+        REQUIRE(server.requests() == 3);
+      }
+    }
+
+    WHEN("The scheduler gives up before the server recovers") {
+      aurpp::SchedulerOptions options = FastOptions();
+      options.max_attempts = 2;
+      aurpp::Client client{server.url()};
+      client.set_scheduler(std::make_shared<aurpp::RequestScheduler>(options));
+      auto result =
+          client.Execute<aurpp::InfoRequest, aurpp::RpcResponse>(request);
+
+      THEN("The last failure is returned") {
+        REQUIRE_FALSE(result.has_value());
+        REQUIRE(result.error() == "HTTP error: 503");
+        REQUIRE(server.requests() == 2);
+      }
+    }
+  }
+
+  GIVEN("A healthy server") {
+    LoopbackServer server{
+        [&body](int, std::string_view) { return Success(body); }};
+    aurpp::Client client{server.url()};
+    client.set_scheduler(
+        std::make_shared<aurpp::RequestScheduler>(FastOptions()));
+
+    WHEN("The same request is made several times in one batch") {
+      std::vector<aurpp::InfoRequest> requests(4);
+      for (aurpp::InfoRequest &copy : requests) {
+        copy.AddArg("paru");
+      }
+      auto results = client.ExecuteMany<aurpp::InfoRequest, aurpp::RpcResponse>(
+          std::span{requests});
+
+      THEN("One transfer answers all of them") {
+        for (const auto &result : results) {
+          REQUIRE(result.has_value());
+          REQUIRE(result.value().packages[0].name() == "paru");
+        }
+        REQUIRE(server.requests() == 1);
+      }
+    }
+  }
+
+  GIVEN("A server whose first response is slow") {
+    LoopbackServer server{[&body](const int number, std::string_view) {
+      return Success(body,
+                     std::chrono::milliseconds{number == 0 ? 2000 : 0});
+    }};
+    aurpp::SchedulerOptions options = FastOptions();
+    options.hedge_after = std::chrono::milliseconds{50};
+    aurpp::Client client{server.url()};
+    client.set_scheduler(std::make_shared<aurpp::RequestScheduler>(options));
+
+    WHEN("A request is made") {
+      const Clock::time_point start = Clock::now();
+      auto result =
+          client.Execute<aurpp::InfoRequest, aurpp::RpcResponse>(request);
+      const Clock::duration elapsed = Clock::now() - start;
+
+      THEN("A hedged request answers it without waiting for the first") {
+        REQUIRE(result.has_value());
+        REQUIRE(result.value().packages[0].name() == "paru");
+        REQUIRE(server.requests() == 2);
+        REQUIRE(elapsed < std::chrono::seconds{1});
+      }
+    }
+  }
+}
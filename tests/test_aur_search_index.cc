@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "aurpp/search_index.h"
+#include "temp_dir.h"
+
+namespace {
+
+using SearchBy = aurpp::SearchRequest::SearchBy;
+using Terms = std::vector<std::string_view>;
+
+aurpp::AurPackage MakePackage(const int id, const std::string_view name,
+                              const std::string_view description) {
+  aurpp::AurPackage package{};
+  package.set_id(id);
+  package.set_name(name);
+  package.set_version("1.0-1");
+  package.set_description(description);
+  package.set_num_votes(id);
+  package.set_depends({"glibc", std::format("lib{}>=1", name)});
+  return package;
+}
+
+// Twenty packages, enough that a couple of changes stay in the delta
+std::vector<aurpp::AurPackage> MakePackages() {
+  std::vector<aurpp::AurPackage> packages;
+  packages.push_back(MakePackage(1, "paru", "Feature packed AUR helper"));
+  packages.push_back(MakePackage(2, "paru-bin", "Feature packed AUR helper"));
+  packages.push_back(MakePackage(3, "yay", "Yet another yogurt"));
+  for (int i = 4; i <= 20; ++i) {
+    packages.push_back(
+        MakePackage(i, std::format("python-lib{}", i), "A Python library"));
+  }
+  packages[2].set_maintainer("jguer");
+  packages[2].set_keywords({"aur", "helper"});
+  return packages;
+}
+
+std::vector<std::string> Names(
+    const std::expected<aurpp::RpcResponse, std::string> &response) {
+  std::vector<std::string> names;
+  for (const aurpp::AurPackage &package : response->packages) {
+    names.emplace_back(package.name());
+  }
+  return names;
+}
+
+std::vector<std::string> Search(const aurpp::SearchIndex &index,
+                                const SearchBy search_by, const Terms &terms) {
+  const auto response = index.Search(search_by, terms);
+  REQUIRE(response.has_value());
+  return Names(response);
+}
+
+}  // namespace
+
+SCENARIO("SearchIndex behavior", "[SearchIndex]") {
+  const TempDir temp{"index"};
+  const std::filesystem::path directory = temp / "index";
+
+  GIVEN("An index built from packages") {
+    std::vector<aurpp::AurPackage> packages = MakePackages();
+    aurpp::SearchIndex index = aurpp::SearchIndex::Open(directory);
+    REQUIRE(index.source().empty());
+
+    const auto stats = index.Update(packages, "v1");
+    REQUIRE(stats.has_value());
+    REQUIRE(stats->rebuilt);
+    REQUIRE(index.size() == packages.size());
+    REQUIRE(index.source() == "v1");
+
+    THEN("Names are searched for substrings regardless of case") {
+      REQUIRE(Search(index, SearchBy::kName, {"PARU"}) ==
+              std::vector<std::string>{"paru", "paru-bin"});
+      REQUIRE(Search(index, SearchBy::kName, {"ya"}) ==
+              std::vector<std::string>{"yay"});
+      REQUIRE(Search(index, SearchBy::kName, {"rap"}).empty());
+    }
+
+    THEN("Every term must match") {
+      REQUIRE(Search(index, SearchBy::kName, {"paru", "bin"}) ==
+              std::vector<std::string>{"paru-bin"});
+      REQUIRE(Search(index, SearchBy::kNameDesc, {"helper", "yay"}).empty());
+    }
+
+    THEN("Name and description searches match either") {
+      REQUIRE(Search(index, SearchBy::kNameDesc, {"yogurt"}) ==
+              std::vector<std::string>{"yay"});
+    }
+
+    THEN("Other fields match exact terms") {
+      REQUIRE(Search(index, SearchBy::kDepends, {"libyay"}) ==
+              std::vector<std::string>{"yay"});
+      REQUIRE(Search(index, SearchBy::kDepends, {"glibc"}).size() == 20);
+      REQUIRE(Search(index, SearchBy::kKeywords, {"aur"}) ==
+              std::vector<std::string>{"yay"});
+      REQUIRE(Search(index, SearchBy::kMaintainer, {"jguer"}) ==
+              std::vector<std::string>{"yay"});
+      REQUIRE(Search(index, SearchBy::kMaintainer, {""}).size() == 19);
+    }
+
+    THEN("Stored fields are returned") {
+      const auto response = index.Search(SearchBy::kName, Terms{"yay"});
+      REQUIRE(response.has_value());
+      REQUIRE(response->packages[0].version() == "1.0-1");
+      REQUIRE(response->packages[0].description() == "Yet another yogurt");
+      REQUIRE(response->packages[0].num_votes() == 3);
+      REQUIRE(response->packages[0].id() == 3);
+    }
+
+    THEN("Invalid searches are reported") {
+      REQUIRE(index.Search(SearchBy::kName, Terms{"y"}).has_value() == false);
+      REQUIRE(index.Search(SearchBy::kSubmitter, Terms{"jguer"}).has_value() ==
+              false);
+    }
+
+    THEN("The index is persisted") {
+      const aurpp::SearchIndex reopened = aurpp::SearchIndex::Open(directory);
+      REQUIRE(reopened.source() == "v1");
+      REQUIRE(reopened.size() == packages.size());
+      REQUIRE(Search(reopened, SearchBy::kName, {"paru"}) ==
+              std::vector<std::string>{"paru", "paru-bin"});
+    }
+
+    WHEN("A few packages change") {
+      packages[0].set_description("A rewritten AUR helper");
+      packages[2].set_num_votes(1000);
+      packages.erase(packages.begin() + 1);
+      packages.push_back(MakePackage(21, "pikaur", "AUR helper"));
+
+      const auto update = index.Update(packages, "v2");
+
+      THEN("Only the changed packages are indexed again") {
+        REQUIRE(update.has_value());
+        REQUIRE_FALSE(update->rebuilt);
+        REQUIRE(update->indexed == 2);
+        REQUIRE(update->removed == 2);
+        REQUIRE(index.size() == packages.size());
+      }
+
+      THEN("Searches see the changes") {
+        REQUIRE(Search(index, SearchBy::kName, {"paru"}) ==
+                std::vector<std::string>{"paru"});
+        REQUIRE(Search(index, SearchBy::kNameDesc, {"rewritten"}) ==
+                std::vector<std::string>{"paru"});
+        REQUIRE(Search(index, SearchBy::kNameDesc, {"feature"}).empty());
+        REQUIRE(Search(index, SearchBy::kNameDesc, {"aur helper"}) ==
+                std::vector<std::string>{"paru", "pikaur"});
+
+        const auto yay = index.Search(SearchBy::kName, Terms{"yay"});
+        REQUIRE(yay->packages[0].num_votes() == 1000);
+      }
+
+      THEN("The update is persisted") {
+        const aurpp::SearchIndex reopened =
+            aurpp::SearchIndex::Open(directory);
+        REQUIRE(reopened.source() == "v2");
+        REQUIRE(Search(reopened, SearchBy::kName, {"paru"}) ==
+                std::vector<std::string>{"paru"});
+        REQUIRE(Search(reopened, SearchBy::kName, {"pikaur"}) ==
+                std::vector<std::string>{"pikaur"});
+      }
+    }
+
+    WHEN("Most packages change") {
+      for (aurpp::AurPackage &package : packages) {
+        package.set_version("2.0-1");
+      }
+
+      const auto update = index.Update(packages, "v2");
+
+      THEN("The index is rebuilt") {
+        REQUIRE(update.has_value());
+        REQUIRE(update->rebuilt);
+        REQUIRE(index.size() == packages.size());
+        REQUIRE(index.Search(SearchBy::kName, Terms{"yay"})
+                    ->packages[0]
+                    .version() == "2.0-1");
+      }
+    }
+  }
+
+  GIVEN("A damaged index") {
+    std::filesystem::create_directories(directory);
+    std::ofstream{directory / "manifest"} << "yarp-index-v1\nv1\nbase.seg\n\n";
+    std::ofstream{directory / "base.seg"} << "not an index";
+
+    THEN("It opens as an empty index") {
+      const aurpp::SearchIndex index = aurpp::SearchIndex::Open(directory);
+      REQUIRE(index.source().empty());
+      REQUIRE(index.size() == 0);
+      REQUIRE(index.Search(SearchBy::kName, Terms{"paru"})->packages.empty());
+    }
+  }
+}
@@ -0,0 +1,189 @@
+// SPDX-License-Identifier: MIT
+
+#include <json/json.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "aurpp/client.h"
+#include "aurpp/request.h"
+#include "aurpp/response.h"
+#include "aurpp/transfer_stats.h"
+#include "loopback_server.h"
+
+namespace {
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+
+aurpp::TransferInfo NewConnection() {
+  aurpp::TransferInfo info;
+  info.url = "https://aur.archlinux.org/rpc/v5/info?arg[]=paru";
+  info.http_version = "HTTP/2";
+  info.name_lookup_time = milliseconds{5};
+  info.connect_time = milliseconds{15};
+  info.tls_time = milliseconds{45};
+  info.start_transfer_time = milliseconds{145};
+  info.total_time = milliseconds{150};
+  info.downloaded_bytes = 1000;
+  return info;
+}
+
+aurpp::TransferInfo ReusedConnection() {
+  aurpp::TransferInfo info;
+  info.url = "https://aur.archlinux.org/rpc/v5/info?arg[]=yay";
+  info.http_version = "HTTP/2";
+  info.start_transfer_time = milliseconds{80};
+  info.total_time = milliseconds{82};
+  info.downloaded_bytes = 500;
+  info.reused_connection = true;
+  return info;
+}
+
+Json::Value ParseJson(const std::string &text) {
+  Json::CharReaderBuilder reader_builder;
+  Json::Value json;
+  std::string errors;
+  std::istringstream stream{text};
+  REQUIRE(Json::parseFromStream(reader_builder, stream, &json, &errors));
+  return json;
+}
+
+}  // namespace
+
+SCENARIO("Splitting transfer times into phases", "[TransferStats]") {
+  GIVEN("A transfer over a new TLS connection") {
+    const aurpp::TransferPhases phases =
+        aurpp::detail::SplitPhases(NewConnection());
+
+    THEN("Every phase is the difference to the previous one") {
+      REQUIRE(phases.name_lookup == milliseconds{5});
+      REQUIRE(phases.connect == milliseconds{10});
+      REQUIRE(phases.tls == milliseconds{30});
+      REQUIRE(phases.server == milliseconds{100});
+      REQUIRE(phases.transfer == milliseconds{5});
+      REQUIRE(phases.total == milliseconds{150});
+    }
+  }
+
+  GIVEN("A transfer over a reused connection") {
+    const aurpp::TransferPhases phases =
+        aurpp::detail::SplitPhases(ReusedConnection());
+
+    THEN("The skipped phases take no time") {
+      REQUIRE(phases.name_lookup == microseconds{0});
+      REQUIRE(phases.connect == microseconds{0});
+      REQUIRE(phases.tls == microseconds{0});
+      REQUIRE(phases.server == milliseconds{80});
+      REQUIRE(phases.transfer == milliseconds{2});
+    }
+  }
+
+  GIVEN("A plain HTTP transfer") {
+    aurpp::TransferInfo info = NewConnection();
+    info.tls_time = microseconds{0};
+    const aurpp::TransferPhases phases = aurpp::detail::SplitPhases(info);
+
+    THEN("The server phase starts once connected") {
+      REQUIRE(phases.tls == microseconds{0});
+      REQUIRE(phases.server == milliseconds{130});
+    }
+  }
+}
+
+SCENARIO("TransferStats summaries", "[TransferStats]") {
+  GIVEN("Stats of one new and two reused connections") {
+    aurpp::TransferStats stats;
+    stats.Record(NewConnection());
+    stats.Record(ReusedConnection());
+    stats.Record(ReusedConnection());
+
+    WHEN("They are formatted as JSON") {
+      const Json::Value json = ParseJson(stats.FormatJson());
+
+      THEN("Every phase is summarized and every transfer listed") {
+        REQUIRE(json["count"].asUInt64() == 3);
+        REQUIRE(json["transfers"].size() == 3);
+        REQUIRE(json["transfers"][0]["tls_ms"].asDouble() == 30.0);
+        REQUIRE(json["transfers"][1]["reused_connection"].asBool());
+
+        const Json::Value &total = json["phases"]["total"];
+        REQUIRE(total["max_ms"].asDouble() == 150.0);
+        REQUIRE(total["p50_ms"].asDouble() == 82.0);
+        REQUIRE(json["phases"]["server"]["p90_ms"].asDouble() == 100.0);
+      }
+
+      THEN("The histograms count the transfers by duration") {
+        const Json::Value &bounds = json["histogram_bounds_ms"];
+        const Json::Value &histogram = json["phases"]["total"]["histogram"];
+        REQUIRE(histogram.size() == bounds.size() + 1);
+        // 82 ms is under 128 ms, 150 ms under 256 ms
+        REQUIRE(bounds[7].asUInt() == 128);
+        REQUIRE(histogram[7].asUInt64() == 2);
+        REQUIRE(histogram[8].asUInt64() == 1);
+      }
+    }
+
+    WHEN("They are formatted as text") {
+      const std::string text = stats.FormatText();
+
+      THEN("The table and histogram are included") {
+        REQUIRE(text.contains("Transfers  : 3 (2 on reused connections)"));
+        REQUIRE(text.contains("Received   : 2000 bytes"));
+        REQUIRE(text.contains("HTTP/2     : 3"));
+        REQUIRE(text.contains("server"));
+        REQUIRE(text.contains("< 128 ms      2 ##"));
+        REQUIRE(text.contains("< 256 ms      1 #"));
+      }
+    }
+  }
+
+  GIVEN("Stats without transfers") {
+    const aurpp::TransferStats stats;
+
+    THEN("The summary is empty") {
+      REQUIRE(ParseJson(stats.FormatJson())["count"].asUInt64() == 0);
+      REQUIRE(stats.FormatText().contains("Transfers  : 0"));
+    }
+  }
+}
+
+SCENARIO("TransferStats of a concurrent batch", "[TransferStats]") {
+  GIVEN("A client recording into stats") {
+    LoopbackServer server{[](int, std::string_view) {
+      return Success(R"({"resultcount":0,"results":[],"type":"search"})");
+    }};
+    aurpp::Client client{server.url()};
+    aurpp::TransferStats stats;
+    client.set_transfer_observer(
+        [&stats](const aurpp::TransferInfo &info) { stats.Record(info); });
+
+    WHEN("A batch of requests runs") {
+      std::vector<aurpp::SearchRequest> requests;
+      for (const std::string_view term : {"paru", "yay", "pikaur", "aura"}) {
+        requests.emplace_back(aurpp::SearchRequest::SearchBy::kName,
+                              std::string{term});
+      }
+      const auto results =
+          client.ExecuteMany<aurpp::SearchRequest, aurpp::RpcResponse>(
+              requests);
+
+      THEN("Every transfer is recorded") {
+        REQUIRE(stats.count() == requests.size());
+        const Json::Value json = ParseJson(stats.FormatJson());
+        std::size_t histogram_total = 0;
+        for (const Json::Value &count : json["phases"]["total"]["histogram"]) {
+          histogram_total += count.asUInt64();
+        }
+        REQUIRE(histogram_total == requests.size());
+        REQUIRE(json["transfers"][0]["http_version"].asString() ==
+                "HTTP/1.1");
+      }
+    }
+  }
+}
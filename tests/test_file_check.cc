@@ -0,0 +1,251 @@
+// SPDX-License-Identifier: MIT
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../src/file_check.h"
+#include "../src/mtree.h"
+#include "temp_dir.h"
+
+namespace {
+
+using Problem = std::pair<std::string_view, yarp::FileProblem>;
+
+// Sets the modification time of path to seconds since the epoch
+void SetMtime(const std::filesystem::path &path, const std::int64_t seconds) {
+  const timespec times[2] = {{seconds, 0}, {seconds, 0}};
+  REQUIRE(utimensat(AT_FDCWD, path.c_str(), times, AT_SYMLINK_NOFOLLOW) == 0);
+}
+
+}  // namespace
+
+SCENARIO("CheckFiles behavior", "[CheckFiles]") {
+  const TempDir temp{"file-check"};
+  const std::filesystem::path &root = temp.path();
+  std::filesystem::create_directories(root / "usr/bin");
+  std::filesystem::create_directories(root / "etc/pacman.d");
+  std::ofstream{root / "usr/bin/pacman"} << "pacman";
+  std::ofstream{root / "etc/pacman.conf"} << "[options]";
+
+  GIVEN("Packages whose files are all there") {
+    const std::vector<yarp::FileCheckPackage> packages{
+        {"filesystem", {"etc/", "usr/", "usr/bin/"}},
+        {"pacman", {"etc/pacman.conf", "etc/pacman.d/", "usr/bin/pacman"}},
+    };
+    const auto results = yarp::CheckFiles(root, packages);
+
+    THEN("Nothing is missing") {
+      REQUIRE(results.has_value());
+      REQUIRE(results->size() == 2);
+      REQUIRE((*results)[0].total == 3);
+      REQUIRE((*results)[0].missing == 0);
+      REQUIRE((*results)[1].total == 3);
+      REQUIRE((*results)[1].missing == 0);
+      REQUIRE((*results)[1].type_mismatches.empty());
+    }
+  }
+
+  GIVEN("Packages with missing and mistyped files") {
+    const std::vector<yarp::FileCheckPackage> packages{
+        {"bash", {"usr/bin/bash", "usr/bin/sh"}},
+        {"empty", {}},
+        {"pacman", {"etc/pacman.conf/", "usr/bin/", "usr/bin/pacman"}},
+    };
+    const auto results = yarp::CheckFiles(root, packages);
+
+    THEN("They are reported for their packages, in order") {
+      REQUIRE(results.has_value());
+      REQUIRE(results->size() == 3);
+      REQUIRE((*results)[0].total == 2);
+      REQUIRE((*results)[0].missing == 2);
+      REQUIRE((*results)[1].total == 0);
+      REQUIRE((*results)[1].missing == 0);
+      REQUIRE((*results)[2].total == 3);
+      // A file where a directory is expected can't be looked up as one
+      REQUIRE((*results)[2].missing == 1);
+      REQUIRE((*results)[2].type_mismatches.empty());
+    }
+  }
+
+  GIVEN("A directory where a file is expected") {
+    const std::vector<yarp::FileCheckPackage> packages{
+        {"pacman", {"etc/pacman.d", "usr/bin/pacman"}},
+    };
+    const auto results = yarp::CheckFiles(root, packages);
+
+    THEN("It is a type mismatch") {
+      REQUIRE(results.has_value());
+      REQUIRE((*results)[0].missing == 1);
+      REQUIRE((*results)[0].type_mismatches ==
+              std::vector<std::string_view>{"etc/pacman.d"});
+    }
+  }
+
+  GIVEN("Many more files than a thread checks at once") {
+    std::vector<std::string> names;
+    for (int i = 0; i < 5000; ++i) {
+      names.push_back(i % 7 == 0 ? std::format("usr/missing-{}", i)
+                                 : std::string{"usr/bin/pacman"});
+    }
+    yarp::FileCheckPackage package{"many", {}};
+    package.files.assign(names.begin(), names.end());
+    const auto results = yarp::CheckFiles(root, {&package, 1});
+
+    THEN("Every file is checked") {
+      REQUIRE(results.has_value());
+      REQUIRE((*results)[0].total == 5000);
+      REQUIRE((*results)[0].missing == 715);
+    }
+  }
+
+  GIVEN("A root directory that doesn't exist") {
+    THEN("Checking fails") {
+      REQUIRE_FALSE(yarp::CheckFiles(root / "nonexistent", {}).has_value());
+    }
+  }
+}
+
+SCENARIO("CheckFilesFull behavior", "[CheckFiles]") {
+  const TempDir temp{"file-check-full"};
+  const std::filesystem::path &root = temp.path();
+  std::filesystem::create_directories(root / "usr/bin");
+  std::filesystem::create_directories(root / "etc");
+  std::ofstream{root / "usr/bin/pacman"} << "pacman";
+  std::ofstream{root / "etc/pacman.conf"} << "[options]";
+  std::filesystem::create_symlink("pacman", root / "usr/bin/pacman-static");
+  // Set explicitly, since what they're created with depends on the umask
+  for (const char *const dir : {"etc", "usr", "usr/bin"}) {
+    std::filesystem::permissions(root / dir, std::filesystem::perms{0755});
+  }
+  std::filesystem::permissions(root / "usr/bin/pacman",
+                               std::filesystem::perms{0755});
+  std::filesystem::permissions(root / "etc/pacman.conf",
+                               std::filesystem::perms{0644});
+  SetMtime(root / "usr/bin/pacman", 1700000000);
+  SetMtime(root / "usr/bin/pacman-static", 1700000000);
+  SetMtime(root / "etc/pacman.conf", 1700000000);
+
+  // The mtree pacman would have written for these files
+  const auto mtree = yarp::ParseMtree(R"(#mtree
+/set type=file mode=644
+./etc time=1 mode=755 type=dir
+./etc/pacman.conf time=1700000000.0 size=9 sha256digest=0000000000000000000000000000000000000000000000000000000000000000
+./usr time=1 mode=755 type=dir
+./usr/bin time=1 mode=755 type=dir
+./usr/bin/pacman time=1700000000.0 mode=755 size=6 sha256digest=4eb7ef52a0e1337a674211b8ebd5709a92871d0f31e813d791cdd83ac56ff706
+./usr/bin/pacman-static time=1700000000.0 mode=777 type=link link=pacman
+)");
+  REQUIRE(mtree.has_value());
+
+  GIVEN("Installed files matching the mtree") {
+    // The backed up configuration file has been edited since
+    const std::vector<yarp::FullCheckPackage> packages{
+        {"pacman", *mtree, {"etc/pacman.conf"}},
+    };
+    const auto results = yarp::CheckFilesFull(root, packages);
+
+    THEN("Nothing is altered") {
+      REQUIRE(results.has_value());
+      REQUIRE((*results)[0].total == 6);
+      REQUIRE((*results)[0].altered == 0);
+      REQUIRE((*results)[0].problems.empty());
+    }
+  }
+
+  GIVEN("Installed files that were changed") {
+    std::ofstream{root / "usr/bin/pacman"} << "pacmaN";
+    SetMtime(root / "usr/bin/pacman", 1700000000);
+    std::filesystem::remove(root / "usr/bin/pacman-static");
+    std::filesystem::create_symlink("pacman.old",
+                                    root / "usr/bin/pacman-static");
+    SetMtime(root / "usr/bin/pacman-static", 1700000000);
+    std::filesystem::permissions(root / "etc", std::filesystem::perms{0700});
+
+    const std::vector<yarp::FullCheckPackage> packages{
+        {"filesystem", std::span{*mtree}.first(1), {}},
+        {"pacman", std::span{*mtree}.subspan(1), {}},
+    };
+    const auto results = yarp::CheckFilesFull(root, packages);
+
+    THEN("What differs is reported for their packages, in order") {
+      REQUIRE(results.has_value());
+      REQUIRE(results->size() == 2);
+      REQUIRE((*results)[0].problems ==
+              std::vector<Problem>{{"etc", yarp::FileProblem::kMode}});
+      REQUIRE((*results)[1].total == 5);
+      REQUIRE((*results)[1].altered == 3);
+      REQUIRE((*results)[1].problems ==
+              std::vector<Problem>{
+                  {"etc/pacman.conf", yarp::FileProblem::kChecksum},
+                  {"usr/bin/pacman", yarp::FileProblem::kChecksum},
+                  {"usr/bin/pacman-static", yarp::FileProblem::kLink}});
+    }
+  }
+
+  GIVEN("Installed files with other metadata") {
+    std::ofstream{root / "usr/bin/pacman", std::ios::app} << "!";
+    std::filesystem::permissions(root / "usr/bin/pacman",
+                                 std::filesystem::perms{0700});
+    std::filesystem::remove(root / "etc/pacman.conf");
+    std::filesystem::create_directory(root / "etc/pacman.conf");
+
+    const std::vector<yarp::FullCheckPackage> packages{
+        {"pacman", *mtree, {"etc/pacman.conf"}},
+    };
+    const auto results = yarp::CheckFilesFull(root, packages);
+
+    THEN("Every difference is reported") {
+      REQUIRE(results.has_value());
+      REQUIRE((*results)[0].problems ==
+              std::vector<Problem>{
+                  {"etc/pacman.conf", yarp::FileProblem::kType},
+                  {"usr/bin/pacman", yarp::FileProblem::kMode |
+                                         yarp::FileProblem::kMtime |
+                                         yarp::FileProblem::kSize}});
+    }
+  }
+
+  GIVEN("A backed up file that was edited and made private") {
+    std::ofstream{root / "etc/pacman.conf", std::ios::app} << "\nColor\n";
+    std::filesystem::permissions(root / "etc/pacman.conf",
+                                 std::filesystem::perms{0600});
+
+    const std::vector<yarp::FullCheckPackage> packages{
+        {"pacman", *mtree, {"etc/pacman.conf"}},
+    };
+    const auto results = yarp::CheckFilesFull(root, packages);
+
+    THEN("Only its permissions are reported") {
+      REQUIRE(results.has_value());
+      REQUIRE((*results)[0].problems ==
+              std::vector<Problem>{
+                  {"etc/pacman.conf", yarp::FileProblem::kMode}});
+    }
+  }
+
+  GIVEN("A missing file") {
+    std::filesystem::remove(root / "usr/bin/pacman");
+    const std::vector<yarp::FullCheckPackage> packages{
+        {"pacman", *mtree, {}},
+    };
+    const auto results = yarp::CheckFilesFull(root, packages);
+
+    THEN("It is missing") {
+      REQUIRE(results.has_value());
+      REQUIRE((*results)[0].problems.size() == 2);
+      REQUIRE((*results)[0].problems[1] ==
+              Problem{"usr/bin/pacman", yarp::FileProblem::kMissing});
+    }
+  }
+}
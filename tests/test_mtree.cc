@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: MIT
+
+#include <zlib.h>
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../src/mtree.h"
+#include "temp_dir.h"
+
+namespace {
+
+// As pacman writes them, shortened
+constexpr std::string_view kMtree = R"(#mtree
+/set type=file uid=0 gid=0 mode=644
+./.BUILDINFO time=1603289779.0 size=4335 md5digest=009107b4a59f2997a691448a58f24cac sha256digest=17ce80fea0b40e319851bdc00b1bd611db60e9f95d4e10624e63308424ab0271
+./.PKGINFO time=1603289779.0 size=454
+/set mode=755
+./usr time=1603289779.0 type=dir
+./usr/bin time=1603289779.0 type=dir
+./usr/bin/aserver time=1603289779.5 size=30640 sha256digest=d341f80f5df56ea05097bc9db75151f0668c19ba432ca17e50af876f7d2d9882
+./usr/include/asoundlib.h time=1603289779.0 mode=644 size=96
+./usr/lib/libasound.so time=1603289779.0 mode=777 type=link link=libasound.so.2
+./usr/share/doc/read\040me time=1603289779.0 size=1
+/unset mode
+./usr/share/fifo type=fifo
+./usr/share/plain time=1603289779.0 \
+    size=2
+)";
+
+}  // namespace
+
+SCENARIO("ParseMtree behavior", "[Mtree]") {
+  GIVEN("An mtree as pacman writes it") {
+    const auto entries = yarp::ParseMtree(kMtree);
+    REQUIRE(entries.has_value());
+
+    THEN("The package metadata and unsupported types are left out") {
+      REQUIRE(entries->size() == 7);
+      REQUIRE(entries->front().path == "usr");
+    }
+
+    THEN("The keywords of entries are read") {
+      const yarp::MtreeEntry &entry = (*entries)[2];
+      REQUIRE(entry.path == "usr/bin/aserver");
+      REQUIRE(entry.type == yarp::MtreeType::kFile);
+      REQUIRE(entry.mode == 0755);
+      REQUIRE(entry.size == 30640);
+      REQUIRE(entry.mtime == 1603289779);
+      REQUIRE(entry.sha256.has_value());
+      REQUIRE((*entry.sha256)[0] == 0xd3);
+      REQUIRE((*entry.sha256)[31] == 0x82);
+      REQUIRE_FALSE(entry.link.has_value());
+    }
+
+    THEN("Keywords of an entry override the defaults") {
+      REQUIRE((*entries)[0].type == yarp::MtreeType::kDirectory);
+      REQUIRE((*entries)[3].mode == 0644);
+      REQUIRE_FALSE((*entries)[3].sha256.has_value());
+    }
+
+    THEN("Symlinks have their targets") {
+      REQUIRE((*entries)[4].type == yarp::MtreeType::kSymlink);
+      REQUIRE((*entries)[4].link == "libasound.so.2");
+    }
+
+    THEN("Escaped characters are decoded") {
+      REQUIRE((*entries)[5].path == "usr/share/doc/read me");
+    }
+
+    THEN("Unset keywords are empty, and lines may be continued") {
+      REQUIRE((*entries)[6].path == "usr/share/plain");
+      REQUIRE_FALSE((*entries)[6].mode.has_value());
+      REQUIRE((*entries)[6].size == 2);
+    }
+  }
+
+  GIVEN("Invalid mtrees") {
+    THEN("They fail to parse") {
+      REQUIRE_FALSE(yarp::ParseMtree("./usr mode=999\n").has_value());
+      REQUIRE_FALSE(yarp::ParseMtree("./usr sha256digest=12\n").has_value());
+      REQUIRE_FALSE(yarp::ParseMtree("usr type=dir\n").has_value());
+    }
+  }
+
+  GIVEN("A gzip-compressed mtree file") {
+    const TempDir dir{"mtree"};
+    const std::filesystem::path path = dir / "mtree.gz";
+    gzFile file = gzopen(path.c_str(), "wb");
+    REQUIRE(file != nullptr);
+    REQUIRE(gzwrite(file, kMtree.data(),
+                    static_cast<unsigned>(kMtree.size())) > 0);
+    REQUIRE(gzclose(file) == Z_OK);
+
+    THEN("It reads the same as the text") {
+      const auto entries = yarp::ReadMtree(path);
+      REQUIRE(entries.has_value());
+      REQUIRE(entries->size() == 7);
+      REQUIRE((*entries)[4].link == "libasound.so.2");
+    }
+  }
+
+  GIVEN("A missing mtree file") {
+    THEN("It fails to read") {
+      REQUIRE_FALSE(yarp::ReadMtree("/nonexistent/mtree").has_value());
+    }
+  }
+}
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: MIT
+
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../src/owner_index.h"
+#include "temp_dir.h"
+
+namespace {
+
+using Owner = yarp::OwnerIndex::Owner;
+
+std::vector<yarp::OwnerIndex::Package> MakePackages() {
+  return {
+      {"filesystem", "2024.04.07-1", {"etc/", "usr/", "usr/bin/"}},
+      {"pacman", "7.0.0-1", {"etc/pacman.conf", "usr/", "usr/bin/",
+                             "usr/bin/pacman"}},
+      {"bash", "5.2.037-1", {"usr/", "usr/bin/", "usr/bin/bash",
+                             "usr/bin/sh"}},
+  };
+}
+
+}  // namespace
+
+SCENARIO("OwnerIndex behavior", "[OwnerIndex]") {
+  const TempDir dir{"owners"};
+  const std::filesystem::path path = dir / "owners";
+
+  GIVEN("An index built from packages") {
+    const std::vector<yarp::OwnerIndex::Package> packages = MakePackages();
+    const yarp::OwnerIndex index =
+        yarp::OwnerIndex::Build(packages, "/var/lib/pacman/local", 42);
+
+    THEN("Every distinct path is indexed") { REQUIRE(index.size() == 7); }
+
+    THEN("A file is owned by its package") {
+      REQUIRE(index.Owners("usr/bin/pacman") ==
+              std::vector<Owner>{{"pacman", "7.0.0-1"}});
+      REQUIRE(index.Owners("usr/bin/sh") ==
+              std::vector<Owner>{{"bash", "5.2.037-1"}});
+    }
+
+    THEN("A shared directory is owned by every package, in package order") {
+      REQUIRE(index.Owners("usr/bin/") ==
+              std::vector<Owner>{{"filesystem", "2024.04.07-1"},
+                                 {"pacman", "7.0.0-1"},
+                                 {"bash", "5.2.037-1"}});
+    }
+
+    THEN("Paths are matched exactly") {
+      REQUIRE(index.Owners("usr/bin/pacma").empty());
+      REQUIRE(index.Owners("/usr/bin/pacman").empty());
+      REQUIRE(index.Owners("").empty());
+    }
+
+    THEN("The database it was built from is recorded") {
+      REQUIRE(index.db_dir() == "/var/lib/pacman/local");
+      REQUIRE(index.db_stamp() == 42);
+    }
+
+    WHEN("It is saved and loaded again") {
+      REQUIRE(index.Save(path).has_value());
+      const auto loaded = yarp::OwnerIndex::Load(path);
+
+      THEN("The loaded index answers the same") {
+        REQUIRE(loaded.has_value());
+        REQUIRE(loaded->size() == index.size());
+        REQUIRE(loaded->db_dir() == "/var/lib/pacman/local");
+        REQUIRE(loaded->db_stamp() == 42);
+        REQUIRE(loaded->Owners("usr/bin/") == index.Owners("usr/bin/"));
+        REQUIRE(loaded->Owners("etc/pacman.conf") ==
+                std::vector<Owner>{{"pacman", "7.0.0-1"}});
+      }
+    }
+  }
+
+  GIVEN("An index of no packages") {
+    const yarp::OwnerIndex index = yarp::OwnerIndex::Build({}, "", 0);
+
+    THEN("Nothing is owned") {
+      REQUIRE(index.size() == 0);
+      REQUIRE(index.Owners("usr/bin/pacman").empty());
+    }
+  }
+
+  GIVEN("Files that are not indexes") {
+    THEN("They fail to load") {
+      REQUIRE_FALSE(yarp::OwnerIndex::Load(path).has_value());
+
+      std::ofstream{path} << "yarpown1 but not an index";
+      REQUIRE_FALSE(yarp::OwnerIndex::Load(path).has_value());
+    }
+
+    WHEN("An index is truncated") {
+      const std::vector<yarp::OwnerIndex::Package> packages = MakePackages();
+      REQUIRE(yarp::OwnerIndex::Build(packages, "", 0).Save(path).has_value());
+      std::filesystem::resize_file(path,
+                                   std::filesystem::file_size(path) - 1);
+
+      THEN("It fails to load") {
+        REQUIRE_FALSE(yarp::OwnerIndex::Load(path).has_value());
+      }
+    }
+  }
+
+  GIVEN("A directory") {
+    const std::filesystem::path directory = dir / "local";
+    std::filesystem::create_directory(directory);
+    std::filesystem::last_write_time(
+        directory, std::filesystem::file_time_type{std::chrono::hours{1}});
+    const auto stamp = yarp::OwnerIndex::DbStamp(directory);
+    REQUIRE(stamp.has_value());
+
+    WHEN("An entry is added to it") {
+      std::filesystem::create_directory(directory / "bash-5.2.037-1");
+
+      THEN("Its stamp changes") {
+        REQUIRE(yarp::OwnerIndex::DbStamp(directory) != stamp);
+      }
+    }
+  }
+
+  GIVEN("A missing directory") {
+    THEN("It has no stamp") {
+      REQUIRE_FALSE(
+          yarp::OwnerIndex::DbStamp("/nonexistent/local").has_value());
+    }
+  }
+}